@@ -0,0 +1,602 @@
+#include "../src/app.h"
+#include "../src/collision_detector.h"
+#include "../src/json_loader.h"
+#include "../src/model.h"
+
+#include <boost/program_options.hpp>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+using namespace std::literals;
+using milliseconds = std::chrono::milliseconds;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Счётчики выделений памяти через operator new во всей программе:
+// выделения за шаг Tick и объём кучи на одну собаку в сценарии swarm
+constexpr size_t ALLOC_HEADER_SIZE = alignof(std::max_align_t); // перед блоком хранится его размер
+std::atomic<uint64_t> allocations_count{0};
+std::atomic<int64_t> live_bytes{0};
+
+}  // namespace
+
+void* operator new(size_t size) {
+    void* block = std::malloc(size + ALLOC_HEADER_SIZE);
+    if (!block) {
+        throw std::bad_alloc();
+    }
+    *static_cast<size_t*>(block) = size;
+    allocations_count.fetch_add(1, std::memory_order_relaxed);
+    live_bytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed);
+    return static_cast<char*>(block) + ALLOC_HEADER_SIZE;
+}
+
+void operator delete(void* ptr) noexcept {
+    if (!ptr) {
+        return;
+    }
+    void* block = static_cast<char*>(ptr) - ALLOC_HEADER_SIZE;
+    live_bytes.fetch_sub(static_cast<int64_t>(*static_cast<size_t*>(block)), std::memory_order_relaxed);
+    std::free(block);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    operator delete(ptr);
+}
+
+namespace {
+
+constexpr int GRID_STEP = 10; // расстояние между соседними дорогами
+constexpr int GRID_ROADS = 11; // число дорог по каждой оси
+constexpr double ACTION_PROBABILITY = 0.1; // вероятность смены направления собакой на каждом шаге
+constexpr std::string_view DIRECTIONS[] = {"U"sv, "D"sv, "L"sv, "R"sv};
+
+enum class Scenario {
+    ALL,
+    PARALLEL, // BenchParallelTick
+    PLAYERS, // BenchTickByPlayers
+    SWARM, // BenchSwarm
+    GATHER // BenchGatherEvents
+};
+
+struct Args {
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    unsigned dogs_per_session = 1000;
+    unsigned ticks = 200;
+    int tick_ms = 50;
+    Scenario scenario = Scenario::ALL;
+
+    // сценарий swarm
+    fs::path config_file; // по умолчанию карты-решётки
+    unsigned maps = 4; // число карт-решёток или первых карт из конфига
+    unsigned bots = 10000; // всего на всех картах
+    double simulated_hours = 0.0; // > 0 - вместо ticks шагов прогнать столько часов игрового времени
+
+    // сценарий gather
+    unsigned gatherers = 10000;
+    unsigned items = 50000;
+};
+
+[[nodiscard]] std::optional<Args> ParseCommandLine(int argc, const char* const argv[]) {
+    namespace po = boost::program_options;
+
+    po::options_description desc{"Allowed options"s};
+
+    Args args;
+    desc.add_options()
+        ("help,h", "produce help message")
+        ("threads", po::value(&args.threads)->value_name("count"s), "set number of threads for parallel tick")
+        ("dogs", po::value(&args.dogs_per_session)->value_name("count"s), "set number of dogs in each game session")
+        ("ticks", po::value(&args.ticks)->value_name("count"s), "set number of measured ticks")
+        ("tick-period", po::value(&args.tick_ms)->value_name("milliseconds"s), "set simulated tick period")
+        ("scenario", po::value<std::string>()->value_name("all|parallel|players|swarm|gather"s), "set benchmark to run")
+        ("config-file,c", po::value(&args.config_file)->value_name("file"s), "set game config for swarm (default - grid maps)")
+        ("maps", po::value(&args.maps)->value_name("count"s), "set number of maps for swarm")
+        ("bots", po::value(&args.bots)->value_name("count"s), "set total number of random-walk bots for swarm")
+        ("simulated-hours", po::value(&args.simulated_hours)->value_name("hours"s), "fast-forward swarm by game time instead of ticks count")
+        ("gatherers", po::value(&args.gatherers)->value_name("count"s), "set number of moving dogs for gather")
+        ("items", po::value(&args.items)->value_name("count"s), "set number of loot items for gather");
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (vm.contains("help"s)) {
+        std::cout << desc;
+        return std::nullopt;
+    }
+
+    if (vm.contains("scenario"s)) {
+        const std::string scenario = vm["scenario"s].as<std::string>();
+        if (scenario == "all"s) {
+            args.scenario = Scenario::ALL;
+        } else if (scenario == "parallel"s) {
+            args.scenario = Scenario::PARALLEL;
+        } else if (scenario == "players"s) {
+            args.scenario = Scenario::PLAYERS;
+        } else if (scenario == "swarm"s) {
+            args.scenario = Scenario::SWARM;
+        } else if (scenario == "gather"s) {
+            args.scenario = Scenario::GATHER;
+        } else {
+            throw std::runtime_error("Invalid scenario: "s + scenario);
+        }
+    }
+    if (args.tick_ms <= 0) {
+        throw std::runtime_error("Tick period must be positive"s);
+    }
+
+    return args;
+}
+
+// карта-решётка из GRID_ROADS горизонтальных и GRID_ROADS вертикальных дорог с офисом в центре
+model::Map MakeGridMap(const std::string& id) {
+    model::Map map(model::Map::Id{id}, id);
+    const int size = GRID_STEP * (GRID_ROADS - 1);
+    for (int i = 0; i < GRID_ROADS; ++i) {
+        map.AddRoad(model::Road(model::Road::HORIZONTAL, {0, i * GRID_STEP}, size));
+        map.AddRoad(model::Road(model::Road::VERTICAL, {i * GRID_STEP, 0}, size));
+    }
+
+    model::LootType loot_type;
+    loot_type.properties["value"] = int64_t{10};
+    map.AddLootType(loot_type);
+    map.AddOffice(model::Office(model::Office::Id{id + "_office"s}, {size / 2, size / 2}, {0, 0}));
+    return map;
+}
+
+model::Game MakeGame(unsigned sessions_count, double loot_probability = 0.5) {
+    model::Game game;
+    game.SetLootConfig(5.0, loot_probability);
+    for (unsigned i = 0; i < sessions_count; ++i) {
+        game.AddMap(MakeGridMap("map"s + std::to_string(i)));
+    }
+    return game;
+}
+
+// случайная смена направления части собак - одинаковая последовательность для одинакового seed
+void SendActions(app::Application& app, std::mt19937& random) {
+    std::bernoulli_distribution action(ACTION_PROBABILITY);
+    std::uniform_int_distribution<size_t> direction(0, std::size(DIRECTIONS) - 1);
+    for (const auto& session : app.GetGame().GetSessions()) {
+        for (const model::Dog& dog : session->GetDogs()) {
+            if (action(random)) {
+                session->SetDogAction(dog.GetId(), DIRECTIONS[direction(random)]);
+            }
+        }
+    }
+}
+
+struct RunResult {
+    double ms_per_tick = 0.0;
+    std::vector<geom::Point2D> positions; // позиции собак в конце прогона для проверки детерминированности
+};
+
+RunResult RunTicks(const Args& args, unsigned sessions_count, unsigned threads) {
+    model::Game game = MakeGame(sessions_count);
+    app::Application app{game, args.tick_ms, false}; // собаки появляются в начале первой дороги
+    app.SetTickThreads(threads);
+
+    for (const auto& map : game.GetMaps()) {
+        for (unsigned i = 0; i < args.dogs_per_session; ++i) {
+            app.JoinGame("bot"s + std::to_string(i), map.GetId());
+        }
+    }
+
+    std::mt19937 random(42);
+    std::chrono::steady_clock::duration total{};
+    for (unsigned tick = 0; tick < args.ticks; ++tick) {
+        SendActions(app, random);
+        const auto start = std::chrono::steady_clock::now();
+        app.Tick(milliseconds(args.tick_ms));
+        total += std::chrono::steady_clock::now() - start;
+    }
+
+    RunResult result;
+    result.ms_per_tick = std::chrono::duration<double, std::milli>(total).count() / std::max(1u, args.ticks);
+    for (const auto& session : game.GetSessions()) {
+        for (const model::Dog& dog : session->GetDogs()) {
+            result.positions.push_back(dog.GetPosition());
+        }
+    }
+    return result;
+}
+
+// время шага Tick при последовательном и параллельном обходе сессий
+void BenchParallelTick(const Args& args) {
+    std::cout << "Parallel tick by sessions: " << args.dogs_per_session << " dogs per session, "
+              << args.threads << " threads, " << args.ticks << " ticks" << std::endl;
+    std::cout << std::setw(10) << "sessions" << std::setw(16) << "serial ms/tick"
+              << std::setw(18) << "parallel ms/tick" << std::setw(10) << "speedup"
+              << std::setw(12) << "identical" << std::endl;
+
+    for (unsigned sessions_count : {1u, 2u, 4u, 8u, 16u, 32u}) {
+        const RunResult serial = RunTicks(args, sessions_count, 1);
+        const RunResult parallel = RunTicks(args, sessions_count, args.threads);
+        std::cout << std::fixed << std::setprecision(3)
+                  << std::setw(10) << sessions_count
+                  << std::setw(16) << serial.ms_per_tick
+                  << std::setw(18) << parallel.ms_per_tick
+                  << std::setw(10) << serial.ms_per_tick / parallel.ms_per_tick
+                  << std::setw(12) << (serial.positions == parallel.positions ? "yes" : "NO") << std::endl;
+    }
+}
+
+// время шага Tick и удаления всех игроков в зависимости от числа игроков в одной сессии
+void BenchTickByPlayers(const Args& args) {
+    std::cout << "Tick by players count: 1 session without loot, " << args.ticks << " ticks" << std::endl;
+    std::cout << std::setw(10) << "players" << std::setw(12) << "ms/tick"
+              << std::setw(16) << "us/tick/player" << std::setw(16) << "leave all ms" << std::endl;
+
+    for (unsigned players_count : {1000u, 2000u, 5000u, 10000u, 20000u}) {
+        model::Game game = MakeGame(1, 0.0); // без предметов - измеряется только работа с игроками и собаками
+        app::Application app{game, args.tick_ms, false};
+        app.SetTickThreads(args.threads);
+
+        const model::Map::Id map_id = game.GetMaps().front().GetId();
+        for (unsigned i = 0; i < players_count; ++i) {
+            app.JoinGame("bot"s + std::to_string(i), map_id);
+        }
+
+        std::mt19937 random(42);
+        std::chrono::steady_clock::duration total{};
+        for (unsigned tick = 0; tick < args.ticks; ++tick) {
+            SendActions(app, random);
+            const auto start = std::chrono::steady_clock::now();
+            app.Tick(milliseconds(args.tick_ms));
+            total += std::chrono::steady_clock::now() - start;
+        }
+
+        // все игроки превышают время бездействия и удаляются на следующем шаге
+        game.SetRetirementTime(0.0);
+        const auto leave_start = std::chrono::steady_clock::now();
+        app.Tick(milliseconds(args.tick_ms));
+        const auto leave_total = std::chrono::steady_clock::now() - leave_start;
+
+        const double ms_per_tick = std::chrono::duration<double, std::milli>(total).count() / std::max(1u, args.ticks);
+        std::cout << std::fixed << std::setprecision(3)
+                  << std::setw(10) << players_count
+                  << std::setw(12) << ms_per_tick
+                  << std::setw(16) << ms_per_tick * 1000.0 / players_count
+                  << std::setw(16) << std::chrono::duration<double, std::milli>(leave_total).count() << std::endl;
+    }
+}
+
+// Случайное блуждание: собака меняет направление с вероятностью ACTION_PROBABILITY
+// и сразу, если остановилась на краю дороги, поэтому боты не уходят из игры по бездействию
+void WalkBots(app::Application& app, const app::PlayerPtrs& bots, std::mt19937& random) {
+    std::bernoulli_distribution action(ACTION_PROBABILITY);
+    std::uniform_int_distribution<size_t> direction(0, std::size(DIRECTIONS) - 1);
+    for (const app::PlayerPtr& bot : bots) {
+        const model::Dog* dog = bot->GetDog();
+        if (!dog) { // собака ушла из игры
+            continue;
+        }
+        const geom::Vec2D speed = dog->GetSpeed();
+        if ((speed.x == 0.0 && speed.y == 0.0) || action(random)) {
+            app.SetDogAction(*bot, DIRECTIONS[direction(random)]);
+        }
+    }
+}
+
+size_t CountDogs(const model::Game& game) {
+    size_t dogs = 0;
+    for (const auto& session : game.GetSessions()) {
+        dogs += session->GetDogsCount();
+    }
+    return dogs;
+}
+
+size_t CountLoots(const model::Game& game) {
+    size_t loots = 0;
+    for (const auto& session : game.GetSessions()) {
+        loots += session->GetLootsCount();
+    }
+    return loots;
+}
+
+// Рой ботов на нескольких картах без HTTP и БД: шаги Tick выполняются подряд без пауз.
+// Выводит шаги в секунду, время фаз, выделения памяти за шаг и объём кучи на собаку
+void BenchSwarm(const Args& args) {
+    model::Game game = args.config_file.empty() ? MakeGame(args.maps) : json_loader::LoadGame(args.config_file);
+    const size_t maps_count = std::min<size_t>(std::max(1u, args.maps), game.GetMaps().size());
+
+    const uint64_t ticks = args.simulated_hours > 0.0
+        ? static_cast<uint64_t>(args.simulated_hours * 3600.0 * 1000.0 / args.tick_ms)
+        : args.ticks;
+    const uint64_t ticks_per_hour = 3600 * 1000 / args.tick_ms;
+
+    std::cout << "Swarm: " << args.bots << " bots on " << maps_count << " maps, " << ticks << " ticks of "
+              << args.tick_ms << " ms (" << std::fixed << std::setprecision(2)
+              << ticks * args.tick_ms / 3600000.0 << " h of game time), " << args.threads << " threads" << std::endl;
+
+    app::Application app{game, args.tick_ms, true};
+    app.SetTickThreads(args.threads);
+    app.SetTickProfileWindow(tick_profiler::DEFAULT_PROFILE_WINDOW); // окно небольшое - почти не влияет на объём кучи
+
+    const int64_t heap_before_spawn = live_bytes.load();
+    app::PlayerPtrs bots;
+    bots.reserve(args.bots);
+    for (unsigned i = 0; i < args.bots; ++i) {
+        const model::Map::Id& map_id = game.GetMaps()[i % maps_count].GetId();
+        bots.push_back(app.FindPlayerByToken(app.JoinGame("bot"s + std::to_string(i), map_id).token));
+    }
+    const int64_t heap_after_spawn = live_bytes.load();
+
+    std::mt19937 random(42);
+    std::chrono::steady_clock::duration tick_time{};
+    std::chrono::steady_clock::duration hour_tick_time{};
+    uint64_t tick_allocations = 0;
+    for (uint64_t tick = 1; tick <= ticks; ++tick) {
+        WalkBots(app, bots, random);
+
+        const uint64_t allocations_start = allocations_count.load(std::memory_order_relaxed);
+        const auto start = std::chrono::steady_clock::now();
+        app.Tick(milliseconds(args.tick_ms));
+        const auto duration = std::chrono::steady_clock::now() - start;
+        tick_allocations += allocations_count.load(std::memory_order_relaxed) - allocations_start;
+        tick_time += duration;
+        hour_tick_time += duration;
+
+        if (args.simulated_hours > 0.0 && tick % ticks_per_hour == 0) { // ход прогона по часам игрового времени
+            std::cout << "  hour " << tick / ticks_per_hour << ": " << std::setprecision(1)
+                      << ticks_per_hour / std::chrono::duration<double>(hour_tick_time).count() << " ticks/s, "
+                      << CountDogs(game) << " dogs, " << CountLoots(game) << " loots" << std::endl;
+            hour_tick_time = {};
+        }
+    }
+
+    const double tick_seconds = std::chrono::duration<double>(tick_time).count();
+    const size_t dogs = CountDogs(game);
+    std::cout << std::fixed << std::setprecision(3)
+              << "ticks/s:              " << (tick_seconds > 0.0 ? ticks / tick_seconds : 0.0) << std::endl
+              << "ms/tick:              " << tick_seconds * 1000.0 / std::max<uint64_t>(ticks, 1) << std::endl
+              << "allocations/tick:     " << static_cast<double>(tick_allocations) / std::max<uint64_t>(ticks, 1) << std::endl
+              << "heap/dog at spawn, B: " << static_cast<double>(heap_after_spawn - heap_before_spawn) / std::max(1u, args.bots) << std::endl
+              << "heap/dog at end, B:   " << static_cast<double>(live_bytes.load() - heap_before_spawn) / std::max<size_t>(dogs, 1) << std::endl
+              << "dogs at end:          " << dogs << std::endl
+              << "loots at end:         " << CountLoots(game) << std::endl;
+
+    // время фаз по последним шагам в окне профилировщика: среднее - сумма по сессиям, p99 - худшая сессия
+    std::cout << std::setw(26) << "phase" << std::setw(16) << "mean ms/tick" << std::setw(20) << "max session p99 ms" << std::endl;
+    const tick_profiler::TickProfiler* profiler = app.GetTickProfiler();
+    for (size_t phase = 0; phase < tick_profiler::PHASES_COUNT; ++phase) {
+        double mean_ms = 0.0;
+        double p99_ms = 0.0;
+        for (const tick_profiler::SessionProfile& session : profiler->GetSessions()) {
+            const tick_profiler::RollingHistogram& histogram = session.phases[phase];
+            mean_ms += histogram.GetMean().count() / 1000.0;
+            p99_ms = std::max(p99_ms, histogram.GetPercentile(99.0).count() / 1000.0);
+        }
+        std::cout << std::setw(26) << tick_profiler::PhaseToString(static_cast<tick_profiler::Phase>(phase))
+                  << std::setw(16) << mean_ms << std::setw(20) << p99_ms << std::endl;
+    }
+    std::cout << std::setw(26) << "tick" << std::setw(16) << profiler->GetTick().GetMean().count() / 1000.0
+              << std::setw(20) << profiler->GetTick().GetPercentile(99.0).count() / 1000.0 << std::endl;
+}
+
+// Проверка всех пар собак и предметов - образец для сравнения событий и времени
+std::vector<collision_detector::GatheringEvent> FindGatherEventsExhaustive(const std::vector<collision_detector::Item>& items,
+                                                                           const std::vector<collision_detector::Gatherer>& gatherers) {
+    using namespace collision_detector;
+    std::vector<GatheringEvent> events;
+    for (size_t g = 0; g < gatherers.size(); ++g) {
+        const Gatherer& gatherer = gatherers[g];
+        if (gatherer.start_pos.x == gatherer.end_pos.x && gatherer.start_pos.y == gatherer.end_pos.y) {
+            continue;
+        }
+        for (size_t i = 0; i < items.size(); ++i) {
+            const CollectionResult result = TryCollectPoint(gatherer.start_pos, gatherer.end_pos, items[i].position);
+            if (result.IsCollected(gatherer.width + items[i].width)) {
+                events.push_back({i, g, result.sq_distance, result.proj_ratio});
+            }
+        }
+    }
+    std::sort(events.begin(), events.end(), [](const GatheringEvent& lhs, const GatheringEvent& rhs) {
+        return lhs.time < rhs.time;
+    });
+    return events;
+}
+
+// Поиск событий сбора на карте-решётке: собаки идут вдоль дорог на путь за один шаг tick-period,
+// предметы лежат на дорогах. Сравнивается с проверкой всех пар
+void BenchGatherEvents(const Args& args) {
+    using namespace collision_detector;
+    std::cout << "Gather events: " << args.gatherers << " dogs, " << args.items << " items, "
+              << args.tick_ms << " ms step" << std::endl;
+
+    const double size = GRID_STEP * (GRID_ROADS - 1);
+    const double path = model::DEFAULT_DOG_SPEED * args.tick_ms / 1000.0;
+    std::mt19937 random(42);
+    std::uniform_int_distribution<int> road(0, GRID_ROADS - 1);
+    std::uniform_real_distribution<double> coord(0.0, size);
+    std::bernoulli_distribution horizontal(0.5);
+
+    std::vector<Item> items;
+    items.reserve(args.items);
+    for (unsigned i = 0; i < args.items; ++i) {
+        const double line = road(random) * GRID_STEP;
+        items.push_back(horizontal(random)
+            ? Item{{coord(random), line}, model::LOOT_HALF_WIDTH}
+            : Item{{line, coord(random)}, model::LOOT_HALF_WIDTH});
+    }
+    std::vector<Gatherer> gatherers;
+    gatherers.reserve(args.gatherers);
+    for (unsigned g = 0; g < args.gatherers; ++g) {
+        const double line = road(random) * GRID_STEP;
+        const double start = coord(random);
+        const double end = std::clamp(start + (horizontal(random) ? path : -path), 0.0, size);
+        gatherers.push_back(horizontal(random)
+            ? Gatherer{{start, line}, {end, line}, model::DOG_HALF_WIDTH}
+            : Gatherer{{line, start}, {line, end}, model::DOG_HALF_WIDTH});
+    }
+
+    // как в HandleCollisions: предметы лежат в индексе сессии, который поддерживается при добавлении и сборе,
+    // поэтому время индекса в замер не входит
+    spatial_index::DynamicGrid loot_index{model::LOOT_INDEX_CELL_SIZE};
+    for (size_t i = 0; i < items.size(); ++i) {
+        loot_index.Insert(static_cast<uint32_t>(i), items[i].position);
+    }
+    const auto session_start = std::chrono::steady_clock::now();
+    const std::vector<GatheringEvent> events = FindGatherEvents(gatherers,
+        [&loot_index](const Gatherer& gatherer, std::vector<uint32_t>& out) {
+            const GatherBounds bounds = GetGatherBounds(gatherer, model::LOOT_HALF_WIDTH);
+            loot_index.QueryRect(bounds.min_corner, bounds.max_corner, out);
+        },
+        [&items](uint32_t i) {
+            return items[i];
+        });
+    const auto session_time = std::chrono::steady_clock::now() - session_start;
+
+    // пакетный вариант с сеткой, построенной по всем предметам
+    const auto batch_start = std::chrono::steady_clock::now();
+    const std::vector<GatheringEvent> batch_events = FindGatherEvents(items, gatherers);
+    const auto batch_time = std::chrono::steady_clock::now() - batch_start;
+
+    const auto exhaustive_start = std::chrono::steady_clock::now();
+    const std::vector<GatheringEvent> expected = FindGatherEventsExhaustive(items, gatherers);
+    const auto exhaustive_time = std::chrono::steady_clock::now() - exhaustive_start;
+
+    const auto is_identical = [&expected](const std::vector<GatheringEvent>& events) {
+        return std::equal(events.begin(), events.end(), expected.begin(), expected.end(),
+            [](const GatheringEvent& lhs, const GatheringEvent& rhs) {
+                return lhs.item_id == rhs.item_id && lhs.gatherer_id == rhs.gatherer_id
+                    && lhs.sq_distance == rhs.sq_distance && lhs.time == rhs.time;
+            });
+    };
+    const double session_ms = std::chrono::duration<double, std::milli>(session_time).count();
+    const double batch_ms = std::chrono::duration<double, std::milli>(batch_time).count();
+    const double exhaustive_ms = std::chrono::duration<double, std::milli>(exhaustive_time).count();
+    std::cout << std::fixed << std::setprecision(3)
+              << "events:          " << events.size() << std::endl
+              << "session ms:      " << session_ms << std::endl
+              << "batch grid ms:   " << batch_ms << std::endl
+              << "all pairs ms:    " << exhaustive_ms << std::endl
+              << "speedup:         " << (session_ms > 0.0 ? exhaustive_ms / session_ms : 0.0) << std::endl
+              << "identical:       " << (is_identical(events) && is_identical(batch_events) ? "yes" : "NO") << std::endl;
+
+    // проверка всех предметов одним пакетом на каждого из первых собирателей - скорость наборов команд
+    constexpr size_t KERNEL_GATHERERS = 200;
+    const size_t kernel_gatherers = std::min(KERNEL_GATHERERS, gatherers.size());
+    PackedItems packed;
+    for (const Item& item : items) {
+        packed.Add(item);
+    }
+    std::vector<uint64_t> mask((items.size() + 63) / 64);
+    constexpr std::pair<GatherKernel, std::string_view> KERNELS[] = {
+        {GatherKernel::SCALAR, "scalar"sv}, {GatherKernel::SSE2, "sse2"sv}, {GatherKernel::AVX2, "avx2"sv}
+    };
+    std::cout << std::setw(10) << "kernel" << std::setw(12) << "ns/item" << std::setw(12) << "candidates" << std::endl;
+    for (const auto& [kernel, name] : KERNELS) {
+        if (!IsGatherKernelSupported(kernel)) {
+            continue;
+        }
+        size_t candidates = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t g = 0; g < kernel_gatherers; ++g) {
+            FindGatherCandidates(kernel, gatherers[g], packed, 0, items.size(), mask.data());
+            for (const uint64_t word : mask) {
+                candidates += std::popcount(word);
+            }
+        }
+        const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        std::cout << std::setw(10) << name
+                  << std::setw(12) << ns / std::max<size_t>(kernel_gatherers * items.size(), 1)
+                  << std::setw(12) << candidates << std::endl;
+    }
+
+    // цена проверки n кандидатов собирателя: по одному через TryCollectPoint и упаковкой с FindGatherCandidates -
+    // по ней выбран GATHER_KERNEL_MIN_CANDIDATES
+    constexpr size_t CANDIDATES_REPEATS = 20;
+    constexpr size_t CANDIDATES_COUNTS[] = {8, 32, 128, 256, 384, 512, 2048};
+    std::cout << std::setw(12) << "candidates" << std::setw(12) << "scalar ns" << std::setw(12) << "packed ns"
+              << std::setw(12) << "identical" << std::endl;
+    for (const size_t n : CANDIDATES_COUNTS) {
+        if (n > items.size()) {
+            break;
+        }
+        size_t scalar_collected = 0;
+        const auto scalar_start = std::chrono::steady_clock::now();
+        for (size_t r = 0; r < CANDIDATES_REPEATS; ++r) {
+            for (size_t g = 0; g < kernel_gatherers; ++g) {
+                const Gatherer& gatherer = gatherers[g];
+                for (size_t i = 0; i < n; ++i) {
+                    scalar_collected += TryCollectPoint(gatherer.start_pos, gatherer.end_pos, items[i].position).IsCollected(gatherer.width + items[i].width);
+                }
+            }
+        }
+        const auto scalar_time = std::chrono::steady_clock::now() - scalar_start;
+
+        size_t packed_collected = 0;
+        const auto packed_start = std::chrono::steady_clock::now();
+        for (size_t r = 0; r < CANDIDATES_REPEATS; ++r) {
+            for (size_t g = 0; g < kernel_gatherers; ++g) {
+                const Gatherer& gatherer = gatherers[g];
+                packed.Clear();
+                for (size_t i = 0; i < n; ++i) {
+                    packed.Add(items[i]);
+                }
+                FindGatherCandidates(GetGatherKernel(), gatherer, packed, 0, n, mask.data());
+                for (size_t word = 0; word < (n + 63) / 64; ++word) {
+                    for (uint64_t bits = mask[word]; bits != 0; bits &= bits - 1) {
+                        const size_t i = word * 64 + std::countr_zero(bits);
+                        packed_collected += TryCollectPoint(gatherer.start_pos, gatherer.end_pos, items[i].position).IsCollected(gatherer.width + items[i].width);
+                    }
+                }
+            }
+        }
+        const auto packed_time = std::chrono::steady_clock::now() - packed_start;
+
+        const double calls = static_cast<double>(CANDIDATES_REPEATS * std::max<size_t>(kernel_gatherers, 1));
+        std::cout << std::setw(12) << n
+                  << std::setw(12) << std::chrono::duration<double, std::nano>(scalar_time).count() / calls
+                  << std::setw(12) << std::chrono::duration<double, std::nano>(packed_time).count() / calls
+                  << std::setw(12) << (scalar_collected == packed_collected ? "yes" : "NO") << std::endl;
+    }
+}
+
+}  // namespace
+
+int main(int argc, const char* argv[]) {
+    try {
+        auto args = ParseCommandLine(argc, argv);
+        if (args == std::nullopt) { // ключ -h
+            return EXIT_SUCCESS;
+        }
+
+        if (args->scenario == Scenario::ALL || args->scenario == Scenario::PARALLEL) {
+            BenchParallelTick(*args);
+            std::cout << std::endl;
+        }
+        if (args->scenario == Scenario::ALL || args->scenario == Scenario::PLAYERS) {
+            BenchTickByPlayers(*args);
+            std::cout << std::endl;
+        }
+        if (args->scenario == Scenario::ALL || args->scenario == Scenario::SWARM) {
+            BenchSwarm(*args);
+            std::cout << std::endl;
+        }
+        if (args->scenario == Scenario::ALL || args->scenario == Scenario::GATHER) {
+            BenchGatherEvents(*args);
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
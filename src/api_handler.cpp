@@ -32,14 +32,9 @@ StringResponse SetFailedParseJson(std::string_view message, unsigned version, bo
     return Make(http::status::bad_request, body, version, keep_alive);
 }
 
-StringResponse SetGameAction(app::PlayerPtr player, std::string_view direction_str, unsigned version, bool keep_alive) {
-    model::DogPtr dog = player->GetSession()->GetDog(player->GetDogId());
-    dog->SetDirectionSpeed(direction_str);
-    if (!direction_str.empty()) {
-        dog->Moving(); // метка начала движения на текущем Tick'е
-    } else {
-        dog->Stopped(); // метка остановки на текущем Tick'е
-    }
+StringResponse SetGameAction(app::Application& app, app::PlayerPtr player, std::string_view direction_str, unsigned version, bool keep_alive) {
+    app.SetDogAction(*player, direction_str);
+    const model::Dog* dog = player->GetDog();
 
     json::value jv = {
         { "move", model::DirectionToString(dog->GetDirection())},
@@ -97,6 +92,32 @@ std::pair<int, int> GetStartAndMaxItems(const std::string& query) {
     return { start, max_items };
 }
 
+bool IsTargetPath(std::string_view target, std::string_view path) {
+    return target.starts_with(path) && (target.size() == path.size() || target[path.size()] == '?');
+}
+
+std::optional<uint64_t> GetSinceTick(std::string_view target) {
+    size_t pos = target.find('?');
+    if (pos == std::string_view::npos) {
+        return std::nullopt;
+    }
+
+    constexpr std::string_view FIELD = "since=";
+    size_t field_pos = target.find(FIELD, pos + 1);
+    if (field_pos == std::string_view::npos) {
+        return std::nullopt;
+    }
+
+    // номер шага - 64-битный, как у Application::GetTicksCount; некорректное значение - как без параметра
+    const std::string_view value = target.substr(field_pos + FIELD.size());
+    uint64_t since = 0;
+    const auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), since);
+    if (ec != std::errc{} || (end != value.data() + value.size() && *end != '&')) {
+        return std::nullopt;
+    }
+    return since;
+}
+
 // методы класса ApiRequestHandler
 
     StringResponse ApiRequestHandler::GetMapsList(unsigned version, bool keep_alive) const {
@@ -127,13 +148,62 @@ std::pair<int, int> GetStartAndMaxItems(const std::string& query) {
     }
 
     StringResponse ApiRequestHandler::GetPlayersList(app::PlayerPtr player, unsigned version, bool keep_alive) const {
-        auto jo = json_loader::GetPlayerListObject(app_.GetDogs(player));
+        return GetPlayersList(app_.GetDogs(player), version, keep_alive);
+    }
+
+    StringResponse ApiRequestHandler::GetPlayersList(const model::Dogs& dogs, unsigned version, bool keep_alive) const {
+        auto jo = json_loader::GetPlayerListObject(dogs);
+        auto body = json::serialize(jo);
+        return Make(http::status::ok, body, version, keep_alive);
+    }
+
+    StringResponse ApiRequestHandler::GetGameState(app::PlayerPtr player, std::optional<uint64_t> since, unsigned version, bool keep_alive) const {
+        const GameStateView view{
+            app_.GetDogs(player),
+            app_.GetLoots(player),
+            app_.GetAreaIndex(player),
+            app_.GetChangesHistory(player),
+            app_.GetTicksCount()
+        };
+        return GetGameState(view, player->GetDogId(), since, version, keep_alive);
+    }
+
+    StringResponse ApiRequestHandler::GetGameState(const GameStateView& view, model::Dog::Id viewer, std::optional<uint64_t> since,
+                                                   unsigned version, bool keep_alive) const {
+        // рабочие массивы переиспользуются между запросами одного потока - выборка без выделения памяти
+        thread_local std::vector<uint32_t> dog_indices;
+        thread_local std::vector<uint32_t> loot_indices;
+        thread_local model::StateDelta delta;
+        dog_indices.clear();
+        loot_indices.clear();
+
+        // изменения передаются только без области видимости: объекты, покинувшие её, журнал не отражает
+        if (since && view.changes_history && !view.area_index && model::CollectDelta(*view.changes_history, *since, view.tick, delta)) {
+            auto body = json::serialize(json_loader::GetGameStateDeltaObject(delta, view.tick, *since));
+            return Make(http::status::ok, body, version, keep_alive);
+        }
+
+        json::object jo;
+        if (view.area_index && view.area_index->QueryArea(viewer, app_.GetAreaOfInterest(), dog_indices, loot_indices)) {
+            jo = json_loader::GetGameStateObject(view.dogs, view.loots, dog_indices, loot_indices);
+        } else {
+            jo = json_loader::GetGameStateObject(view.dogs, view.loots);
+        }
+        if (since) { // клиент запрашивает изменения с этого шага в следующий раз
+            jo[KeyTick] = view.tick;
+        }
+        auto body = json::serialize(jo);
+        return Make(http::status::ok, body, version, keep_alive);
+    }
+
+    StringResponse ApiRequestHandler::GetTickProfile(unsigned version, bool keep_alive) const {
+        auto jo = json_loader::GetTickProfileObject(*app_.GetTickProfiler());
         auto body = json::serialize(jo);
         return Make(http::status::ok, body, version, keep_alive);
     }
 
-    StringResponse ApiRequestHandler::GetGameState(app::PlayerPtr player, unsigned version, bool keep_alive) const {
-        auto jo = json_loader::GetGameStateObject(app_.GetDogs(player), app_.GetLoots(player));
+    StringResponse ApiRequestHandler::GetRecordsQueue(unsigned version, bool keep_alive) const {
+        auto jo = json_loader::GetRecordsWriterStatsObject(app_.GetRecordsWriter()->GetStats());
         auto body = json::serialize(jo);
         return Make(http::status::ok, body, version, keep_alive);
     }
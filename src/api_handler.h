@@ -10,9 +10,11 @@
 
 #include <boost/beast/http.hpp>
 #include <boost/json.hpp>
+#include <charconv>
 #include <iostream>
 #include <optional>
 #include <string_view>
+#include <unordered_set>
 
 
 namespace http_handler {
@@ -30,10 +32,12 @@ StringResponse SetMapNotFound(unsigned version, bool keep_alive);
 StringResponse SetInvalidMethod(std::string_view message, std::string_view misc_message, unsigned version, bool keep_alive);
 StringResponse SetInvalidContentType(unsigned version, bool keep_alive);
 StringResponse SetFailedParseJson(std::string_view message, unsigned version, bool keep_alive);
-StringResponse SetGameAction(app::PlayerPtr player, std::string_view direction_str, unsigned version, bool keep_alive);
+StringResponse SetGameAction(app::Application& app, app::PlayerPtr player, std::string_view direction_str, unsigned version, bool keep_alive);
 std::optional<app::Token> TryExtractToken(const http::request<http::string_body>& request);
 std::optional<int> ParseQueryInt(const std::string& url, const std::string& field);
 std::pair<int, int> GetStartAndMaxItems(const std::string& query);
+bool IsTargetPath(std::string_view target, std::string_view path); // путь запроса без параметров совпадает с path
+std::optional<uint64_t> GetSinceTick(std::string_view target); // параметр since запроса GameState
 
 class ApiRequestHandler {
 public:
@@ -160,13 +164,14 @@ public:
         }
 
         // 7. GameState
-        if (req.target() == Endpoint::GAME_STATE) { // запрос ../api/v1/game/state
+        if (IsTargetPath(req.target(), Endpoint::GAME_STATE)) { // запрос ../api/v1/game/state[?since=<tick>]
             if (!(IsMethodAllowed(req.method(), {http::verb::get, http::verb::head}))) { // метод отличается от GET или HEAD
                 return SetInvalidMethod(ErrorMessage::GET_IS_EXPECTED, MiscMessage::ALLOWED_GET_HEAD_METHOD, version, keep_alive);
             }
 
-            return HandleWithAuthorization(req, [this](app::PlayerPtr player, auto version, auto keep_alive) {
-                return GetGameState(player, version, keep_alive); // успех
+            const std::optional<uint64_t> since = GetSinceTick(req.target());
+            return HandleWithAuthorization(req, [this, since](app::PlayerPtr player, auto version, auto keep_alive) {
+                return GetGameState(player, since, version, keep_alive); // успех
             });
         }
 
@@ -193,15 +198,97 @@ public:
             }
 
             return HandleWithAuthorization(req, [this, direction_str](app::PlayerPtr player, auto version, auto keep_alive) {
-                return SetGameAction(player, direction_str, version, keep_alive); // успех
+                return SetGameAction(app_, player, direction_str, version, keep_alive); // успех
             });
         }
 
+    // служебные запросы //
+
+        // 9. TickProfile
+        if (req.target() == Endpoint::ADMIN_TICK_PROFILE) { // запрос ../api/v1/admin/tick-profile
+            if (!(IsMethodAllowed(req.method(), {http::verb::get, http::verb::head}))) { // метод отличается от GET или HEAD
+                return SetInvalidMethod(ErrorMessage::GET_IS_EXPECTED, MiscMessage::ALLOWED_GET_HEAD_METHOD, version, keep_alive);
+            }
+
+            if (!app_.GetTickProfiler()) { // профилирование отключено, запрос некорректный
+                auto body = json::serialize(json_loader::MakeErrorJSON(ErrorCode::BAD_REQUEST, ErrorMessage::INVALID_ENDPOINT)); // некорректный запрос 400
+                return Make(http::status::bad_request, body, version, keep_alive);
+            }
+
+            return GetTickProfile(version, keep_alive); // успех
+        }
+
+        // 10. RecordsQueue
+        if (req.target() == Endpoint::ADMIN_RECORDS_QUEUE) { // запрос ../api/v1/admin/records-queue
+            if (!(IsMethodAllowed(req.method(), {http::verb::get, http::verb::head}))) { // метод отличается от GET или HEAD
+                return SetInvalidMethod(ErrorMessage::GET_IS_EXPECTED, MiscMessage::ALLOWED_GET_HEAD_METHOD, version, keep_alive);
+            }
+
+            if (!app_.GetRecordsWriter()) { // БД не подключена, запрос некорректный
+                auto body = json::serialize(json_loader::MakeErrorJSON(ErrorCode::BAD_REQUEST, ErrorMessage::INVALID_ENDPOINT)); // некорректный запрос 400
+                return Make(http::status::bad_request, body, version, keep_alive);
+            }
+
+            return GetRecordsQueue(version, keep_alive); // успех
+        }
+
     // некорректный запрос 400
         auto body = json::serialize(json_loader::MakeErrorJSON(ErrorCode::BAD_REQUEST, ErrorMessage::BAD_REQUEST));
         return Make(http::status::bad_request, body, version, keep_alive);
     }
 
+    // Ответ на PlayersList и GameState по снимку последнего шага Tick - вызывается в потоке ввода-вывода.
+    // std::nullopt - запрос обрабатывается обычным образом в потоке симуляции: снимки отключены, запрос другой
+    // или некорректный, игрок ещё не попал в снимок (вошёл после последнего шага)
+    template <typename Body, typename Allocator>
+    std::optional<StringResponse> TryHandleFromSnapshot(const http::request<Body, http::basic_fields<Allocator>>& req) const {
+        const bool is_players_list = req.target() == Endpoint::PLAYERS_LIST;
+        const bool is_game_state = IsTargetPath(req.target(), Endpoint::GAME_STATE);
+        if (!is_players_list && !is_game_state) {
+            return std::nullopt;
+        }
+        if (!(IsMethodAllowed(req.method(), {http::verb::get, http::verb::head}))) {
+            return std::nullopt;
+        }
+
+        const app::StateSnapshotPtr snapshot = app_.GetStateSnapshot();
+        if (!snapshot) {
+            return std::nullopt;
+        }
+
+        const auto token = TryExtractToken(req);
+        if (!token) {
+            return std::nullopt;
+        }
+
+        const app::StateSnapshot::PlayerLocation* player = snapshot->FindPlayer(*token);
+        if (!player) {
+            return std::nullopt;
+        }
+        const app::SessionSnapshot& session = *snapshot->sessions[player->session_index];
+
+        if (is_players_list) {
+            return GetPlayersList(session.dogs, req.version(), req.keep_alive());
+        }
+        const GameStateView view{
+            session.dogs,
+            session.loots,
+            session.area_index ? &*session.area_index : nullptr,
+            app_.GetStateHistory() > 0 ? &session.changes_history : nullptr,
+            snapshot->tick
+        };
+        return GetGameState(view, player->dog_id, GetSinceTick(req.target()), req.version(), req.keep_alive());
+    }
+
+    // Запросы, которые не читают и не меняют состояние игры: карты неизменны после загрузки,
+    // рекорды читаются из БД. Их можно обрабатывать в любом потоке
+    template <typename Body, typename Allocator>
+    bool IsStatelessRequest(const http::request<Body, http::basic_fields<Allocator>>& req) const {
+        return req.target() == Endpoint::MAPS
+            || req.target().starts_with(Endpoint::MAP)
+            || req.target().starts_with(Endpoint::GAME_RECORDS);
+    }
+
     template <typename Body, typename Allocator>
     bool IsApiRequest(http::request<Body, http::basic_fields<Allocator>>& req) {
         return req.target().starts_with(Endpoint::API);
@@ -215,7 +302,22 @@ private:
     StringResponse SetTick(int time_delta, unsigned version, bool keep_alive) const;
     StringResponse GetGameRecords(int start, int max_items, unsigned version, bool keep_alive) const;
     StringResponse GetPlayersList(app::PlayerPtr player, unsigned version, bool keep_alive) const;
-    StringResponse GetGameState(app::PlayerPtr player, unsigned version, bool keep_alive) const;
+    StringResponse GetPlayersList(const model::Dogs& dogs, unsigned version, bool keep_alive) const;
+    // Состояние сессии на конец шага tick - из снимка или из самой сессии
+    struct GameStateView {
+        const model::Dogs& dogs;
+        const model::Loots& loots;
+        const model::AreaIndex* area_index; // выборка в области видимости собаки, nullptr - всё состояние сессии
+        const model::ChangesHistory* changes_history; // nullptr - журнал изменений отключён
+        uint64_t tick;
+    };
+
+    StringResponse GetGameState(app::PlayerPtr player, std::optional<uint64_t> since, unsigned version, bool keep_alive) const;
+    // since - только изменения после шага since, если журнал их покрывает, иначе всё состояние с номером шага
+    StringResponse GetGameState(const GameStateView& view, model::Dog::Id viewer, std::optional<uint64_t> since,
+                                unsigned version, bool keep_alive) const;
+    StringResponse GetTickProfile(unsigned version, bool keep_alive) const;
+    StringResponse GetRecordsQueue(unsigned version, bool keep_alive) const;
 
     template <typename Body, typename Allocator, typename Handler>
     StringResponse HandleWithAuthorization(const http::request<Body, http::basic_fields<Allocator>>& req, Handler handler) {
@@ -1,5 +1,8 @@
 #include "app.h"
 
+#include <algorithm> // для std::stable_sort в Application::ForEachSession
+#include <atomic> // для барьера перед повторным использованием буфера снимка
+
 namespace app {
 
 using namespace model;
@@ -22,33 +25,35 @@ geom::Point2D CalcNewPosition(const geom::Point2D& pos, const geom::Vec2D& speed
         return dog_id_;
     }
 
-    GameSessionPtr Player::GetSession() const noexcept {
+    const GameSessionPtr& Player::GetSession() const noexcept {
         return session_;
     }
 
+    Dog* Player::GetDog() const noexcept {
+        return session_->GetDog(dog_id_);
+    }
+
 // методы класса Players
 
     // при добавлении игрока возвращаем shared_ptr на него
-    PlayerPtr Players::Add(DogPtr dog, GameSessionPtr session) {
-        session->AddDog(dog);
-        Player player(dog->GetId(), session); // Создаём нового игрока
-        players_.push_back(std::move(std::make_shared<Player>(player)));
-        return players_.back();
+    PlayerPtr Players::Add(Dog dog, GameSessionPtr session) {
+        const Dog::Id dog_id = dog.GetId();
+        session->AddDog(std::move(dog));
+        return Insert(std::make_shared<Player>(dog_id, std::move(session))); // Создаём нового игрока
     }
 
     PlayerPtr Players::FindByDogId(Dog::Id dog_id) noexcept {
-        for (auto& player : players_) {
-            if (*player->GetDogId() == *dog_id) {
-                return player;
-            }
+        if (auto it = dog_id_to_index_.find(dog_id); it != dog_id_to_index_.end()) {
+            return players_[it->second];
         }
         return nullptr;
     }
 
     std::size_t Players::CountPlayersAtMap(const Map::Id map_id) const noexcept {
-        return std::count_if(players_.begin(), players_.end(), [&map_id](const PlayerPtr& player) {
-            return *player->GetSession()->GetMap()->GetId() == *map_id;
-        });
+        if (auto it = players_at_map_.find(map_id); it != players_at_map_.end()) {
+            return it->second;
+        }
+        return 0;
     }
 
     std::size_t Players::CountPlayers() const noexcept {
@@ -61,22 +66,61 @@ geom::Point2D CalcNewPosition(const geom::Point2D& pos, const geom::Vec2D& speed
 
     // для записи всех игрока при восстановлении игры
     void Players::RestorePlayer(const Player& player) {
-        players_.push_back(std::move(std::make_shared<Player>(player)));
+        Insert(std::make_shared<Player>(player));
     }
 
-    // для удаления игрока по Dog::Id при завершении игры
+    // для удаления игрока по Dog::Id при завершении игры - на место удаляемого переносится последний
     void Players::RemoveByDogId(Dog::Id dog_id) {
-        auto it = std::find_if(players_.begin(), players_.end(), [&dog_id](const PlayerPtr& player) {
-            return *player->GetDogId() == *dog_id;
-        });
+        auto it = dog_id_to_index_.find(dog_id);
+        if (it == dog_id_to_index_.end()) {
+            return;
+        }
 
-        if (it != players_.end()) {
-            players_.erase(it);
+        const size_t index = it->second;
+        dog_id_to_index_.erase(it);
+
+        const Map::Id& map_id = players_[index]->GetSession()->GetMap()->GetId();
+        if (auto count_it = players_at_map_.find(map_id); count_it != players_at_map_.end() && --count_it->second == 0) {
+            players_at_map_.erase(count_it);
+        }
+
+        if (index != players_.size() - 1) {
+            players_[index] = std::move(players_.back());
+            dog_id_to_index_[players_[index]->GetDogId()] = index;
+        }
+        players_.pop_back();
+    }
+
+    PlayerPtr Players::Insert(PlayerPtr player) {
+        const size_t index = players_.size();
+        if (auto [it, inserted] = dog_id_to_index_.emplace(player->GetDogId(), index); !inserted) {
+            throw std::invalid_argument("Player with dog id "s + std::to_string(*player->GetDogId()) + " already exists"s);
         }
+        players_.push_back(std::move(player));
+        ++players_at_map_[players_.back()->GetSession()->GetMap()->GetId()];
+        return players_.back();
     }
 
 // методы класс PlayerTokens
 
+// методы класса StateSnapshot
+
+    const SessionSnapshot* StateSnapshot::FindSession(const Token& token) const noexcept {
+        if (const PlayerLocation* location = FindPlayer(token)) {
+            return sessions[location->session_index].get();
+        }
+        return nullptr;
+    }
+
+    const StateSnapshot::PlayerLocation* StateSnapshot::FindPlayer(const Token& token) const noexcept {
+        if (auto it = token_to_session->find(token); it != token_to_session->end()) {
+            return &it->second;
+        }
+        return nullptr;
+    }
+
+// методы класса PlayerTokens
+
     PlayerPtr PlayerTokens::FindPlayerByToken(const Token& token) const noexcept {
         if (auto it = token_to_player_.find(token); it != token_to_player_.end()) {
             return it->second;
@@ -86,7 +130,9 @@ geom::Point2D CalcNewPosition(const geom::Point2D& pos, const geom::Vec2D& speed
 
     const Token PlayerTokens::AddPlayer(PlayerPtr player) {
         const auto token = GenerateToken();
+        dog_id_to_token_.emplace(player->GetDogId(), token);
         token_to_player_.emplace(token, std::move(player));
+        ++version_;
         return token;
     }
 
@@ -96,20 +142,24 @@ geom::Point2D CalcNewPosition(const geom::Point2D& pos, const geom::Vec2D& speed
 
     // для записи всех игроков при восстановлении игры
     void PlayerTokens::RestoreTokenAndPlayer(const Token token, PlayerPtr player) {
+        dog_id_to_token_.emplace(player->GetDogId(), token);
         token_to_player_.emplace(token, player);
+        ++version_;
     }
 
     // для удаления токена и игрока при завершении игры
     void PlayerTokens::RemovePlayerTokenByDogId(Dog::Id dog_id) {
-        for (auto it = token_to_player_.begin(); it != token_to_player_.end();) {
-            if (*it->second->GetDogId() == *dog_id) {
-                it = token_to_player_.erase(it);
-            } else {
-                ++it;
-            }
+        if (auto it = dog_id_to_token_.find(dog_id); it != dog_id_to_token_.end()) {
+            token_to_player_.erase(it->second);
+            dog_id_to_token_.erase(it);
+            ++version_;
         }
     }
 
+    uint64_t PlayerTokens::GetVersion() const noexcept {
+        return version_;
+    }
+
     std::mt19937_64 PlayerTokens::init_generator() {
         std::uniform_int_distribution<std::mt19937_64::result_type> dist;
         return std::mt19937_64(dist(random_device_));
@@ -139,27 +189,43 @@ geom::Point2D CalcNewPosition(const geom::Point2D& pos, const geom::Vec2D& speed
         return player_tokens_.FindPlayerByToken(token);
     }
 
-    const DogPtrs& Application::GetDogs(PlayerPtr player) const noexcept {
+    const Dogs& Application::GetDogs(PlayerPtr player) const noexcept {
         return player->GetSession()->GetDogs();
     }
 
-    const LootPtrs& Application::GetLoots(PlayerPtr player) const noexcept {
+    const Loots& Application::GetLoots(PlayerPtr player) const noexcept {
         return player->GetSession()->GetLoots();
     }
 
-    JoinInfo Application::JoinGame(const std::string& name, const Map::Id& map_id) {
-        if (!game_.HasSession(map_id)) { // сессия привязана к карте (будем считать, что одна карта = одна сессия)
-            GameSession session(game_.FindMap(map_id), game_.GetLootPeriod(), game_.GetLootProbability());
-            // при необходимости создать сессию для карты (будем считать, что число карт >= число сессий)
-            game_.AddSession(std::move(std::make_shared<GameSession>(session)));
+    const AreaIndex* Application::GetAreaIndex(PlayerPtr player) {
+        if (!game_.GetAreaOfInterest().IsEnabled()) {
+            return nullptr;
+        }
+        return &player->GetSession()->GetAreaIndex(game_.GetAreaOfInterest().radius);
+    }
+
+    const AreaOfInterest& Application::GetAreaOfInterest() const noexcept {
+        return game_.GetAreaOfInterest();
+    }
+
+    const ChangesHistory* Application::GetChangesHistory(PlayerPtr player) const noexcept {
+        if (state_history_ticks_ == 0) {
+            return nullptr;
         }
+        return &player->GetSession()->GetChangesHistory();
+    }
+
+    JoinInfo Application::JoinGame(const std::string& name, const Map::Id& map_id) {
+        const GameSessionPtr session = SelectSession(map_id); // экземпляр карты, в который войдёт игрок
+        game_.WakeSession(*session); // усыплённая сессия снова участвует в шаге Tick
 
         Dog::Id dog_id{static_cast<uint32_t>(game_.GetTotalDogsCount())}; // определить идентификатор собаки
         game_.IncreaseTotalDogsCount(); // +1 для следующего id
 
         geom::Point2D pos;
         if (randomize_spawn_points_) { // определить случайные стартовые координаты
-            pos = game_.FindMap(map_id)->GetRandomRoad()->GetRandomPosition(); 
+            RandomEngine& random = session->GetRandomEngine();
+            pos = game_.FindMap(map_id)->GetRandomRoad(random)->GetRandomPosition(random);
         } else { // !!! для тестов: после входа в игру пёс игрока появлялся в начальной точке первой дороги карты
             Point point = game_.FindMap(map_id)->GetRoads().at(0)->GetStart();
             pos = {static_cast<double>(point.x), static_cast<double>(point.y)};
@@ -180,8 +246,18 @@ geom::Point2D CalcNewPosition(const geom::Point2D& pos, const geom::Vec2D& speed
         }
 
         Dog dog(dog_id, name, pos, default_speed, bag_capacity); // создать собаку
-        return JoinInfo{ player_tokens_.AddPlayer(players_.Add(std::move(std::make_shared<Dog>(dog)), game_.GetSession(map_id))), *dog_id };
-        
+        JoinInfo join_info{ player_tokens_.AddPlayer(players_.Add(std::move(dog), session)), *dog_id };
+        if (journal_) {
+            journal_->WriteJoin(name, *map_id);
+        }
+        return join_info;
+    }
+
+    void Application::SetDogAction(const Player& player, std::string_view direction) {
+        player.GetSession()->SetDogAction(player.GetDogId(), direction);
+        if (journal_) {
+            journal_->WriteAction(*player.GetDogId(), direction);
+        }
     }
 
     // Добавляем обработчик сигнала tick и возвращаем объект connection для управления,
@@ -191,11 +267,62 @@ geom::Point2D CalcNewPosition(const geom::Point2D& pos, const geom::Vec2D& speed
     }
 
     void Application::Tick(milliseconds delta) {
-        MoveDogs(delta.count()); // 1. пересчёт позиций собак на карте за время шага Tick
-        UpdateLoots(delta.count()); // 2. обновление количества предметов на карте
-        HandleCollisions(); // 3. обработка столкновений и удаление предметов
-        UpdateDogsTimesAndRemove(delta.count()); // 4. обновление времени игроков и удаление игроков превысивших время бездействия
-        tick_signal_(delta); // Уведомляем подписчиков сигнала tick - для сохранения состояния игры
+        using tick_profiler::Phase;
+        using tick_profiler::ScopedPhaseTimer;
+
+        const int time_delta = static_cast<int>(delta.count());
+        if (journal_) {
+            journal_->WriteTick(static_cast<uint32_t>(time_delta));
+        }
+        const auto tick_start = tick_profiler::Clock::now();
+        tick_profiler::TickProfiler* profiler = tick_profiler_.get();
+        if (profiler) {
+            profiler->BeginTick(game_.GetSessions(), game_.GetActiveSessionIndices());
+        }
+
+        ForEachSession([this, profiler, time_delta](GameSession& session, size_t session_index) {
+            ScopedPhaseTimer timer(profiler, session_index, Phase::MOVE_DOGS);
+            MoveDogs(session, time_delta); // 1. пересчёт позиций собак на карте за время шага Tick
+        });
+        for (const size_t i : game_.GetActiveSessionIndices()) { // последовательно - сквозная нумерация предметов в Game
+            ScopedPhaseTimer timer(profiler, i, Phase::UPDATE_LOOTS);
+            UpdateLoots(*game_.GetSessions()[i], time_delta); // 2. обновление количества предметов на карте
+        }
+        ForEachSession([this, profiler](GameSession& session, size_t session_index) {
+            ScopedPhaseTimer timer(profiler, session_index, Phase::HANDLE_COLLISIONS);
+            HandleCollisions(session); // 3. обработка столкновений и удаление предметов
+        });
+        UpdateDogsTimesAndRemove(time_delta); // 4. обновление времени игроков и удаление игроков превысивших время бездействия
+        ReleaseSessions(); // 5. освобождение пустых экземпляров карт
+        if (profiler) {
+            profiler->SyncSessions(game_.GetSessions()); // индексы сессий после удаления сдвинулись
+        }
+        ++ticks_count_;
+        if (state_history_ticks_ > 0) {
+            ForEachSession([this, profiler](GameSession& session, size_t session_index) {
+                ScopedPhaseTimer timer(profiler, session_index, Phase::COMMIT_CHANGES);
+                session.CommitChanges(ticks_count_, state_history_ticks_); // 6. журнал изменений для ответов с since
+            });
+        }
+        if (snapshots_enabled_) {
+            PublishStateSnapshot(profiler); // 7. снимок состояния для чтения в потоках ввода-вывода
+        }
+
+        const auto signal_start = tick_profiler::Clock::now();
+        tick_signal_(delta); // Уведомляем подписчиков сигнала tick - для сохранения состояния игры (после завершения всех сессий)
+        if (profiler) {
+            const auto tick_end = tick_profiler::Clock::now();
+            profiler->EndTick(tick_end - signal_start, tick_end - tick_start);
+        }
+    }
+
+    void Application::EnableStateSnapshots() {
+        snapshots_enabled_ = true;
+        PublishStateSnapshot(nullptr); // снимок доступен и до первого шага Tick
+    }
+
+    StateSnapshotPtr Application::GetStateSnapshot() const {
+        return std::atomic_load_explicit(&snapshot_, std::memory_order_acquire);
     }
 
     bool Application::HasTickPeriod() const noexcept {
@@ -206,6 +333,50 @@ geom::Point2D CalcNewPosition(const geom::Point2D& pos, const geom::Vec2D& speed
         return tick_period_;
     }
 
+    uint64_t Application::GetTicksCount() const noexcept {
+        return ticks_count_;
+    }
+
+    void Application::SetTickThreads(unsigned threads_count) {
+        if (threads_count > 1) {
+            tick_pool_ = std::make_unique<worker_pool::WorkerPool>(threads_count);
+        } else {
+            tick_pool_.reset();
+        }
+    }
+
+    unsigned Application::GetTickThreads() const noexcept {
+        return tick_pool_ ? tick_pool_->GetThreadsCount() : 1;
+    }
+
+    void Application::SetTickProfileWindow(size_t window) {
+        if (window > 0) {
+            tick_profiler_ = std::make_unique<tick_profiler::TickProfiler>(window);
+        } else {
+            tick_profiler_.reset();
+        }
+    }
+
+    const tick_profiler::TickProfiler* Application::GetTickProfiler() const noexcept {
+        return tick_profiler_.get();
+    }
+
+    void Application::SetStateHistory(size_t ticks) {
+        state_history_ticks_ = ticks;
+    }
+
+    size_t Application::GetStateHistory() const noexcept {
+        return state_history_ticks_;
+    }
+
+    void Application::SetRandomSeed(uint64_t seed) {
+        game_.SetRandomSeed(seed);
+    }
+
+    void Application::SetJournal(std::shared_ptr<journal::JournalWriter> journal) {
+        journal_ = std::move(journal);
+    }
+
     // методы для сохранения состояния игры (применяются в app_serialization.h)
 
     const Game& Application::GetGame() const noexcept { 
@@ -236,132 +407,170 @@ geom::Point2D CalcNewPosition(const geom::Point2D& pos, const geom::Vec2D& speed
 
     void Application::SetConnectionPool(postgres::ConnectionPoolPtr pool) {
         pool_ = pool;
+        records_writer_ = std::make_unique<records_writer::RecordsWriter>([pool](const postgres::PlayersRecords& records) {
+            postgres::DataBase::AddRecords(pool, records);
+        });
     }
 
     postgres::PlayersRecords Application::GetRecords(int start, int max_items) {
         return postgres::DataBase::GetRecords(pool_, start, max_items);
     }
 
-    void Application::MoveDogs(int time_delta) {
-        for (auto& player : players_.GetPlayers()) { // для каждого пса игрока
-            DogPtr dog = player->GetSession()->GetDog(player->GetDogId());
+    const records_writer::RecordsWriter* Application::GetRecordsWriter() const noexcept {
+        return records_writer_.get();
+    }
+
+    void Application::ForEachSession(const SessionTask& task) {
+        const GameSessionPtrs& sessions = game_.GetSessions();
+        const std::vector<size_t>& active_sessions = game_.GetActiveSessionIndices(); // усыплённые сессии пропускаются
+        if (!tick_pool_) {
+            for (const size_t i : active_sessions) {
+                task(*sessions[i], i);
+            }
+            return;
+        }
+
+        // самые нагруженные сессии отдаём потокам первыми, чтобы в конце шага не ждать одну большую
+        sessions_order_.assign(active_sessions.begin(), active_sessions.end());
+        std::stable_sort(sessions_order_.begin(), sessions_order_.end(), [&sessions](size_t lhs, size_t rhs) {
+            return sessions[lhs]->GetDogsCount() > sessions[rhs]->GetDogsCount();
+        });
+
+        tick_pool_->ParallelFor(sessions_order_.size(), [this, &sessions, &task](size_t i) {
+            const size_t session_index = sessions_order_[i];
+            task(*sessions[session_index], session_index);
+        });
+    }
+
+    void Application::MoveDogs(GameSession& session, int time_delta) {
+        const Map* map = session.GetMap();
 
-            const geom::Point2D pos = dog->GetPosition(); // текущая позиция на дороге
-            const geom::Vec2D speed = dog->GetSpeed(); 
-            const Direction dir = dog->GetDirection();
+        for (Dog& dog : session.GetDogs()) { // для каждого пса в сессии
+            const geom::Point2D pos = dog.GetPosition(); // текущая позиция на дороге
+            const geom::Vec2D speed = dog.GetSpeed(); 
+            if (speed.x == 0.0 && speed.y == 0.0) { // стоящая собака остаётся на месте - дороги искать не нужно
+                dog.SetPosition(pos);
+                continue;
+            }
+            const Direction dir = dog.GetDirection();
             const geom::Point2D new_pos = CalcNewPosition(pos, speed, time_delta); // новая позиция на дороге
 
-            const Map* map = player->GetSession()->GetMap();
+            // дороги ищутся через участки, на которых собака была на прошлом шаге
+            RoadCursor& cursor = dog.GetRoadCursor();
+            const bool is_horizontal = dir == Direction::EAST || dir == Direction::WEST;
 
             // вдоль дороги
-            const RoadPtr road = map->FindRoadByPositionAndDirection(pos, dir);
-            const RoadPtr new_road = map->FindRoadByPositionAndDirection(new_pos, dir);
-
-            // поперёк дороги
-            const RoadPtr across_road = map->FindRoadByPositionAndDirection(pos, dir, false);
-            const RoadPtr across_new_road = map->FindRoadByPositionAndDirection(new_pos, dir, false);
+            const Road* road = map->FindRoad(pos, is_horizontal, cursor);
+            const Road* new_road = map->FindRoad(new_pos, is_horizontal, cursor);
 
             // движение вдоль дороги
             if (road && new_road) { // обе точки на одной дороге - движение в конечную точку
-                dog->SetPosition(new_pos);
+                dog.SetPosition(new_pos);
+                continue;
             } else if (road && !new_road) { // начальная точка на дороге, конечная вне дороги - движение вдоль дороги на край
-                dog->SetPosition(road->GetBoundaryPositionWithOffset(pos, dir));
-                dog->SetSpeed({0.0, 0.0});
+                dog.SetPosition(road->GetBoundaryPositionWithOffset(pos, dir));
+                dog.SetSpeed({0.0, 0.0});
+                continue;
+            }
+
+            // поперёк дороги - только если вдоль направления движения дороги нет
+            const Road* across_road = map->FindRoad(pos, !is_horizontal, cursor);
+            const Road* across_new_road = map->FindRoad(new_pos, !is_horizontal, cursor);
 
             // движение поперёк дороги
-            } else if (across_road && across_new_road) { // обе точки на одной дороге - движение в конечную точку
-                dog->SetPosition(new_pos);
+            if (across_road && across_new_road) { // обе точки на одной дороге - движение в конечную точку
+                dog.SetPosition(new_pos);
             } else { // обе точки вне дороги - движение на край поперёк дороги - есть еще один случай, когда пёс не оказывается сразу на границе дороги - проверить по другим дорогам
-                dog->SetPosition(across_road->GetBoundaryPositionWithOffset(pos, dir));
-                dog->SetSpeed({0.0, 0.0});
+                dog.SetPosition(across_road->GetBoundaryPositionWithOffset(pos, dir));
+                dog.SetSpeed({0.0, 0.0});
             }
         }
     }
 
-    void Application::UpdateLoots(int time_delta) {
-        for (auto& game_session: game_.GetSessions()) { // проходим все сессии
-            const Map* map = game_session->GetMap();
+    void Application::UpdateLoots(GameSession& session, int time_delta) {
+        const Map* map = session.GetMap();
 
-            size_t looter_count = game_session->GetDogsCount(); // игроки
-            size_t loot_count = game_session->GetLootsCount(); // предметы
-            auto loot_generator = game_session->GetLootGenerator(); // генератор предметов
+        size_t looter_count = session.GetDogsCount(); // игроки
+        size_t loot_count = session.GetLootsCount(); // предметы
+        auto loot_generator = session.GetLootGenerator(); // генератор предметов
 
-            unsigned new_loot_count = loot_generator->Generate( // проверяем, сколько еще предметов нужно добавить
-                milliseconds(time_delta), loot_count, looter_count);
+        unsigned new_loot_count = loot_generator->Generate( // проверяем, сколько еще предметов нужно добавить
+            milliseconds(time_delta), loot_count, looter_count);
+        RandomEngine& random = session.GetRandomEngine();
 
-            for (unsigned i = 0; i < new_loot_count; ++i) { // генерим новые предметы
-                Loot loot;
-                loot.id = Loot::Id{game_.GetTotalLootsCount()}; // id предмета
-                game_.IncreaseTotalLootsCount(); // +1 для следующего id
-                loot.type = GetRandomNumber(size_t(0), map->GetLootTypesCount() - 1);
-                loot.pos = map->GetRandomRoad()->GetRandomPosition();
-                game_session->AddLoot(std::move(std::make_shared<Loot>(loot)));
-            }
+        for (unsigned i = 0; i < new_loot_count; ++i) { // генерим новые предметы
+            Loot loot;
+            loot.id = Loot::Id{game_.GetTotalLootsCount()}; // id предмета
+            game_.IncreaseTotalLootsCount(); // +1 для следующего id
+            loot.type = GetRandomNumber(size_t(0), map->GetLootTypesCount() - 1, random);
+            loot.pos = map->GetRandomRoad(random)->GetRandomPosition(random);
+            session.AddLoot(std::move(loot));
         }
     }
 
-    void Application::HandleCollisions() {
+    void Application::HandleCollisions(GameSession& session) {
         using namespace collision_detector;
-        for (auto& game_session: game_.GetSessions()) { // проходим все сессии
-            const DogPtrs dogs = game_session->GetDogs(); // получаем вектор собирателей
-            std::vector<Gatherer> gatherers;
-            gatherers.reserve(dogs.size());
-            for (size_t i = 0; i < dogs.size(); ++i) { // индексы собирателей совпадают с индексами Dogs в сессии на карте
-                geom::Point2D start_pos = dogs.at(i)->GetPrevPosition(); // позиция до Application::MoveDogs - до начала хода
-                geom::Point2D end_pos = dogs.at(i)->GetPosition(); 
-
-                gatherers.emplace_back(Gatherer{
-                    { start_pos.x, start_pos.y },
-                    { end_pos.x, end_pos.y },
-                    DOG_HALF_WIDTH
-                });
-            }
-
-            const LootPtrs& loots = game_session->GetLoots(); // получаем ссылку вектор предметов
-            const Map::Offices offices = game_session->GetMap()->GetOffices(); // получаем вектор офисов
-            std::vector<Item> items;
-            items.reserve(loots.size() + offices.size()); // вектор коллизий с предметами и офисами
+        Dogs& dogs = session.GetDogs(); // получаем ссылку на вектор собирателей
+        std::vector<Gatherer> gatherers;
+        gatherers.reserve(dogs.size());
+        for (size_t i = 0; i < dogs.size(); ++i) { // индексы собирателей совпадают с индексами Dogs в сессии на карте
+            geom::Point2D start_pos = dogs[i].GetPrevPosition(); // позиция до Application::MoveDogs - до начала хода
+            geom::Point2D end_pos = dogs[i].GetPosition(); 
+
+            gatherers.emplace_back(Gatherer{
+                { start_pos.x, start_pos.y },
+                { end_pos.x, end_pos.y },
+                DOG_HALF_WIDTH
+            });
+        }
 
-            // Добавляем предметы (индексация items предметов совпадают с loots)
-            for (size_t i = 0; i < loots.size(); ++i) {
-                geom::Point2D pos = loots.at(i)->pos;
-                items.push_back({ { pos.x, pos.y }, LOOT_HALF_WIDTH });
+        // предметы и офисы рядом с путём каждой собаки - из индекса предметов сессии и индекса офисов карты.
+        // Индексы: предметы - как в loots, офисы сдвинуты на loots.size()
+        const Loots& loots = session.GetLoots(); // получаем ссылку вектор предметов
+        const Map::Offices& offices = session.GetMap()->GetOffices(); // получаем ссылку на вектор офисов - для get_item
+        const size_t loots_count = loots.size();
+        const Map* map = session.GetMap();
+        const auto find_candidates = [&session, map, loots_count](const Gatherer& gatherer, std::vector<uint32_t>& out) {
+            const GatherBounds loot_bounds = GetGatherBounds(gatherer, LOOT_HALF_WIDTH);
+            session.QueryLoots(loot_bounds.min_corner, loot_bounds.max_corner, out);
+
+            const size_t first_office = out.size();
+            const GatherBounds office_bounds = GetGatherBounds(gatherer, OFFICE_HALF_WIDTH);
+            map->QueryOffices(office_bounds.min_corner, office_bounds.max_corner, out);
+            for (size_t i = first_office; i < out.size(); ++i) {
+                out[i] += static_cast<uint32_t>(loots_count);
             }
-
-            // Добавляем офисы (индексация офисов сдвинута на loots.size())
-            for (size_t i = 0; i < offices.size(); ++i) {
-                Point point = offices.at(i).GetPosition();
-                items.push_back({ { static_cast<double>(point.x), static_cast<double>(point.y) }, OFFICE_HALF_WIDTH });
+        };
+        const auto get_item = [&loots, &offices, loots_count](uint32_t index) {
+            if (index < loots_count) {
+                return Item{loots[index].pos, LOOT_HALF_WIDTH};
             }
+            const Point point = offices[index - loots_count].GetPosition();
+            return Item{{static_cast<double>(point.x), static_cast<double>(point.y)}, OFFICE_HALF_WIDTH};
+        };
+        const auto events = FindGatherEvents(gatherers, find_candidates, get_item); // получаем вектор событий для каждой сессии
+
+        // TakeLoot переставляет предметы в loots - индексы событий переводятся в Loot::Id по состоянию на начало хода
+        std::vector<Loot::Id> event_loot_ids(events.size(), Loot::Id{0});
+        for (size_t i = 0; i < events.size(); ++i) {
+            if (events[i].item_id < loots_count) {
+                event_loot_ids[i] = loots[events[i].item_id].id;
+            }
+        }
 
-            const auto events = FindGatherEvents(ModelItemGathererProvider(items, gatherers)); // получаем вектор событий для каждой сессии
-
-            std::unordered_set<size_t> collected_loot_ids; // сохраняем индексы собранных предметов, чтобы удалить их из loots в сессии на карте
-            for (const auto& event : events) {
-                size_t dog_index = event.gatherer_id; // индексы gatherers и dogs совпадают
-                size_t loot_or_office_index = event.item_id; // индексы items совпадают c loots, далее идут индексы offices
-
-                const Dog::Id dog_id = game_session->GetDogs().at(dog_index)->GetId(); // получаем ID собаки
-                DogPtr dog = game_session->GetDog(dog_id); // и по найденному ID получаем указатель
+        for (size_t i = 0; i < events.size(); ++i) {
+            size_t dog_index = events[i].gatherer_id; // индексы gatherers и dogs совпадают
+            size_t loot_or_office_index = events[i].item_id; // индексы предметов совпадают c loots, далее идут индексы offices
 
-                if (loot_or_office_index >= loots.size()) { // офис - сбросить лут из рюкзака и получить награду за каждый тип предмета
-                    const Map::LootTypes loot_types = game_session->GetMap()->GetLootTypes(); // получаем все типы предметов для карты в сессии
-                    dog->UpdateScore(loot_types);
+            Dog& dog = dogs[dog_index]; // индексы собак не меняются до конца обработки столкновений
 
-                } else { // предмет - проверить, был ли собран этот предмет ранее другим собирателем
+            if (loot_or_office_index >= loots_count) { // офис - сбросить лут из рюкзака и получить награду за каждый тип предмета
+                dog.UpdateScore(session.GetMap()->GetLootTypes()); // по всем типам предметов для карты в сессии
 
-                    if (collected_loot_ids.contains(loot_or_office_index)) {
-                        continue; // игнорируем, переходим к следующему событию
-                    }
-
-                    if (!dog->IsBagFull()) {
-                        Loot::Id loot_id = loots.at(loot_or_office_index)->id;
-                        LootPtr loot = game_session->TakeLoot(loot_id); // забираем нужный предмет по Loot::ID из loots_
-                        if (loot) {
-                            dog->AddLootIntoBag(std::move(loot));
-                            collected_loot_ids.insert(loot_or_office_index);
-                        }
-                    }
+            } else if (!dog.IsBagFull()) { // предмет, собранный ранее другим собирателем, TakeLoot уже не найдёт
+                std::optional<Loot> loot = session.TakeLoot(event_loot_ids[i]); // забираем нужный предмет по Loot::ID из loots_
+                if (loot) {
+                    dog.AddLootIntoBag(*loot);
                 }
             }
         }
@@ -374,39 +583,217 @@ geom::Point2D CalcNewPosition(const geom::Point2D& pos, const geom::Vec2D& speed
     }
 
     void Application::UpdateDogsTimesAndRemove(const int time_delta) {
-        std::unordered_set<uint32_t> dog_ids_to_remove; // собираем id собак, превысивших время ожидания, для удаления
-        for (auto& player : players_.GetPlayers()) { // для каждого пса игрока
-            DogPtr dog = player->GetSession()->GetDog(player->GetDogId());
-
-            // обновляем время бездействия
-            if (dog->IsMoving()) { // собака переместилась на текущем шаге времени Tick
-                dog->ResetInactivityTime();
-                dog->IncreasePlayTime(time_delta); // обновляем время в игре, только когда собака движется
-            } else {
-                dog->IncreaseInactivityTime(time_delta);
+        // собираем собак, превысивших время ожидания, отдельно по каждой сессии - списки заполняются
+        // только у активных сессий, размер меняется лишь при появлении новых сессий
+        if (retired_dogs_.size() < game_.GetSessionsCount()) {
+            retired_dogs_.resize(game_.GetSessionsCount());
+        }
+        ForEachSession([this, time_delta](GameSession& session, size_t session_index) {
+            tick_profiler::ScopedPhaseTimer timer(tick_profiler_.get(), session_index, tick_profiler::Phase::UPDATE_DOGS_TIMES_AND_REMOVE);
+            retired_dogs_[session_index].clear();
+            session.AdvanceTime(time_delta, retired_dogs_[session_index]); // сроки ухода ведёт колесо таймеров сессии
+        });
+
+        // ставим статистику в очередь записи в БД и удаляем собак последовательно в порядке сессий
+        const GameSessionPtrs& sessions = game_.GetSessions();
+        for (const size_t i : game_.GetActiveSessionIndices()) {
+            tick_profiler::ScopedPhaseTimer timer(tick_profiler_.get(), i, tick_profiler::Phase::UPDATE_DOGS_TIMES_AND_REMOVE);
+            for (const Dog::Id dog_id : retired_dogs_[i]) {
+                if (records_writer_) {
+                    const Dog* dog = sessions[i]->GetDog(dog_id); // поиск по Dog::Id - индексы меняются при удалении собак
+                    postgres::PlayerRecord record;
+                    record.uuid = util::detail::UUIDToString(util::detail::NewUUID());
+                    record.name = dog->GetName();
+                    record.score = dog->GetScore();
+                    // Дословно: "Время, которое игрок провёл в игре, включает в себя время бездействия, прошедшее с момента последней остановки.
+                    record.play_time_ms = static_cast<int>(dog->GetPlayTime() + game_.GetRetirementTime() * MILLISECONDS_PER_SECOND);
+                    records_writer_->Push(std::move(record)); // при переполнении очереди запись отбрасывается и учитывается в статистике
+                }
+                LeaveGame(dog_id);
+            }
+        }
+    }
+
+    // Новый игрок входит в наименее загруженный экземпляр карты, в котором есть место. Если места нет,
+    // возвращается в игру освобождаемый экземпляр, а если нет и его - создаётся новый экземпляр карты
+    GameSessionPtr Application::SelectSession(const Map::Id& map_id) {
+        const size_t max_players = game_.GetMaxPlayers(*game_.FindMap(map_id));
+        GameSessionPtr least_loaded;
+        GameSessionPtr most_loaded_draining; // в нём меньше всего места - быстрее заполнится снова
+        for (const GameSessionPtr& session : game_.GetMapSessions(map_id)) {
+            const size_t dogs_count = session->GetDogsCount();
+            if (max_players != 0 && dogs_count >= max_players) {
+                continue;
             }
+            if (session->IsDraining()) {
+                if (!most_loaded_draining || dogs_count > most_loaded_draining->GetDogsCount()) {
+                    most_loaded_draining = session;
+                }
+            } else if (!least_loaded || dogs_count < least_loaded->GetDogsCount()) {
+                least_loaded = session;
+            }
+        }
 
-            dog->Stopped(); // сбрасываем метку движения на текущем тике
+        if (least_loaded) {
+            return least_loaded;
+        }
+        if (most_loaded_draining) {
+            most_loaded_draining->SetDraining(false);
+            return most_loaded_draining;
+        }
+        auto session = std::make_shared<GameSession>(game_.FindMap(map_id), game_.GetLootPeriod(), game_.GetLootProbability());
+        game_.AddSession(session);
+        return session;
+    }
+
+    // Лишний экземпляр карты освобождается, когда в нём не остаётся собак. Если игроки карты помещаются
+    // в меньшее число экземпляров, наименее загруженный перестаёт принимать игроков и освобождается после их ухода.
+    // Первый экземпляр карты не освобождается, а усыпляется, когда в нём не остаётся собак
+    void Application::ReleaseSessions() {
+        // карты с активными сессиями - у остальных все экземпляры уже усыплены или освобождены
+        std::vector<const Map*> active_maps;
+        for (const size_t i : game_.GetActiveSessionIndices()) {
+            active_maps.push_back(game_.GetSessions()[i]->GetMap());
+        }
+        std::sort(active_maps.begin(), active_maps.end());
+        active_maps.erase(std::unique(active_maps.begin(), active_maps.end()), active_maps.end());
+
+        bool removed = false;
+        for (const Map* active_map : active_maps) {
+            const Map& map = *active_map;
+            const GameSessionPtrs& map_sessions = game_.GetMapSessions(map.GetId());
+            if (map_sessions.size() < 2) {
+                continue;
+            }
 
-            // проверяем превышение времени бездействия
-            if (dog->GetInactivityTime() >= game_.GetRetirementTime() * MILLISECONDS_PER_SECOND) {
-                dog_ids_to_remove.insert(*dog->GetId());
+            std::vector<const GameSession*> empty_sessions;
+            for (size_t i = 1; i < map_sessions.size(); ++i) {
+                if (map_sessions[i]->GetDogsCount() == 0) {
+                    empty_sessions.push_back(map_sessions[i].get());
+                }
+            }
+            for (const GameSession* session : empty_sessions) {
+                game_.RemoveSession(session);
+                removed = true;
+            }
 
-                // сохраняем статистику в БД
-                postgres::PlayerRecord record;
-                record.uuid = util::detail::UUIDToString(util::detail::NewUUID());
-                record.name = dog->GetName();
-                record.score = dog->GetScore();
-                // Дословно: "Время, которое игрок провёл в игре, включает в себя время бездействия, прошедшее с момента последней остановки.
-                record.play_time_ms = static_cast<int>(dog->GetPlayTime() + game_.GetRetirementTime() * MILLISECONDS_PER_SECOND);
-                postgres::DataBase::AddRecord(pool_, record);
+            const size_t max_players = game_.GetMaxPlayers(map);
+            if (max_players == 0) {
+                continue;
+            }
+            size_t dogs_count = 0;
+            size_t active_count = 0;
+            for (const GameSessionPtr& session : map_sessions) {
+                dogs_count += session->GetDogsCount();
+                active_count += session->IsDraining() ? 0 : 1;
+            }
+            while (active_count > 1 && dogs_count <= max_players * (active_count - 1)) {
+                GameSession* least_loaded = nullptr;
+                for (size_t i = 1; i < map_sessions.size(); ++i) {
+                    GameSession* session = map_sessions[i].get();
+                    if (!session->IsDraining() && (!least_loaded || session->GetDogsCount() < least_loaded->GetDogsCount())) {
+                        least_loaded = session;
+                    }
+                }
+                if (!least_loaded) {
+                    break;
+                }
+                least_loaded->SetDraining(true);
+                --active_count;
             }
         }
 
-        // удаляем собак, превысивших время ожидания
-        for (const auto id : dog_ids_to_remove) {
-            LeaveGame(Dog::Id{id});
+        if (removed) {
+            snapshot_tokens_.reset(); // индексы сессий в снимке сдвинулись - индекс токенов нужно пересобрать
+            snapshot_layout_stale_ = true;
         }
+
+        for (const Map* map : active_maps) {
+            for (const GameSessionPtr& session : game_.GetMapSessions(map->GetId())) {
+                if (session->GetDogsCount() == 0) {
+                    game_.HibernateSession(*session);
+                }
+            }
+        }
+    }
+
+    void Application::PublishStateSnapshot(tick_profiler::TickProfiler* profiler) {
+        const GameSessionPtrs& sessions = game_.GetSessions();
+        const std::vector<size_t>& active_sessions = game_.GetActiveSessionIndices();
+        if (snapshot_layout_stale_) { // после удаления сессий буферы раскладываются заново - это редкий шаг
+            snapshot_front_.clear();
+            snapshot_back_.clear();
+            snapshot_sessions_.clear();
+            snapshot_active_.clear();
+            snapshot_layout_stale_ = false;
+        }
+        // новые сессии добавляются в конец - у остальных место не меняется
+        snapshot_front_.resize(sessions.size());
+        snapshot_back_.resize(sessions.size());
+        snapshot_sessions_.resize(sessions.size());
+
+        // сессия, усыплённая после прошлого снимка, освобождает буферы один раз - в ней нет игроков
+        auto active = active_sessions.begin();
+        for (const size_t i : snapshot_active_) {
+            while (active != active_sessions.end() && *active < i) {
+                ++active;
+            }
+            if (active == active_sessions.end() || *active != i) {
+                snapshot_front_[i].reset();
+                snapshot_back_[i].reset();
+                snapshot_sessions_[i].reset();
+            }
+        }
+        snapshot_active_.assign(active_sessions.begin(), active_sessions.end());
+
+        // индекс токенов пересобирается, только если игроки входили или выходили. Игроки есть только в активных сессиях
+        if (!snapshot_tokens_ || snapshot_tokens_version_ != player_tokens_.GetVersion()) {
+            std::unordered_map<const GameSession*, size_t> session_to_index;
+            for (const size_t i : active_sessions) {
+                session_to_index.emplace(sessions[i].get(), i);
+            }
+
+            auto token_to_session = std::make_shared<StateSnapshot::TokenToSession>();
+            token_to_session->reserve(player_tokens_.GetPlayerTokens().size());
+            for (const auto& [token, player] : player_tokens_.GetPlayerTokens()) {
+                token_to_session->emplace(token, StateSnapshot::PlayerLocation{
+                    session_to_index.at(player->GetSession().get()), player->GetDogId()});
+            }
+            snapshot_tokens_ = std::move(token_to_session);
+            snapshot_tokens_version_ = player_tokens_.GetVersion();
+        }
+
+        ForEachSession([this, profiler](GameSession& session, size_t session_index) {
+            tick_profiler::ScopedPhaseTimer timer(profiler, session_index, tick_profiler::Phase::PUBLISH_SNAPSHOT);
+            std::shared_ptr<SessionSnapshot>& back = snapshot_back_[session_index];
+            if (!back || back.use_count() != 1) { // буфер ещё держит читатель одного из прошлых снимков
+                back = std::make_shared<SessionSnapshot>();
+            } else {
+                // use_count читается без упорядочения: чтения последнего читателя буфера должны завершиться
+                // до записи в него - в паре с release при уменьшении счётчика ссылок
+                std::atomic_thread_fence(std::memory_order_acquire);
+            }
+            back->dogs = session.GetDogs(); // присваивание использует уже выделенную память буфера
+            back->loots = session.GetLoots();
+            if (const AreaOfInterest& area_of_interest = game_.GetAreaOfInterest(); area_of_interest.IsEnabled()) {
+                back->area_index = session.GetAreaIndex(area_of_interest.radius); // ячейка сетки - радиус видимости
+            } else {
+                back->area_index.reset();
+            }
+            if (state_history_ticks_ > 0) {
+                back->changes_history = session.GetChangesHistory(); // O(1) - список записей разделяется с сессией
+            } else {
+                back->changes_history = ChangesHistory{};
+            }
+            std::swap(back, snapshot_front_[session_index]);
+            snapshot_sessions_[session_index] = snapshot_front_[session_index];
+        });
+
+        auto snapshot = std::make_shared<StateSnapshot>();
+        snapshot->tick = ticks_count_;
+        snapshot->token_to_session = snapshot_tokens_;
+        snapshot->sessions = snapshot_sessions_; // у усыплённых сессий nullptr - копируется без подсчёта ссылок
+        std::atomic_store_explicit(&snapshot_, StateSnapshotPtr{std::move(snapshot)}, std::memory_order_release);
     }
 
 } // namespace app
\ No newline at end of file
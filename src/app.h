@@ -2,21 +2,27 @@
 
 #include "geom.h" // для geom::Point2D
 #include "collision_detector.h" // для обработки столкновений в HandleCollisions
+#include "journal.h" // для записи команд, изменяющих состояние игры
 #include "model.h" // сушности для игры Dog, Map, Loot
 #include "postgres.h" // для сохранения рекордов в БД при удалении из игры
+#include "records_writer.h" // для отложенной записи рекордов вне шага Tick
 #include "tagged.h" // для Token
 #include "tagged_uuid.h" // для uuid при добавлении в БД
+#include "tick_profiler.h" // для измерения времени фаз шага Tick по сессиям
+#include "worker_pool.h" // для параллельного выполнения шага Tick по сессиям
 
 #include <boost/signals2.hpp> // для Application::DoOnTick
 #include <chrono> // для Application::Tick
 #include <cstdint> // uint32_t в ::ID
+#include <functional> // для задач Application::ForEachSession
+#include <memory> // для std::unique_ptr на пул потоков
+#include <optional> // для SessionSnapshot::area_index
 #include <random> // для генератора токена
 #include <regex> // для проверки токена
 #include <string>
 #include <string_view>
 #include <sstream>
 #include <unordered_map> // для токенов игроков в PlayerTokens
-#include <unordered_set> // для учета предметов HandleCollisions и id собак в UpdateDogsTimesAndRemove
 
 
 namespace app {
@@ -27,6 +33,8 @@ namespace sig = boost::signals2;
 using milliseconds = std::chrono::milliseconds;
 using namespace std::literals;
 
+constexpr size_t DEFAULT_STATE_HISTORY_TICKS = 0; // шагов Tick в журнале изменений сессий, 0 - изменения не отслеживаются
+
 class Player;
 using PlayerPtr = std::shared_ptr<Player>;
 using PlayerPtrs = std::vector<std::shared_ptr<Player>>;
@@ -55,7 +63,8 @@ public:
     }
 
     Dog::Id GetDogId() const noexcept;
-    GameSessionPtr GetSession() const noexcept;
+    const GameSessionPtr& GetSession() const noexcept;
+    Dog* GetDog() const noexcept; // собака игрока из его сессии - поиск по индексу за O(1)
 
 private:
     Dog::Id dog_id_;
@@ -64,7 +73,7 @@ private:
 
 class Players {
 public:
-    PlayerPtr Add(DogPtr dog, GameSessionPtr session); // при добавлении игрока возвращаем shared_ptr на него
+    PlayerPtr Add(Dog dog, GameSessionPtr session); // при добавлении игрока возвращаем shared_ptr на него
     PlayerPtr FindByDogId(Dog::Id dog_id) noexcept;
     std::size_t CountPlayersAtMap(const Map::Id map_id) const noexcept;
     std::size_t CountPlayers() const noexcept;
@@ -73,9 +82,46 @@ public:
     void RemoveByDogId(Dog::Id dog_id); // для удаления игрока по Dog::Id при завершении игры
 
 private:
+    using DogIdToIndex = std::unordered_map<Dog::Id, size_t, util::TaggedHasher<Dog::Id>>;
+    using MapIdToCount = std::unordered_map<Map::Id, size_t, util::TaggedHasher<Map::Id>>;
+
     PlayerPtrs players_;
+    DogIdToIndex dog_id_to_index_; // индекс игрока в players_ по Dog::Id
+    MapIdToCount players_at_map_; // число игроков на каждой карте
+
+    PlayerPtr Insert(PlayerPtr player);
+};
+
+// Неизменяемый снимок состояния сессии на конец шага Tick
+struct SessionSnapshot {
+    Dogs dogs;
+    Loots loots;
+    std::optional<AreaIndex> area_index; // только при включённой области видимости
+    ChangesHistory changes_history; // только при включённом журнале изменений
+};
+
+using SessionSnapshotPtr = std::shared_ptr<const SessionSnapshot>;
+
+// Снимок состояния игры на конец шага Tick. Публикуется целиком и после публикации не меняется,
+// поэтому читается из любого потока без синхронизации с шагом Tick. Память снимка освобождается, когда его
+// отпускает последний читатель (подсчёт ссылок shared_ptr)
+struct StateSnapshot {
+    struct PlayerLocation {
+        size_t session_index;
+        Dog::Id dog_id;
+    };
+    using TokenToSession = std::unordered_map<Token, PlayerLocation, util::TaggedHasher<Token>>;
+
+    uint64_t tick = 0; // номер шага Tick, на конец которого снят снимок
+    std::shared_ptr<const TokenToSession> token_to_session; // индекс сессии и собака игрока по токену
+    std::vector<SessionSnapshotPtr> sessions; // индексы совпадают с Game::GetSessions(), у усыплённых сессий nullptr
+
+    const SessionSnapshot* FindSession(const Token& token) const noexcept; // nullptr - игрока нет в снимке
+    const PlayerLocation* FindPlayer(const Token& token) const noexcept;
 };
 
+using StateSnapshotPtr = std::shared_ptr<const StateSnapshot>;
+
 class PlayerTokens {
 public:
     using player_tokens = std::unordered_map<const Token, PlayerPtr, util::TaggedHasher<const Token>>;
@@ -90,12 +136,15 @@ public:
     const player_tokens& GetPlayerTokens() const noexcept;
     void RestoreTokenAndPlayer(const Token token, PlayerPtr player); // для записи всех игроков при восстановлении игры
     void RemovePlayerTokenByDogId(Dog::Id dog_id); // для удаления токена и игрока при завершении игры
+    uint64_t GetVersion() const noexcept; // меняется при каждом добавлении и удалении токена
 
 private:
     std::random_device random_device_;
     std::mt19937_64 generator1_;
     std::mt19937_64 generator2_;
     player_tokens token_to_player_;
+    std::unordered_map<Dog::Id, Token, util::TaggedHasher<Dog::Id>> dog_id_to_token_; // для удаления токена по Dog::Id за O(1)
+    uint64_t version_ = 0;
 
     std::mt19937_64 init_generator();
     const Token GenerateToken();
@@ -114,13 +163,42 @@ public:
     const Game::Maps& GetMaps() const noexcept;
     const Map* FindMap(const Map::Id& id) const noexcept;
     PlayerPtr FindPlayerByToken(const Token& token) const noexcept;
-    const DogPtrs& GetDogs(PlayerPtr player) const noexcept;
-    const LootPtrs& GetLoots(PlayerPtr player) const noexcept;
+    const Dogs& GetDogs(PlayerPtr player) const noexcept;
+    const Loots& GetLoots(PlayerPtr player) const noexcept;
+    const AreaIndex* GetAreaIndex(PlayerPtr player); // nullptr - область видимости отключена
+    const AreaOfInterest& GetAreaOfInterest() const noexcept;
+    const ChangesHistory* GetChangesHistory(PlayerPtr player) const noexcept; // nullptr - журнал изменений отключён
     JoinInfo JoinGame(const std::string& name, const Map::Id& map_id);
+    void SetDogAction(const Player& player, std::string_view direction);
     [[nodiscard]] sig::connection DoOnTick(const TickSignal::slot_type& handler);
     void Tick(milliseconds delta);
     bool HasTickPeriod() const noexcept;
     int GetTickPeriod() const noexcept;
+    uint64_t GetTicksCount() const noexcept; // номер последнего шага Tick, растёт монотонно
+
+    // Журнал изменений собак и предметов каждой сессии за последние ticks шагов Tick (0 - отключён)
+    // для ответов на GameState с параметром since
+    void SetStateHistory(size_t ticks);
+    size_t GetStateHistory() const noexcept;
+
+    // число потоков для параллельного выполнения Tick по сессиям (1 - последовательно)
+    void SetTickThreads(unsigned threads_count);
+    unsigned GetTickThreads() const noexcept;
+
+    // профилирование фаз Tick по скользящему окну из window шагов (0 - отключено)
+    void SetTickProfileWindow(size_t window);
+    const tick_profiler::TickProfiler* GetTickProfiler() const noexcept; // nullptr - профилирование отключено
+
+    // Публикация снимка состояния в конце каждого шага Tick для чтения из потоков ввода-вывода
+    void EnableStateSnapshots();
+    StateSnapshotPtr GetStateSnapshot() const; // можно вызывать из любого потока, nullptr - снимки отключены
+
+    // Детерминированность: одинаковый seed и одинаковая последовательность JoinGame, SetDogAction и Tick
+    // дают одинаковое состояние игры. Вызывать до создания игроков. Токены игроков от seed не зависят -
+    // seed хранится в журнале открыто, и по нему нельзя восстанавливать токены
+    void SetRandomSeed(uint64_t seed);
+    // Запись JoinGame, SetDogAction и Tick в журнал для последующего воспроизведения (nullptr - не записывать)
+    void SetJournal(std::shared_ptr<journal::JournalWriter> journal);
 
     // методы для сохранения состояния игры (применяются в app_serialization.h)
 
@@ -134,7 +212,10 @@ public:
     // методы для взаимодействия с БД
 
     void SetConnectionPool(postgres::ConnectionPoolPtr pool);
+    // Не ждёт очередь записи: ушедший из игры игрок появляется в таблице рекордов, когда RecordsWriter запишет его
+    // в БД (обычно в пределах одного пакета). Вызывается в потоке ввода-вывода и не должен блокироваться на БД дольше запроса
     postgres::PlayersRecords GetRecords(int start, int max_items);
+    const records_writer::RecordsWriter* GetRecordsWriter() const noexcept; // nullptr - БД не подключена
 
 private:
     Game& game_;
@@ -147,12 +228,44 @@ private:
     TickSignal tick_signal_;
 
     postgres::ConnectionPoolPtr pool_;
+    std::unique_ptr<records_writer::RecordsWriter> records_writer_; // рекорды пишутся в БД отдельным потоком
+
+    std::unique_ptr<worker_pool::WorkerPool> tick_pool_; // nullptr - Tick выполняется в одном потоке
+    std::vector<size_t> sessions_order_; // порядок обхода сессий: сначала самые нагруженные
+    std::vector<std::vector<Dog::Id>> retired_dogs_; // ушедшие на шаге собаки по сессиям - память переиспользуется
+
+    std::unique_ptr<tick_profiler::TickProfiler> tick_profiler_; // nullptr - профилирование отключено
+
+    std::shared_ptr<journal::JournalWriter> journal_; // nullptr - команды не записываются
+
+    size_t state_history_ticks_ = DEFAULT_STATE_HISTORY_TICKS;
+
+    bool snapshots_enabled_ = false;
+    uint64_t ticks_count_ = 0;
+    StateSnapshotPtr snapshot_; // читается и заменяется только через std::atomic_load/atomic_store
+    // второй буфер каждой сессии: память снимка, отпущенного всеми читателями, используется повторно
+    std::vector<std::shared_ptr<SessionSnapshot>> snapshot_front_;
+    std::vector<std::shared_ptr<SessionSnapshot>> snapshot_back_;
+    std::vector<SessionSnapshotPtr> snapshot_sessions_; // StateSnapshot::sessions следующего снимка
+    std::vector<size_t> snapshot_active_; // активные сессии прошлого снимка - для освобождения буферов усыплённых
+    bool snapshot_layout_stale_ = false; // сессии удалялись - индексы буферов сдвинулись
+    std::shared_ptr<const StateSnapshot::TokenToSession> snapshot_tokens_;
+    uint64_t snapshot_tokens_version_ = 0;
+
+    using SessionTask = std::function<void(GameSession& session, size_t session_index)>;
+
+    // Выполняет task для каждой сессии, при наличии пула - параллельно. Сессии не делят
+    // между собой собак и предметы, поэтому результат не зависит от порядка выполнения
+    void ForEachSession(const SessionTask& task);
 
-    void MoveDogs(int time_delta);
-    void UpdateLoots(int time_delta);
-    void HandleCollisions();
+    void MoveDogs(GameSession& session, int time_delta);
+    void UpdateLoots(GameSession& session, int time_delta);
+    void HandleCollisions(GameSession& session);
     void LeaveGame(Dog::Id dog_id);
     void UpdateDogsTimesAndRemove(int time_delta);
+    GameSessionPtr SelectSession(const Map::Id& map_id);
+    void ReleaseSessions();
+    void PublishStateSnapshot(tick_profiler::TickProfiler* profiler); // profiler - вне шага Tick nullptr
 };
 
 } // namespace app
\ No newline at end of file
@@ -6,6 +6,12 @@ namespace serialization {
 // методы класса PlayerRepr
 
     [[nodiscard]] Player PlayerRepr::Restore(Game& game) const {
+        // у карты может быть несколько экземпляров сессии - игрок попадает в тот, где его собака
+        for (const GameSessionPtr& session : game.GetMapSessions(map_id_)) {
+            if (session->GetDog(id_)) {
+                return Player(id_, session);
+            }
+        }
         Player player = Player(id_, game.GetSession(map_id_));
         return player;
     }
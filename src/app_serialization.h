@@ -21,7 +21,7 @@ public:
 
     explicit PlayerRepr(const Player& player)
         : id_(player.GetDogId()) // Id id_
-        , map_id_(player.GetSession()->GetMap()->GetId()) { // сохраняем map_id, чтобы при десериализации из game получить сессию для игрока по map_id
+        , map_id_(player.GetSession()->GetMap()->GetId()) { // сохраняем map_id, чтобы при десериализации из game найти сессию игрока среди экземпляров карты
     }
 
     [[nodiscard]] Player Restore(Game& game) const;
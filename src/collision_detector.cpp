@@ -1,8 +1,20 @@
 #include "collision_detector.h"
 
+#include "spatial_index.h" // для отбора предметов рядом с путём собирателя
+
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define COLLISION_DETECTOR_X86
+#endif
+
 
 namespace collision_detector {
 
+constexpr double BROADPHASE_TOLERANCE = 1e-6; // относительный запас области поиска предметов
+constexpr double KERNEL_TOLERANCE = 1e-9; // относительный запас FindGatherCandidates - на различие округлений с TryCollectPoint
+
 CollectionResult TryCollectPoint(geom::Point2D a, geom::Point2D b, geom::Point2D c) {
     const double u_x = c.x - a.x;
     const double u_y = c.y - a.y;
@@ -17,42 +29,243 @@ CollectionResult TryCollectPoint(geom::Point2D a, geom::Point2D b, geom::Point2D
     return CollectionResult(sq_distance, proj_ratio);
 }
 
-std::vector<GatheringEvent> FindGatherEvents(
-    const ItemGathererProvider& provider) {
-    std::vector<GatheringEvent> detected_events;
+namespace {
 
-    static auto eq_pt = [](geom::Point2D p1, geom::Point2D p2) {
-        return p1.x == p2.x && p1.y == p2.y;
-    };
+// Путь собирателя для проверки пакета предметов
+struct Path {
+    double a_x;
+    double a_y;
+    double v_x;
+    double v_y;
+    double v_len2;
+    double width;
 
-    for (size_t g = 0; g < provider.GatherersCount(); ++g) {
-        Gatherer gatherer = provider.GetGatherer(g);
-        if (eq_pt(gatherer.start_pos, gatherer.end_pos)) {
-            continue;
-        }
-        for (size_t i = 0; i < provider.ItemsCount(); ++i) {
-            Item item = provider.GetItem(i);
-            auto collect_result
-                = TryCollectPoint(gatherer.start_pos, gatherer.end_pos, item.position);
-
-            if (collect_result.IsCollected(gatherer.width + item.width)) {
-                GatheringEvent evt{.item_id = i,
-                                   .gatherer_id = g,
-                                   .sq_distance = collect_result.sq_distance,
-                                   .time = collect_result.proj_ratio};
-                detected_events.push_back(evt);
-            }
+    explicit Path(const Gatherer& gatherer) noexcept
+        : a_x{gatherer.start_pos.x}
+        , a_y{gatherer.start_pos.y}
+        , v_x{gatherer.end_pos.x - gatherer.start_pos.x}
+        , v_y{gatherer.end_pos.y - gatherer.start_pos.y}
+        , v_len2{v_x * v_x + v_y * v_y}
+        , width{gatherer.width} {
+    }
+};
+
+// те же вычисления, что в TryCollectPoint и CollectionResult::IsCollected, с запасом KERNEL_TOLERANCE
+inline bool IsCandidate(const Path& path, double x, double y, double width) noexcept {
+    const double u_x = x - path.a_x;
+    const double u_y = y - path.a_y;
+    const double u_dot_v = u_x * path.v_x + u_y * path.v_y;
+    const double u_len2 = u_x * u_x + u_y * u_y;
+    const double proj_ratio = u_dot_v / path.v_len2;
+    const double sq_distance = u_len2 - (u_dot_v * u_dot_v) / path.v_len2;
+    const double radius = path.width + width;
+    const double sq_radius = radius * radius;
+    return proj_ratio >= -KERNEL_TOLERANCE && proj_ratio <= 1.0 + KERNEL_TOLERANCE
+        && sq_distance <= sq_radius + KERNEL_TOLERANCE * (u_len2 + sq_radius);
+}
+
+void FindCandidatesScalar(const Path& path, const double* x, const double* y, const double* width,
+                          size_t from, size_t count, uint64_t* mask) noexcept {
+    for (size_t i = from; i < count; ++i) {
+        if (IsCandidate(path, x[i], y[i], width[i])) {
+            mask[i / 64] |= uint64_t{1} << (i % 64);
         }
     }
+}
+
+#ifdef COLLISION_DETECTOR_X86
+
+// Без FMA: умножение и сложение округляются по отдельности, как в скалярном коде
+__attribute__((target("avx2")))
+void FindCandidatesAvx2(const Path& path, const double* x, const double* y, const double* width,
+                        size_t count, uint64_t* mask) noexcept {
+    const __m256d a_x = _mm256_set1_pd(path.a_x);
+    const __m256d a_y = _mm256_set1_pd(path.a_y);
+    const __m256d v_x = _mm256_set1_pd(path.v_x);
+    const __m256d v_y = _mm256_set1_pd(path.v_y);
+    const __m256d v_len2 = _mm256_set1_pd(path.v_len2);
+    const __m256d path_width = _mm256_set1_pd(path.width);
+    const __m256d tolerance = _mm256_set1_pd(KERNEL_TOLERANCE);
+    const __m256d min_ratio = _mm256_set1_pd(-KERNEL_TOLERANCE);
+    const __m256d max_ratio = _mm256_set1_pd(1.0 + KERNEL_TOLERANCE);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) { // 4 предмета не пересекают границу слова mask
+        const __m256d u_x = _mm256_sub_pd(_mm256_loadu_pd(x + i), a_x);
+        const __m256d u_y = _mm256_sub_pd(_mm256_loadu_pd(y + i), a_y);
+        const __m256d u_dot_v = _mm256_add_pd(_mm256_mul_pd(u_x, v_x), _mm256_mul_pd(u_y, v_y));
+        const __m256d u_len2 = _mm256_add_pd(_mm256_mul_pd(u_x, u_x), _mm256_mul_pd(u_y, u_y));
+        const __m256d proj_ratio = _mm256_div_pd(u_dot_v, v_len2);
+        const __m256d sq_distance = _mm256_sub_pd(u_len2, _mm256_div_pd(_mm256_mul_pd(u_dot_v, u_dot_v), v_len2));
+        const __m256d radius = _mm256_add_pd(path_width, _mm256_loadu_pd(width + i));
+        const __m256d sq_radius = _mm256_mul_pd(radius, radius);
+        const __m256d max_sq_distance = _mm256_add_pd(sq_radius, _mm256_mul_pd(tolerance, _mm256_add_pd(u_len2, sq_radius)));
+
+        const __m256d is_candidate = _mm256_and_pd(
+            _mm256_and_pd(_mm256_cmp_pd(proj_ratio, min_ratio, _CMP_GE_OQ), _mm256_cmp_pd(proj_ratio, max_ratio, _CMP_LE_OQ)),
+            _mm256_cmp_pd(sq_distance, max_sq_distance, _CMP_LE_OQ));
+        mask[i / 64] |= static_cast<uint64_t>(_mm256_movemask_pd(is_candidate)) << (i % 64);
+    }
+    FindCandidatesScalar(path, x, y, width, i, count, mask);
+}
+
+void FindCandidatesSse2(const Path& path, const double* x, const double* y, const double* width,
+                        size_t count, uint64_t* mask) noexcept {
+    const __m128d a_x = _mm_set1_pd(path.a_x);
+    const __m128d a_y = _mm_set1_pd(path.a_y);
+    const __m128d v_x = _mm_set1_pd(path.v_x);
+    const __m128d v_y = _mm_set1_pd(path.v_y);
+    const __m128d v_len2 = _mm_set1_pd(path.v_len2);
+    const __m128d path_width = _mm_set1_pd(path.width);
+    const __m128d tolerance = _mm_set1_pd(KERNEL_TOLERANCE);
+    const __m128d min_ratio = _mm_set1_pd(-KERNEL_TOLERANCE);
+    const __m128d max_ratio = _mm_set1_pd(1.0 + KERNEL_TOLERANCE);
+
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        const __m128d u_x = _mm_sub_pd(_mm_loadu_pd(x + i), a_x);
+        const __m128d u_y = _mm_sub_pd(_mm_loadu_pd(y + i), a_y);
+        const __m128d u_dot_v = _mm_add_pd(_mm_mul_pd(u_x, v_x), _mm_mul_pd(u_y, v_y));
+        const __m128d u_len2 = _mm_add_pd(_mm_mul_pd(u_x, u_x), _mm_mul_pd(u_y, u_y));
+        const __m128d proj_ratio = _mm_div_pd(u_dot_v, v_len2);
+        const __m128d sq_distance = _mm_sub_pd(u_len2, _mm_div_pd(_mm_mul_pd(u_dot_v, u_dot_v), v_len2));
+        const __m128d radius = _mm_add_pd(path_width, _mm_loadu_pd(width + i));
+        const __m128d sq_radius = _mm_mul_pd(radius, radius);
+        const __m128d max_sq_distance = _mm_add_pd(sq_radius, _mm_mul_pd(tolerance, _mm_add_pd(u_len2, sq_radius)));
+
+        const __m128d is_candidate = _mm_and_pd(
+            _mm_and_pd(_mm_cmpge_pd(proj_ratio, min_ratio), _mm_cmple_pd(proj_ratio, max_ratio)),
+            _mm_cmple_pd(sq_distance, max_sq_distance));
+        mask[i / 64] |= static_cast<uint64_t>(_mm_movemask_pd(is_candidate)) << (i % 64);
+    }
+    FindCandidatesScalar(path, x, y, width, i, count, mask);
+}
+
+#endif // COLLISION_DETECTOR_X86
+
+GatherKernel DetectGatherKernel() noexcept {
+#ifdef COLLISION_DETECTOR_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return GatherKernel::AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return GatherKernel::SSE2;
+    }
+#endif
+    return GatherKernel::SCALAR;
+}
+
+} // namespace
+
+GatherKernel GetGatherKernel() noexcept {
+    static const GatherKernel kernel = DetectGatherKernel();
+    return kernel;
+}
+
+bool IsGatherKernelSupported(GatherKernel kernel) noexcept {
+    return static_cast<int>(kernel) <= static_cast<int>(GetGatherKernel()); // наборы упорядочены по вложенности
+}
+
+void FindGatherCandidates(GatherKernel kernel, const Gatherer& gatherer, const PackedItems& items,
+                          size_t first, size_t count, uint64_t* mask) {
+    std::fill(mask, mask + (count + 63) / 64, uint64_t{0});
+    const Path path(gatherer);
+    const double* x = items.x.data() + first;
+    const double* y = items.y.data() + first;
+    const double* width = items.width.data() + first;
+    switch (kernel) {
+#ifdef COLLISION_DETECTOR_X86
+        case GatherKernel::AVX2:
+            FindCandidatesAvx2(path, x, y, width, count, mask);
+            return;
+        case GatherKernel::SSE2:
+            FindCandidatesSse2(path, x, y, width, count, mask);
+            return;
+#endif
+        default:
+            FindCandidatesScalar(path, x, y, width, 0, count, mask);
+    }
+}
+
+GatherBounds GetGatherBounds(const Gatherer& gatherer, double max_item_width) noexcept {
+    // собранный предмет не дальше reach от пути, запас - на погрешность sq_distance в TryCollectPoint
+    const double reach = gatherer.width + max_item_width;
+    const double path = std::abs(gatherer.end_pos.x - gatherer.start_pos.x) + std::abs(gatherer.end_pos.y - gatherer.start_pos.y);
+    const double margin = reach + BROADPHASE_TOLERANCE * (1.0 + path + reach);
+    return GatherBounds{
+        {std::min(gatherer.start_pos.x, gatherer.end_pos.x) - margin, std::min(gatherer.start_pos.y, gatherer.end_pos.y) - margin},
+        {std::max(gatherer.start_pos.x, gatherer.end_pos.x) + margin, std::max(gatherer.start_pos.y, gatherer.end_pos.y) + margin}
+    };
+}
+
+std::vector<GatheringEvent> FindGatherEvents(
+    std::span<const Item> items, std::span<const Gatherer> gatherers) {
+    if (items.empty() || gatherers.empty()) {
+        return {};
+    }
 
-    std::sort(detected_events.begin(), detected_events.end(),
-              [](const GatheringEvent& e_l, const GatheringEvent& e_r) {
-                  return e_l.time < e_r.time;
-              });
+    double max_item_width = 0.0;
+    for (const Item& item : items) {
+        max_item_width = std::max(max_item_width, item.width);
+    }
+    double max_gatherer_width = 0.0;
+    double total_path = 0.0;
+    for (const Gatherer& gatherer : gatherers) {
+        max_gatherer_width = std::max(max_gatherer_width, gatherer.width);
+        total_path += std::abs(gatherer.end_pos.x - gatherer.start_pos.x) + std::abs(gatherer.end_pos.y - gatherer.start_pos.y);
+    }
 
-    return detected_events;
+    // ячейка - порядка области сбора вокруг типичного пути за шаг
+    const double cell_size = 2.0 * (max_gatherer_width + max_item_width) + total_path / gatherers.size();
+    spatial_index::SpatialGrid grid;
+    grid.Build(items.size(), cell_size, [&items](size_t i) {
+        return items[i].position;
+    });
+
+    return FindGatherEvents(gatherers,
+        [&grid, max_item_width](const Gatherer& gatherer, std::vector<uint32_t>& out) {
+            const GatherBounds bounds = GetGatherBounds(gatherer, max_item_width);
+            grid.QueryRect(bounds.min_corner, bounds.max_corner, out);
+        },
+        [&items](uint32_t i) {
+            return items[i];
+        });
+}
+
+std::vector<GatheringEvent> FindGatherEvents(
+    const ItemGathererProvider& provider) {
+    std::vector<Item> items;
+    items.reserve(provider.ItemsCount());
+    for (size_t i = 0; i < provider.ItemsCount(); ++i) {
+        items.push_back(provider.GetItem(i));
+    }
+    std::vector<Gatherer> gatherers;
+    gatherers.reserve(provider.GatherersCount());
+    for (size_t g = 0; g < provider.GatherersCount(); ++g) {
+        gatherers.push_back(provider.GetGatherer(g));
+    }
+    return FindGatherEvents(items, gatherers);
 }
 
+// методы класса PackedItems
+
+    void PackedItems::Clear() noexcept {
+        x.clear();
+        y.clear();
+        width.clear();
+    }
+
+    void PackedItems::Add(const Item& item) {
+        x.push_back(item.position.x);
+        y.push_back(item.position.y);
+        width.push_back(item.width);
+    }
+
+    size_t PackedItems::Size() const noexcept {
+        return x.size();
+    }
+
 // методы класса ModelItemGathererProvider
 
     size_t ModelItemGathererProvider::ItemsCount() const {
@@ -60,7 +273,7 @@ std::vector<GatheringEvent> FindGatherEvents(
     }
 
     collision_detector::Item ModelItemGathererProvider::GetItem(size_t idx) const {
-        return items_.at(idx);
+        return items_[idx];
     }
 
     size_t ModelItemGathererProvider::GatherersCount() const {
@@ -68,7 +281,7 @@ std::vector<GatheringEvent> FindGatherEvents(
     }
 
     collision_detector::Gatherer ModelItemGathererProvider::GetGatherer(size_t idx) const {
-        return gatherers_.at(idx);
+        return gatherers_[idx];
     }
 
 }  // namespace collision_detector
\ No newline at end of file
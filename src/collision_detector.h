@@ -3,6 +3,9 @@
 #include "geom.h"
 
 #include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <span>
 #include <vector>
 
 namespace collision_detector {
@@ -43,6 +46,46 @@ public:
     virtual Gatherer GetGatherer(size_t idx) const = 0;
 };
 
+// Предметы в виде структуры массивов - для проверки сбора пакетами векторными командами
+struct PackedItems {
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> width;
+
+    void Clear() noexcept;
+    void Add(const Item& item);
+    size_t Size() const noexcept;
+};
+
+// Набор команд для FindGatherCandidates: по 4 предмета за команду в AVX2, по 2 в SSE2
+enum class GatherKernel {
+    SCALAR,
+    SSE2,
+    AVX2
+};
+
+GatherKernel GetGatherKernel() noexcept; // лучший набор, поддерживаемый процессором, - определяется один раз
+bool IsGatherKernelSupported(GatherKernel kernel) noexcept;
+
+// Отмечает в mask (предмет first + i - бит i % 64 слова i / 64) предметы [first, first + count), которые собиратель
+// может собрать. Проверка с небольшим запасом - окончательный ответ даёт TryCollectPoint для отмеченных.
+// В mask должно быть (count + 63) / 64 слов
+void FindGatherCandidates(GatherKernel kernel, const Gatherer& gatherer, const PackedItems& items,
+                          size_t first, size_t count, uint64_t* mask);
+
+// С какого числа предметов-кандидатов собирателя их упаковка для FindGatherCandidates окупается
+// (замер - сценарий gather в bench: при меньшем числе дешевле проверка по одному)
+constexpr size_t GATHER_KERNEL_MIN_CANDIDATES = 384;
+
+// Прямоугольник вокруг пути собирателя: предмет шириной не больше max_item_width вне него не собрать
+// (с запасом на погрешность TryCollectPoint)
+struct GatherBounds {
+    geom::Point2D min_corner;
+    geom::Point2D max_corner;
+};
+
+GatherBounds GetGatherBounds(const Gatherer& gatherer, double max_item_width) noexcept;
+
 struct GatheringEvent {
     size_t item_id;
     size_t gatherer_id;
@@ -52,9 +95,9 @@ struct GatheringEvent {
 
 class ModelItemGathererProvider : public collision_detector::ItemGathererProvider {
 public:
-    ModelItemGathererProvider(const std::vector<collision_detector::Item>& items,
-                             const std::vector<collision_detector::Gatherer>& gatherers)
-        : items_(items), gatherers_(gatherers) {}
+    ModelItemGathererProvider(std::vector<collision_detector::Item> items,
+                             std::vector<collision_detector::Gatherer> gatherers)
+        : items_(std::move(items)), gatherers_(std::move(gatherers)) {}
 
     size_t ItemsCount() const override;
     collision_detector::Item GetItem(size_t idx) const override;
@@ -66,6 +109,76 @@ private:
     std::vector<collision_detector::Gatherer> gatherers_;
 };
 
+// События сбора по времени. Предметы раскладываются по равномерной сетке, и каждый собиратель проверяется
+// только с предметами в прямоугольнике вокруг своего пути - при движении вдоль осей это узкая полоса.
+// Порядок событий тот же, что при проверке всех пар: до сортировки по времени - по собирателю, затем по предмету
+std::vector<GatheringEvent> FindGatherEvents(std::span<const Item> items, std::span<const Gatherer> gatherers);
+
+// То же через интерфейс: предметы и собиратели запрашиваются по одному разу и копируются
 std::vector<GatheringEvent> FindGatherEvents(const ItemGathererProvider& provider);
 
+// То же по предметам, отобранным для каждого собирателя его хранилищем: find_candidates(gatherer, out) добавляет
+// в out без повторов индексы предметов, которые gatherer может собрать (лишние допустимы), get_item(i) - предмет.
+// Общая сетка не строится - время пропорционально собирателям в движении и предметам рядом с их путями.
+// Собиратель с GATHER_KERNEL_MIN_CANDIDATES кандидатами и больше проверяется пакетом через FindGatherCandidates
+template <typename CandidatesFinder, typename ItemGetter>
+std::vector<GatheringEvent> FindGatherEvents(std::span<const Gatherer> gatherers,
+                                             CandidatesFinder find_candidates, ItemGetter get_item);
+
+template <typename CandidatesFinder, typename ItemGetter>
+std::vector<GatheringEvent> FindGatherEvents(std::span<const Gatherer> gatherers,
+                                             CandidatesFinder find_candidates, ItemGetter get_item) {
+    std::vector<GatheringEvent> detected_events;
+    std::vector<uint32_t> candidates;
+    PackedItems packed;
+    std::vector<uint64_t> mask;
+    const GatherKernel kernel = GetGatherKernel();
+    for (size_t g = 0; g < gatherers.size(); ++g) {
+        const Gatherer& gatherer = gatherers[g];
+        if (gatherer.start_pos.x == gatherer.end_pos.x && gatherer.start_pos.y == gatherer.end_pos.y) {
+            continue;
+        }
+        candidates.clear();
+        find_candidates(gatherer, candidates);
+        std::sort(candidates.begin(), candidates.end()); // порядок проверки всех пар
+
+        const auto try_collect = [&](uint32_t i, const Item& item) {
+            const CollectionResult collect_result = TryCollectPoint(gatherer.start_pos, gatherer.end_pos, item.position);
+            if (collect_result.IsCollected(gatherer.width + item.width)) {
+                detected_events.push_back({.item_id = i,
+                                           .gatherer_id = g,
+                                           .sq_distance = collect_result.sq_distance,
+                                           .time = collect_result.proj_ratio});
+            }
+        };
+
+        if (candidates.size() < GATHER_KERNEL_MIN_CANDIDATES) {
+            for (const uint32_t i : candidates) {
+                try_collect(i, get_item(i));
+            }
+            continue;
+        }
+
+        // биты маски идут по возрастанию индексов кандидатов - порядок событий не меняется
+        packed.Clear();
+        for (const uint32_t i : candidates) {
+            packed.Add(get_item(i));
+        }
+        mask.resize((candidates.size() + 63) / 64);
+        FindGatherCandidates(kernel, gatherer, packed, 0, candidates.size(), mask.data());
+        for (size_t word = 0; word < mask.size(); ++word) {
+            for (uint64_t bits = mask[word]; bits != 0; bits &= bits - 1) {
+                const size_t k = word * 64 + std::countr_zero(bits);
+                try_collect(candidates[k], Item{{packed.x[k], packed.y[k]}, packed.width[k]});
+            }
+        }
+    }
+
+    std::sort(detected_events.begin(), detected_events.end(),
+              [](const GatheringEvent& e_l, const GatheringEvent& e_r) {
+                  return e_l.time < e_r.time;
+              });
+    return detected_events;
+}
+
 }  // namespace collision_detector
\ No newline at end of file
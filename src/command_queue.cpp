@@ -0,0 +1,87 @@
+#include "command_queue.h"
+
+#include <utility>
+
+
+namespace command_queue {
+
+// методы класса CommandQueue
+
+    CommandQueue::CommandQueue()
+        : head_{&stub_}
+        , tail_{&stub_} {
+    }
+
+    CommandQueue::~CommandQueue() {
+        while (Node* node = PopNode()) {
+            delete node;
+        }
+    }
+
+    bool CommandQueue::Push(Command command) {
+        Node* node = new Node;
+        node->command = std::move(command);
+        const bool was_empty = size_.fetch_add(1, std::memory_order_acq_rel) == 0;
+        PushNode(node);
+        return was_empty;
+    }
+
+    size_t CommandQueue::Drain() {
+        const size_t limit = size_.load(std::memory_order_acquire);
+        size_t executed = 0;
+        while (executed < limit) {
+            Node* node = PopNode();
+            if (!node) { // производитель увеличил размер, но ещё не связал узел - заберём на следующем Drain
+                break;
+            }
+            node->command();
+            delete node;
+            ++executed;
+        }
+        size_.fetch_sub(executed, std::memory_order_acq_rel);
+        return executed;
+    }
+
+    size_t CommandQueue::GetSize() const noexcept {
+        return size_.load(std::memory_order_relaxed);
+    }
+
+    void CommandQueue::PushNode(Node* node) noexcept {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release); // до этой строки узел недоступен потребителю
+    }
+
+    CommandQueue::Node* CommandQueue::PopNode() noexcept {
+        Node* tail = tail_;
+        Node* next = tail->next.load(std::memory_order_acquire);
+
+        if (tail == &stub_) { // пропускаем пустой узел
+            if (!next) {
+                return nullptr;
+            }
+            tail_ = next;
+            tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+
+        if (next) {
+            tail_ = next;
+            return tail;
+        }
+
+        if (tail != head_.load(std::memory_order_acquire)) { // производитель между exchange и связыванием узла
+            return nullptr;
+        }
+
+        // tail - последний узел: возвращаем в очередь пустой узел, чтобы извлечь tail
+        PushNode(&stub_);
+        next = tail->next.load(std::memory_order_acquire);
+        if (next) {
+            tail_ = next;
+            return tail;
+        }
+        return nullptr;
+    }
+
+} // namespace command_queue
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+
+
+namespace command_queue {
+
+// Очередь команд "много производителей - один потребитель" без блокировок (интрузивная очередь Вьюкова).
+// Push можно вызывать из любых потоков, Drain и деструктор - только из потока-потребителя
+class CommandQueue {
+public:
+    using Command = std::function<void()>; // команда не должна выбрасывать исключений
+
+    CommandQueue();
+    ~CommandQueue();
+
+    CommandQueue(const CommandQueue&) = delete;
+    CommandQueue& operator=(const CommandQueue&) = delete;
+
+    // true - до добавления очередь была пуста и потребителя нужно разбудить
+    bool Push(Command command);
+
+    // Выполняет команды в порядке поступления, но не больше, чем было в очереди на момент вызова,
+    // чтобы поток команд не откладывал шаг Tick. Возвращает число выполненных команд
+    size_t Drain();
+
+    size_t GetSize() const noexcept; // приблизительно - производители могут добавлять команды в это время
+
+private:
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        Command command;
+    };
+
+    std::atomic<Node*> head_; // последний добавленный узел - сторона производителей
+    Node* tail_; // следующий извлекаемый узел - сторона потребителя
+    Node stub_; // пустой узел, чтобы очередь никогда не становилась пустой структурно
+    std::atomic<size_t> size_{0};
+
+    void PushNode(Node* node) noexcept;
+    Node* PopNode() noexcept; // nullptr - очередь пуста или производитель ещё не связал свой узел
+};
+
+} // namespace command_queue
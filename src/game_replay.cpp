@@ -0,0 +1,95 @@
+#include "app.h"
+#include "journal.h"
+#include "json_loader.h"
+#include "replay.h"
+
+#include <boost/program_options.hpp>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+
+
+using namespace std::literals;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Args {
+    fs::path config_file;
+    fs::path journal_file;
+    unsigned tick_threads = 1;
+};
+
+[[nodiscard]] std::optional<Args> ParseCommandLine(int argc, const char* const argv[]) {
+    namespace po = boost::program_options;
+
+    po::options_description desc{"Allowed options"s};
+
+    Args args;
+    desc.add_options()
+        ("help,h", "produce help message")
+        ("config-file,c", po::value(&args.config_file)->value_name("file"s), "set config file path (the one used for recording)")
+        ("journal,j", po::value(&args.journal_file)->value_name("file"s), "set path to recorded journal")
+        ("tick-threads", po::value(&args.tick_threads)->value_name("count"s), "set number of threads for parallel tick by game sessions");
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (vm.contains("help"s)) {
+        std::cout << desc;
+        return std::nullopt;
+    }
+
+    if (!vm.contains("config-file"s)) {
+        throw std::runtime_error(std::string(ErrorMessage::UNKNOWN_SERVER_CONFIG));
+    }
+    if (!vm.contains("journal"s)) {
+        throw std::runtime_error("Journal file path is not specified"s);
+    }
+
+    return args;
+}
+
+}  // namespace
+
+// Воспроизведение журнала, записанного сервером с ключом --record-journal, с максимальной скоростью
+int main(int argc, const char* argv[]) {
+    try {
+        auto args = ParseCommandLine(argc, argv);
+        if (args == std::nullopt) { // ключ -h
+            return EXIT_SUCCESS;
+        }
+
+        std::ifstream in(args->journal_file, std::ios::binary);
+        if (!in) {
+            throw std::runtime_error("Failed to open journal "s + args->journal_file.string());
+        }
+        journal::JournalReader reader(in);
+
+        model::Game game = json_loader::LoadGame(args->config_file);
+        app::Application app{game, 0, reader.GetHeader().randomize_spawn_points};
+        app.SetTickThreads(args->tick_threads);
+
+        const replay::ReplayStats stats = replay::ReplayJournal(reader, app);
+
+        const double recorded_s = std::chrono::duration<double>(stats.recorded_time).count();
+        const double elapsed_s = std::chrono::duration<double>(stats.elapsed).count();
+        std::cout << std::fixed << std::setprecision(3)
+                  << "joins:            " << stats.joins << std::endl
+                  << "actions:          " << stats.actions << std::endl
+                  << "skipped actions:  " << stats.skipped_actions << std::endl
+                  << "ticks:            " << stats.ticks << std::endl
+                  << "recorded, s:      " << recorded_s << std::endl
+                  << "replayed, s:      " << elapsed_s << std::endl
+                  << "speedup:          " << (elapsed_s > 0.0 ? recorded_s / elapsed_s : 0.0) << std::endl
+                  << "ticks per second: " << stats.GetTicksPerSecond() << std::endl
+                  << "state checksum:   " << std::hex << std::setw(16) << std::setfill('0') << stats.state_checksum << std::endl;
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
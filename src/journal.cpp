@@ -0,0 +1,176 @@
+#include "journal.h"
+
+#include <stdexcept>
+
+
+namespace journal {
+
+using namespace std::literals;
+
+namespace {
+
+enum class RecordType : uint8_t {
+    JOIN = 1,
+    ACTION = 2,
+    TICK = 3
+};
+
+constexpr uint8_t RANDOMIZE_SPAWN_POINTS_FLAG = 1;
+constexpr size_t MAX_STRING_SIZE = 1 << 16; // защита от выделения памяти по повреждённой длине
+
+} // namespace
+
+// методы класса JournalWriter
+
+    JournalWriter::JournalWriter(std::ostream& out, const Header& header)
+        : out_{out}
+        , start_{Clock::now()} {
+        out_.write(MAGIC.data(), MAGIC.size());
+        out_.put(static_cast<char>(VERSION));
+        for (int i = 0; i < 8; ++i) { // seed - 8 байт от младшего к старшему
+            out_.put(static_cast<char>((header.random_seed >> (8 * i)) & 0xFF));
+        }
+        out_.put(static_cast<char>(header.randomize_spawn_points ? RANDOMIZE_SPAWN_POINTS_FLAG : 0));
+    }
+
+    void JournalWriter::WriteJoin(std::string_view name, std::string_view map_id) {
+        WriteRecordHeader(static_cast<uint8_t>(RecordType::JOIN));
+        WriteString(name);
+        WriteString(map_id);
+    }
+
+    void JournalWriter::WriteAction(uint32_t dog_id, std::string_view direction) {
+        WriteRecordHeader(static_cast<uint8_t>(RecordType::ACTION));
+        WriteVarint(dog_id);
+        out_.put(direction.empty() ? '\0' : direction.front());
+    }
+
+    void JournalWriter::WriteTick(uint32_t delta_ms) {
+        WriteRecordHeader(static_cast<uint8_t>(RecordType::TICK));
+        WriteVarint(delta_ms);
+    }
+
+    void JournalWriter::Flush() {
+        out_.flush();
+    }
+
+    uint64_t JournalWriter::GetRecordsCount() const noexcept {
+        return records_count_;
+    }
+
+    bool JournalWriter::IsGood() const noexcept {
+        return out_.good();
+    }
+
+    void JournalWriter::WriteRecordHeader(uint8_t type) {
+        const auto now_us = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start_).count());
+        out_.put(static_cast<char>(type));
+        WriteVarint(now_us - last_time_us_);
+        last_time_us_ = now_us;
+        ++records_count_;
+    }
+
+    void JournalWriter::WriteVarint(uint64_t value) {
+        while (value >= 0x80) {
+            out_.put(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        out_.put(static_cast<char>(value));
+    }
+
+    void JournalWriter::WriteString(std::string_view str) {
+        WriteVarint(str.size());
+        out_.write(str.data(), static_cast<std::streamsize>(str.size()));
+    }
+
+// методы класса JournalReader
+
+    JournalReader::JournalReader(std::istream& in)
+        : in_{in} {
+        std::string magic(MAGIC.size(), '\0');
+        if (!in_.read(magic.data(), static_cast<std::streamsize>(magic.size())) || magic != MAGIC) {
+            throw std::runtime_error("Invalid journal signature"s);
+        }
+        if (const uint8_t version = ReadByte(); version != VERSION) {
+            throw std::runtime_error("Unsupported journal version "s + std::to_string(version));
+        }
+        for (int i = 0; i < 8; ++i) {
+            header_.random_seed |= static_cast<uint64_t>(ReadByte()) << (8 * i);
+        }
+        header_.randomize_spawn_points = (ReadByte() & RANDOMIZE_SPAWN_POINTS_FLAG) != 0;
+    }
+
+    const Header& JournalReader::GetHeader() const noexcept {
+        return header_;
+    }
+
+    std::optional<Record> JournalReader::Next() {
+        const int type = in_.get();
+        if (type == std::istream::traits_type::eof()) {
+            return std::nullopt;
+        }
+
+        time_us_ += ReadVarint();
+        Record record;
+        record.time_us = time_us_;
+
+        switch (static_cast<RecordType>(type)) {
+            case RecordType::JOIN: {
+                JoinCommand join;
+                join.name = ReadString();
+                join.map_id = ReadString();
+                record.command = std::move(join);
+                break;
+            }
+            case RecordType::ACTION: {
+                ActionCommand action;
+                action.dog_id = static_cast<uint32_t>(ReadVarint());
+                if (const char direction = static_cast<char>(ReadByte()); direction != '\0') {
+                    action.direction = std::string(1, direction);
+                }
+                record.command = std::move(action);
+                break;
+            }
+            case RecordType::TICK:
+                record.command = TickCommand{static_cast<uint32_t>(ReadVarint())};
+                break;
+            default:
+                throw std::runtime_error("Unknown journal record type "s + std::to_string(type));
+        }
+        return record;
+    }
+
+    uint8_t JournalReader::ReadByte() {
+        const int byte = in_.get();
+        if (byte == std::istream::traits_type::eof()) {
+            throw std::runtime_error("Unexpected end of journal"s);
+        }
+        return static_cast<uint8_t>(byte);
+    }
+
+    uint64_t JournalReader::ReadVarint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            const uint8_t byte = ReadByte();
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return value;
+            }
+        }
+        throw std::runtime_error("Invalid varint in journal"s);
+    }
+
+    std::string JournalReader::ReadString() {
+        const uint64_t size = ReadVarint();
+        if (size > MAX_STRING_SIZE) {
+            throw std::runtime_error("Invalid string size in journal"s);
+        }
+        std::string str(size, '\0');
+        if (!in_.read(str.data(), static_cast<std::streamsize>(size))) {
+            throw std::runtime_error("Unexpected end of journal"s);
+        }
+        return str;
+    }
+
+} // namespace journal
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <variant>
+
+
+namespace journal {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::string_view MAGIC = "GSJ"; // сигнатура файла журнала
+constexpr uint8_t VERSION = 1;
+
+// Параметры, без которых воспроизведение журнала не совпадёт с записью
+struct Header {
+    uint64_t random_seed = 0; // seed Application::SetRandomSeed
+    bool randomize_spawn_points = false;
+};
+
+// Команды, изменяющие состояние игры, в порядке выполнения в потоке симуляции
+
+struct JoinCommand {
+    std::string name;
+    std::string map_id;
+
+    bool operator==(const JoinCommand&) const = default;
+};
+
+struct ActionCommand {
+    uint32_t dog_id = 0;
+    std::string direction; // "U", "D", "L", "R" или "" - остановка
+
+    bool operator==(const ActionCommand&) const = default;
+};
+
+struct TickCommand {
+    uint32_t delta_ms = 0;
+
+    bool operator==(const TickCommand&) const = default;
+};
+
+using Command = std::variant<JoinCommand, ActionCommand, TickCommand>;
+
+struct Record {
+    uint64_t time_us = 0; // от начала записи журнала
+    Command command;
+};
+
+// Запись журнала в компактном двоичном виде: тип команды байтом, целые - varint (LEB128),
+// время - приращение от предыдущей записи. Вызывается из одного потока - потока симуляции
+class JournalWriter {
+public:
+    JournalWriter(std::ostream& out, const Header& header);
+
+    JournalWriter(const JournalWriter&) = delete;
+    JournalWriter& operator=(const JournalWriter&) = delete;
+
+    void WriteJoin(std::string_view name, std::string_view map_id);
+    void WriteAction(uint32_t dog_id, std::string_view direction);
+    void WriteTick(uint32_t delta_ms);
+    void Flush();
+
+    uint64_t GetRecordsCount() const noexcept;
+    bool IsGood() const noexcept; // false - ошибка записи в поток
+
+private:
+    std::ostream& out_;
+    Clock::time_point start_;
+    uint64_t last_time_us_ = 0;
+    uint64_t records_count_ = 0;
+
+    void WriteRecordHeader(uint8_t type);
+    void WriteVarint(uint64_t value);
+    void WriteString(std::string_view str);
+};
+
+// Чтение журнала. При повреждённых или обрезанных данных бросает std::runtime_error
+class JournalReader {
+public:
+    explicit JournalReader(std::istream& in);
+
+    const Header& GetHeader() const noexcept;
+    std::optional<Record> Next(); // std::nullopt - журнал закончился
+
+private:
+    std::istream& in_;
+    Header header_;
+    uint64_t time_us_ = 0;
+
+    uint8_t ReadByte();
+    uint64_t ReadVarint();
+    std::string ReadString();
+};
+
+} // namespace journal
@@ -3,18 +3,20 @@
 namespace json_loader {
 
 void ParseRoads(const json::array& roads_array, model::Map& map) {
+    model::MapBuilder builder(map); // дороги объединяются и индексируются один раз после разбора всех
     for (const auto& road_val : roads_array) {
         auto road_obj = road_val.as_object();
         auto start_x = road_obj.at(KeyX0).as_int64();
         auto start_y = road_obj.at(KeyY0).as_int64();
         if (road_obj.contains(KeyX1)) { // Горизонтальная дорога
             auto end_x = road_obj.at(KeyX1).as_int64();
-            map.AddRoad(model::Road(model::Road::HORIZONTAL, {static_cast<model::Coord>(start_x), static_cast<model::Coord>(start_y)}, static_cast<model::Coord>(end_x)));
+            builder.AddRoad(model::Road(model::Road::HORIZONTAL, {static_cast<model::Coord>(start_x), static_cast<model::Coord>(start_y)}, static_cast<model::Coord>(end_x)));
         } else if (road_obj.contains(KeyY1)) { // Вертикальная дорога
             auto end_y = road_obj.at(KeyY1).as_int64();
-            map.AddRoad(model::Road(model::Road::VERTICAL, {static_cast<model::Coord>(start_x), static_cast<model::Coord>(start_y)}, static_cast<model::Coord>(end_y)));
+            builder.AddRoad(model::Road(model::Road::VERTICAL, {static_cast<model::Coord>(start_x), static_cast<model::Coord>(start_y)}, static_cast<model::Coord>(end_y)));
         }
     }
+    builder.Build();
 }
 
 void ParseBuildings(const json::array& buildings_array, model::Map& map) {
@@ -67,6 +69,27 @@ void ParseLootTypes(const json::array& loots_types_array, model::Map& map) {
     }
 }
 
+model::AreaOfInterest ParseAreaOfInterest(const json::object& area_object) {
+    model::AreaOfInterest area_of_interest;
+    area_of_interest.radius = area_object.at(KeyRadius).as_double();
+    if (area_of_interest.radius < 0.0) {
+        throw std::invalid_argument("Area of interest radius must not be negative"s);
+    }
+
+    // расстояние по дорогам оценивается снизу манхэттенским: дороги параллельны осям
+    if (area_object.find(KeyDistance) != area_object.end()) {
+        const json::string& distance = area_object.at(KeyDistance).as_string();
+        if (distance == DistanceEuclidean) {
+            area_of_interest.metric = spatial_index::Metric::EUCLIDEAN;
+        } else if (distance == DistanceManhattan) {
+            area_of_interest.metric = spatial_index::Metric::MANHATTAN;
+        } else {
+            throw std::invalid_argument("Unknown area of interest distance: "s + std::string(distance));
+        }
+    }
+    return area_of_interest;
+}
+
 model::Game LoadGame(const std::filesystem::path& json_path) {
     // 1. Загрузить содержимое файла json_path в виде строки
     std::ifstream file(json_path);
@@ -98,6 +121,17 @@ model::Game LoadGame(const std::filesystem::path& json_path) {
         game.SetDefaultBagCapacity(default_dog_bag_capacity);
     }
 
+    // ограничение игроков в одном экземпляре карты по умолчанию
+    if (value.as_object().find(KeyDefaultMaxPlayers) != value.as_object().end()) {
+        auto default_max_players = value.as_object().at(KeyDefaultMaxPlayers).as_int64();
+        game.SetDefaultMaxPlayers(default_max_players);
+    }
+
+    // область видимости игрока в состоянии игры
+    if (value.as_object().find(KeyAreaOfInterest) != value.as_object().end()) {
+        game.SetAreaOfInterest(ParseAreaOfInterest(value.as_object().at(KeyAreaOfInterest).as_object()));
+    }
+
     // предельное время игрока в режиме ожидания
     if (value.as_object().find(KeyDogRetirementTime) != value.as_object().end()) {
         auto retirement_time = value.as_object().at(KeyDogRetirementTime).as_double(); 
@@ -131,6 +165,12 @@ model::Game LoadGame(const std::filesystem::path& json_path) {
             map.SetDogBagCapacity(dog_bag_capacity);
         }
 
+        // ограничение игроков в одном экземпляре текущей карты
+        if (map_obj.find(KeyMaxPlayers) != map_obj.end()) {
+            auto max_players = map_obj.at(KeyMaxPlayers).as_int64();
+            map.SetMaxPlayers(max_players);
+        }
+
         // Парсим дороги, здания и офисы, возможные предметы
         if (map_obj.contains(KeyLootTypes)) {
             ParseLootTypes(map_obj.at(KeyLootTypes).as_array(), map);
@@ -176,51 +216,94 @@ json::object GetMapObject(const model::Map *map) {
     return map_obj;
 }
 
-json::object GetGameStateObject(const model::DogPtrs& dogs, const model::LootPtrs& loots) {
+json::object GetGameStateObject(const model::Dogs& dogs, const model::Loots& loots) {
     json::object game_state_object;
     
     // Формируем объект игроков
     json::object players_object;
     for (const auto& dog : dogs) {
-        json::array bag_array; // заполняем параметрами предметов из рюкзака
-        for (const auto& loot : dog->GetBag()) {
-            bag_array.emplace_back(json::object{
-                { KeyId, *loot->id },
-                { KeyType, loot->type }
-            });
-        }
-
-        players_object[std::to_string(*dog->GetId())] = {
-            { KeyPos, { dog->GetPosition().x, dog->GetPosition().y } },
-            { KeySpeed, { dog->GetSpeed().x, dog->GetSpeed().y } },
-            { KeyDir, model::DirectionToString(dog->GetDirection()) },
-            { KeyBag, std::move(bag_array) },
-            { KeyScore, dog->GetScore() }
-        };
+        players_object[std::to_string(*dog.GetId())] = GetDogStateObject(dog);
     }
 
     // Формируем объект предметов
     json::object loots_object;
     for (const auto& loot : loots) {
-        loots_object[std::to_string(*loot->id)] = {
-            { KeyType, loot->type },
-            { KeyPos, { loot->pos.x, loot->pos.y } }
-        };
+        loots_object[std::to_string(*loot.id)] = GetLootStateObject(loot);
+    }
+
+    game_state_object[KeyPlayers] = std::move(players_object);
+    game_state_object[KeyLostObjects] = std::move(loots_object);
+
+    return game_state_object;
+}
+
+json::object GetGameStateObject(const model::Dogs& dogs, const model::Loots& loots,
+                                const std::vector<uint32_t>& dog_indices,
+                                const std::vector<uint32_t>& loot_indices) {
+    json::object game_state_object;
+
+    json::object players_object;
+    players_object.reserve(dog_indices.size());
+    for (uint32_t index : dog_indices) {
+        players_object[std::to_string(*dogs[index].GetId())] = GetDogStateObject(dogs[index]);
+    }
+
+    json::object loots_object;
+    loots_object.reserve(loot_indices.size());
+    for (uint32_t index : loot_indices) {
+        loots_object[std::to_string(*loots[index].id)] = GetLootStateObject(loots[index]);
+    }
+
+    game_state_object[KeyPlayers] = std::move(players_object);
+    game_state_object[KeyLostObjects] = std::move(loots_object);
+
+    return game_state_object;
+}
+
+json::object GetGameStateDeltaObject(const model::StateDelta& delta, uint64_t tick, uint64_t since) {
+    json::object game_state_object;
+    game_state_object[KeyTick] = tick;
+    game_state_object[KeySince] = since;
+
+    json::object players_object;
+    players_object.reserve(delta.dogs.size());
+    for (const model::Dog* dog : delta.dogs) {
+        players_object[std::to_string(*dog->GetId())] = GetDogStateObject(*dog);
+    }
+
+    json::object loots_object;
+    loots_object.reserve(delta.loots.size());
+    for (const model::Loot* loot : delta.loots) {
+        loots_object[std::to_string(*loot->id)] = GetLootStateObject(*loot);
+    }
+
+    json::array removed_players;
+    removed_players.reserve(delta.removed_dogs.size());
+    for (model::Dog::Id id : delta.removed_dogs) {
+        removed_players.emplace_back(std::to_string(*id));
+    }
+
+    json::array removed_loots;
+    removed_loots.reserve(delta.removed_loots.size());
+    for (model::Loot::Id id : delta.removed_loots) {
+        removed_loots.emplace_back(std::to_string(*id));
     }
 
     game_state_object[KeyPlayers] = std::move(players_object);
     game_state_object[KeyLostObjects] = std::move(loots_object);
+    game_state_object[KeyRemovedPlayers] = std::move(removed_players);
+    game_state_object[KeyRemovedLostObjects] = std::move(removed_loots);
 
     return game_state_object;
 }
 
-json::object GetPlayerListObject(const model::DogPtrs& dogs) {
+json::object GetPlayerListObject(const model::Dogs& dogs) {
     json::object dogs_object;
     for (const auto& dog : dogs) {
         json::object jv_name{
-            { KeyName, dog->GetName() }
+            { KeyName, dog.GetName() }
         };
-        dogs_object[std::to_string(*dog->GetId())] = jv_name;
+        dogs_object[std::to_string(*dog.GetId())] = jv_name;
     }
     return dogs_object;
 }
@@ -240,6 +323,79 @@ json::array GetGameRecordsArray(const postgres::PlayersRecords records) {
     return records_array;
 }
 
+json::object GetTickerStatsObject(const ticker::TickerStats& stats) {
+    const auto to_ms = [](ticker::microseconds us) {
+        return static_cast<double>(us.count()) / 1000.0;
+    };
+    const double ticks = static_cast<double>(std::max<uint64_t>(stats.ticks, 1));
+
+    // корзины гистограммы подписываются верхней границей: "<1", "<2", ..., ">=100"
+    json::object histogram_object;
+    for (size_t i = 0; i < ticker::LATENESS_BUCKETS_MS.size(); ++i) {
+        histogram_object["<"s + std::to_string(ticker::LATENESS_BUCKETS_MS[i])] = stats.lateness_histogram[i];
+    }
+    histogram_object[">="s + std::to_string(ticker::LATENESS_BUCKETS_MS.back())] = stats.lateness_histogram.back();
+
+    return json::object{
+        { KeyTicks, stats.ticks },
+        { KeySteps, stats.steps },
+        { KeyOverruns, stats.overruns },
+        { KeyDroppedSteps, stats.dropped_steps },
+        { KeyMeanLatenessMs, to_ms(stats.total_lateness) / ticks },
+        { KeyMaxLatenessMs, to_ms(stats.max_lateness) },
+        { KeyMeanJitterMs, to_ms(stats.total_jitter) / ticks },
+        { KeyMaxJitterMs, to_ms(stats.max_jitter) },
+        { KeyMeanHandlerMs, to_ms(stats.total_handler_time) / ticks },
+        { KeyMaxHandlerMs, to_ms(stats.max_handler_time) },
+        { KeyLatenessHistogram, std::move(histogram_object) }
+    };
+}
+
+json::object GetTickProfileObject(const tick_profiler::TickProfiler& profiler) {
+    json::array sessions_array;
+    for (const auto& session : profiler.GetSessions()) {
+        json::object phases_object;
+        for (size_t phase = 0; phase < tick_profiler::PHASES_COUNT; ++phase) {
+            const std::string phase_name{tick_profiler::PhaseToString(static_cast<tick_profiler::Phase>(phase))};
+            phases_object[phase_name] = GetRollingHistogramObject(session.phases[phase]);
+        }
+        sessions_array.emplace_back(json::object{
+            { KeyMapId, *session.map_id },
+            { KeyPhases, std::move(phases_object) }
+        });
+    }
+
+    return json::object{
+        { KeyWindow, profiler.GetWindow() },
+        { KeyTicks, profiler.GetTicksCount() },
+        { KeyTick, GetRollingHistogramObject(profiler.GetTick()) },
+        { KeyTickSignal, GetRollingHistogramObject(profiler.GetTickSignal()) },
+        { KeySessions, std::move(sessions_array) }
+    };
+}
+
+json::object GetRecordsWriterStatsObject(const records_writer::RecordsWriterStats& stats) {
+    const auto to_ms = [](records_writer::microseconds us) {
+        return static_cast<double>(us.count()) / 1000.0;
+    };
+    const double batches = static_cast<double>(std::max<uint64_t>(stats.batches, 1));
+
+    return json::object{
+        { KeyQueueDepth, stats.queue_depth },
+        { KeyMaxQueueDepth, stats.max_queue_depth },
+        { KeyEnqueued, stats.enqueued },
+        { KeyWritten, stats.written },
+        { KeyDropped, stats.dropped },
+        { KeyBatches, stats.batches },
+        { KeyFailedBatches, stats.failed_batches },
+        { KeyLastFlushLatencyMs, to_ms(stats.last_flush_latency) },
+        { KeyMeanFlushLatencyMs, to_ms(stats.total_flush_latency) / batches },
+        { KeyMaxFlushLatencyMs, to_ms(stats.max_flush_latency) },
+        { KeyMeanWriteMs, to_ms(stats.total_write_time) / batches },
+        { KeyMaxWriteMs, to_ms(stats.max_write_time) }
+    };
+}
+
 json::array GetRoadsArray(const model::Map *map) {
     const auto& roads = map->GetRoads();
     json::array roads_array;
@@ -260,6 +416,31 @@ json::array GetRoadsArray(const model::Map *map) {
     return roads_array;
 }
 
+json::object GetDogStateObject(const model::Dog& dog) {
+    json::array bag_array; // заполняем параметрами предметов из рюкзака
+    for (const auto& loot : dog.GetBag()) {
+        bag_array.emplace_back(json::object{
+            { KeyId, *loot.id },
+            { KeyType, loot.type }
+        });
+    }
+
+    return {
+        { KeyPos, { dog.GetPosition().x, dog.GetPosition().y } },
+        { KeySpeed, { dog.GetSpeed().x, dog.GetSpeed().y } },
+        { KeyDir, model::DirectionToString(dog.GetDirection()) },
+        { KeyBag, std::move(bag_array) },
+        { KeyScore, dog.GetScore() }
+    };
+}
+
+json::object GetLootStateObject(const model::Loot& loot) {
+    return {
+        { KeyType, loot.type },
+        { KeyPos, { loot.pos.x, loot.pos.y } }
+    };
+}
+
 json::array GetBuildingsArray(const model::Map *map) {
     const auto& buildings = map->GetBuildings();
     json::array buildings_array;
@@ -325,6 +506,33 @@ json::array GetLootTypesArray(const model::Map* map) {
     return loot_types_array;
 }
 
+json::object GetRollingHistogramObject(const tick_profiler::RollingHistogram& histogram) {
+    const auto to_ms = [](tick_profiler::microseconds us) {
+        return static_cast<double>(us.count()) / 1000.0;
+    };
+
+    json::array buckets_array; // только непустые корзины
+    const auto& buckets = histogram.GetBuckets();
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        if (buckets[i] != 0) {
+            buckets_array.emplace_back(json::object{
+                { KeyLessThanUs, tick_profiler::RollingHistogram::GetBucketUpperBound(i).count() },
+                { KeyCount, buckets[i] }
+            });
+        }
+    }
+
+    return json::object{
+        { KeyCount, histogram.GetCount() },
+        { KeyMeanMs, to_ms(histogram.GetMean()) },
+        { KeyP50Ms, to_ms(histogram.GetPercentile(50.0)) },
+        { KeyP90Ms, to_ms(histogram.GetPercentile(90.0)) },
+        { KeyP99Ms, to_ms(histogram.GetPercentile(99.0)) },
+        { KeyMaxMs, to_ms(histogram.GetMax()) },
+        { KeyHistogram, std::move(buckets_array) }
+    };
+}
+
 json::value MakeErrorJSON(std::string_view error_code, std::string_view error_message) {
     json::value jv = {
         { JsonField::CODE, error_code },
@@ -3,6 +3,9 @@
 #include "magic_defs.h"
 #include "model.h"
 #include "postgres.h"
+#include "records_writer.h"
+#include "ticker.h"
+#include "tick_profiler.h"
 
 #include <boost/json.hpp>
 #include <filesystem>
@@ -24,6 +27,7 @@ namespace json_loader {
 void ParseRoads(const json::array& roads_array, model::Map& map);
 void ParseBuildings(const json::array& buildings_array, model::Map& map);
 void ParseOffices(const json::array& offices_array, model::Map& map);
+model::AreaOfInterest ParseAreaOfInterest(const json::object& area_object);
 
 model::Game LoadGame(const std::filesystem::path& json_path);
 
@@ -31,13 +35,23 @@ model::Game LoadGame(const std::filesystem::path& json_path);
 
 json::array GetMapsArray(const model::Game::Maps& maps); // метод для запроса /api/v1/maps
 json::object GetMapObject(const model::Map *map); // метод для запроса /api/v1/maps/<mapX>
-json::object GetGameStateObject(const model::DogPtrs& dogs, const model::LootPtrs& loots); // метод для запроса /api/v1/game/state
-json::object GetPlayerListObject(const model::DogPtrs& dogs); // метод для запроса /api/v1/game/players
+json::object GetGameStateObject(const model::Dogs& dogs, const model::Loots& loots); // метод для запроса /api/v1/game/state
+json::object GetGameStateObject(const model::Dogs& dogs, const model::Loots& loots,        // то же в области видимости:
+                                const std::vector<uint32_t>& dog_indices,                 // только собаки и предметы
+                                const std::vector<uint32_t>& loot_indices);               // с указанными индексами
+json::object GetGameStateDeltaObject(const model::StateDelta& delta, uint64_t tick, uint64_t since); // то же с параметром since
+json::object GetPlayerListObject(const model::Dogs& dogs); // метод для запроса /api/v1/game/players
 json::array GetGameRecordsArray(const postgres::PlayersRecords records); // метод для запроса /api/v1/game/records
+json::object GetTickerStatsObject(const ticker::TickerStats& stats); // для журналирования статистики шагов Ticker
+json::object GetTickProfileObject(const tick_profiler::TickProfiler& profiler); // метод для запроса /api/v1/admin/tick-profile
+json::object GetRecordsWriterStatsObject(const records_writer::RecordsWriterStats& stats); // метод для запроса /api/v1/admin/records-queue
 
 // вспомогательный функции
 
 json::array GetRoadsArray(const model::Map *map);
+json::object GetDogStateObject(const model::Dog& dog);
+json::object GetLootStateObject(const model::Loot& loot);
+json::object GetRollingHistogramObject(const tick_profiler::RollingHistogram& histogram);
 json::array GetBuildingsArray(const model::Map *map);
 json::array GetOfficesArray(const model::Map *map);
 json::array GetLootTypesArray(const model::Map *map);
@@ -12,12 +12,19 @@ namespace json_constants {
     static inline const std::string KeyMaps = "maps";
     static inline const std::string KeyDefaultDogSpeed = "defaultDogSpeed";
     static inline const std::string KeyDefaultDogBagCapacity = "defaultBagCapacity";
+    static inline const std::string KeyDefaultMaxPlayers = "defaultMaxPlayers";
     static inline const std::string KeyLootGeneratorConfig = "lootGeneratorConfig";
     static inline const std::string KeyPeriod = "period";
     static inline const std::string KeyProbability = "probability";
     static inline const std::string KeyDogRetirementTime = "dogRetirementTime";
     static inline const std::string KeyDogSpeed = "dogSpeed";
     static inline const std::string KeyDogBagCapacity = "bagCapacity";
+    static inline const std::string KeyMaxPlayers = "maxPlayers";
+    static inline const std::string KeyAreaOfInterest = "areaOfInterest";
+    static inline const std::string KeyRadius = "radius";
+    static inline const std::string KeyDistance = "distance";
+    static inline const std::string DistanceEuclidean = "euclidean";
+    static inline const std::string DistanceManhattan = "manhattan";
     static inline const std::string KeyId = "id";
     static inline const std::string KeyName = "name";
     static inline const std::string KeyType = "type";
@@ -43,6 +50,46 @@ namespace json_constants {
     static inline const std::string KeyH = "h";
     static inline const std::string KeyOffsetX = "offsetX";
     static inline const std::string KeyOffsetY = "offsetY";
+    static inline const std::string KeyTicks = "ticks";
+    static inline const std::string KeySteps = "steps";
+    static inline const std::string KeyOverruns = "overruns";
+    static inline const std::string KeyDroppedSteps = "droppedSteps";
+    static inline const std::string KeyMeanLatenessMs = "meanLatenessMs";
+    static inline const std::string KeyMaxLatenessMs = "maxLatenessMs";
+    static inline const std::string KeyMeanJitterMs = "meanJitterMs";
+    static inline const std::string KeyMaxJitterMs = "maxJitterMs";
+    static inline const std::string KeyMeanHandlerMs = "meanHandlerMs";
+    static inline const std::string KeyMaxHandlerMs = "maxHandlerMs";
+    static inline const std::string KeyLatenessHistogram = "latenessHistogram";
+    static inline const std::string KeyWindow = "window";
+    static inline const std::string KeyTick = "tick";
+    static inline const std::string KeySince = "since";
+    static inline const std::string KeyRemovedPlayers = "removedPlayers";
+    static inline const std::string KeyRemovedLostObjects = "removedLostObjects";
+    static inline const std::string KeyTickSignal = "tickSignal";
+    static inline const std::string KeySessions = "sessions";
+    static inline const std::string KeyMapId = "mapId";
+    static inline const std::string KeyPhases = "phases";
+    static inline const std::string KeyCount = "count";
+    static inline const std::string KeyMeanMs = "meanMs";
+    static inline const std::string KeyP50Ms = "p50Ms";
+    static inline const std::string KeyP90Ms = "p90Ms";
+    static inline const std::string KeyP99Ms = "p99Ms";
+    static inline const std::string KeyMaxMs = "maxMs";
+    static inline const std::string KeyHistogram = "histogram";
+    static inline const std::string KeyLessThanUs = "lessThanUs";
+    static inline const std::string KeyQueueDepth = "queueDepth";
+    static inline const std::string KeyMaxQueueDepth = "maxQueueDepth";
+    static inline const std::string KeyEnqueued = "enqueued";
+    static inline const std::string KeyWritten = "written";
+    static inline const std::string KeyDropped = "dropped";
+    static inline const std::string KeyBatches = "batches";
+    static inline const std::string KeyFailedBatches = "failedBatches";
+    static inline const std::string KeyLastFlushLatencyMs = "lastFlushLatencyMs";
+    static inline const std::string KeyMeanFlushLatencyMs = "meanFlushLatencyMs";
+    static inline const std::string KeyMaxFlushLatencyMs = "maxFlushLatencyMs";
+    static inline const std::string KeyMeanWriteMs = "meanWriteMs";
+    static inline const std::string KeyMaxWriteMs = "maxWriteMs";
 
 } // namespace json_constants
 
@@ -143,6 +190,8 @@ struct Endpoint
     static inline constexpr std::string_view GAME_ACTION = "/api/v1/game/player/action"sv;
     static inline constexpr std::string_view GAME_TICK = "/api/v1/game/tick"sv;
     static inline constexpr std::string_view GAME_RECORDS = "/api/v1/game/records"sv;
+    static inline constexpr std::string_view ADMIN_TICK_PROFILE = "/api/v1/admin/tick-profile"sv;
+    static inline constexpr std::string_view ADMIN_RECORDS_QUEUE = "/api/v1/admin/records-queue"sv;
 };
 
 struct ContentType
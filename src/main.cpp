@@ -1,24 +1,26 @@
 #include "sdk.h"
 
 #include "app.h"
+#include "journal.h"
 #include "json_loader.h"
 #include "logging_request_handler.h"
 #include "magic_defs.h"
 #include "postgres.h"
 #include "request_handler.h"
 #include "server_logger.h"
+#include "simulation.h"
 #include "state_saver.h"
 #include "ticker.h"
 
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/signal_set.hpp>
-#include <boost/asio/strand.hpp>
 #include <boost/program_options.hpp>
 #include <boost/signals2.hpp>
 #include <filesystem>
 #include <fstream>
 #include <optional>
 #include <memory>
+#include <random>
 #include <thread>
 
 
@@ -37,6 +39,12 @@ struct Args {
     bool randomize_spawn_points;
     std::string state_file = ""; // по умолчанию не задан
     int save_state_period = 0; // по умолчанию не указан - 0
+    unsigned tick_threads = 1; // по умолчанию Tick выполняется в одном потоке
+    ticker::TickerOptions ticker_options; // по умолчанию шаги отсчитываются от завершения предыдущего
+    int tick_stats_period = 0; // по умолчанию статистика Ticker не журналируется - 0
+    size_t tick_profile_window = tick_profiler::DEFAULT_PROFILE_WINDOW; // 0 - профилирование Tick отключено
+    fs::path journal_file; // по умолчанию команды не записываются
+    size_t state_history_ticks = app::DEFAULT_STATE_HISTORY_TICKS; // 0 - GameState с since отдаёт всё состояние
 };
 
 [[nodiscard]] std::optional<Args> ParseCommandLine(int argc, const char* const argv[]) {
@@ -52,7 +60,15 @@ struct Args {
         ("www-root,w", po::value(&args.www_root)->value_name("dir"s), "set static files root")
         ("randomize-spawn-points", "spawn dogs at random positions")
         ("state-file,s", po::value(&args.state_file), "set path to state file")
-        ("save-state-period,p", po::value<int>(&args.save_state_period), "set period in ms for autosave");
+        ("save-state-period,p", po::value<int>(&args.save_state_period), "set period in ms for autosave")
+        ("tick-threads", po::value(&args.tick_threads)->value_name("count"s), "set number of threads for parallel tick by game sessions")
+        ("fixed-step", "schedule ticks at fixed absolute deadlines without drift")
+        ("catch-up", po::value<std::string>()->value_name("substeps|coalesce"s), "set catch-up policy for late fixed-step ticks")
+        ("max-substeps", po::value(&args.ticker_options.max_substeps)->value_name("count"s), "set max number of catch-up substeps per tick")
+        ("tick-stats-period", po::value(&args.tick_stats_period)->value_name("milliseconds"s), "set period in ms for logging tick statistics")
+        ("tick-profile-window", po::value(&args.tick_profile_window)->value_name("ticks"s), "set number of last ticks in tick phases profile (0 - disabled)")
+        ("record-journal", po::value(&args.journal_file)->value_name("file"s), "record joins, actions and ticks to journal for game_replay")
+        ("state-history-ticks", po::value(&args.state_history_ticks)->value_name("ticks"s), "set number of last ticks of state changes for game state requests with since (0 - disabled)");
 
     po::variables_map vm;
     po::store(po::parse_command_line(argc, argv, desc), vm);
@@ -80,6 +96,21 @@ struct Args {
         args.tick_period = vm["tick-period"s].as<int>(); // указан ключ --tick-period и значение
     }
 
+    if (vm.contains("fixed-step"s)) {
+        args.ticker_options.mode = ticker::TickMode::FIXED_STEP; // указан ключ --fixed-step
+    }
+
+    if (vm.contains("catch-up"s)) {
+        const std::string catch_up = vm["catch-up"s].as<std::string>();
+        if (catch_up == "substeps"s) {
+            args.ticker_options.catch_up = ticker::CatchUpPolicy::SUBSTEPS;
+        } else if (catch_up == "coalesce"s) {
+            args.ticker_options.catch_up = ticker::CatchUpPolicy::COALESCE;
+        } else {
+            throw std::runtime_error("Invalid catch-up policy: "s + catch_up);
+        }
+    }
+
     return args;
 }
 
@@ -129,6 +160,9 @@ int main(int argc, const char* argv[]) {
 
         // Создаём объект Application, который содержит сценарии использования
         app::Application app{game, args->tick_period, args->randomize_spawn_points};
+        app.SetTickThreads(args->tick_threads);
+        app.SetTickProfileWindow(args->tick_profile_window);
+        app.SetStateHistory(args->state_history_ticks);
 
         // Создаем объект StateSaver для управления сохранением и загрузкой состояния игры
         state_saver::StateSaver state_saver(app, args->state_file, args->save_state_period);
@@ -144,6 +178,30 @@ int main(int argc, const char* argv[]) {
             }
         }
 
+        // Включаем запись команд в журнал: воспроизведение начинается с пустой игры и seed из заголовка журнала
+        std::ofstream journal_out;
+        std::shared_ptr<journal::JournalWriter> journal;
+        if (!args->journal_file.empty()) {
+            if (game.GetTotalDogsCount() != 0) {
+                server_logger::LogServerStop(EXIT_FAILURE, "Journal can not be recorded for restored game state"sv);
+                return EXIT_FAILURE;
+            }
+            journal_out.open(args->journal_file, std::ios::binary | std::ios::trunc);
+            if (!journal_out) {
+                server_logger::LogServerStop(EXIT_FAILURE, "Failed to open journal "s + args->journal_file.string());
+                return EXIT_FAILURE;
+            }
+
+            std::random_device random_device;
+            journal::Header header;
+            header.random_seed = (uint64_t{random_device()} << 32) | random_device();
+            header.randomize_spawn_points = args->randomize_spawn_points;
+            app.SetRandomSeed(header.random_seed); // только игра и сессии: токены по журналу не восстановить
+            journal = std::make_shared<journal::JournalWriter>(journal_out, header);
+            app.SetJournal(journal);
+            server_logger::LogMessage(json::object{{"path", args->journal_file.string()}}, "Journal recording started");
+        }
+
         // выполняем подключение к БД
         const char* db_url = std::getenv("GAME_DB_URL");
         if (!db_url) {
@@ -187,15 +245,36 @@ int main(int argc, const char* argv[]) {
                 }
             });
 
-        // Создаём strand для выполнения запросов к API
-        auto api_strand = net::make_strand(ioc);
+        // Создаём поток симуляции: в нём выполняются шаги Tick и запросы к API, меняющие состояние игры
+        simulation::Simulation simulation;
 
-        // Настраиваем вызов метода Application::Tick каждые tick_period миллисекунд внутри strand
+        // Настраиваем вызов метода Application::Tick каждые tick_period миллисекунд в потоке симуляции
+        sig::scoped_connection ticker_stats_conn;
         if (app.HasTickPeriod()) {
-            auto ticker = std::make_shared<ticker::Ticker>(api_strand, milliseconds(app.GetTickPeriod()),
-                [&app](milliseconds delta) { app.Tick(delta); }
+            // команды от потоков ввода-вывода накапливаются и выполняются пачкой в начале шага
+            simulation.SetDrainOnTick(true);
+            auto ticker = std::make_shared<ticker::Ticker>(simulation.GetStrand(), milliseconds(app.GetTickPeriod()),
+                [&app, &simulation](milliseconds delta) {
+                    simulation.DrainCommands();
+                    app.Tick(delta);
+                },
+                args->ticker_options
             );
+            // игроки видят состояние на конец последнего шага Ticker - чтения обслуживаются по снимку в потоках ввода-вывода
+            app.EnableStateSnapshots();
             ticker->Start();
+
+            // Журналируем статистику шагов (опоздания, пропуски, время обработчика) с заданным периодом
+            if (args->tick_stats_period > 0) {
+                ticker_stats_conn = app.DoOnTick(
+                    [accumulated = 0ms, period = milliseconds(args->tick_stats_period), ticker](milliseconds delta) mutable {
+                        accumulated += delta;
+                        if (accumulated >= period) {
+                            server_logger::LogMessage(json_loader::GetTickerStatsObject(ticker->GetStats()), "Ticker stats"sv);
+                            accumulated = 0ms;
+                        }
+                    });
+            }
         }
 
         // Добавляем асинхронный обработчик сигналов SIGINT и SIGTERM, при их получении завершаем работу сервера
@@ -208,7 +287,7 @@ int main(int argc, const char* argv[]) {
         });
 
         // Создаём обработчик HTTP-запросов и связываем его с моделью игры и каталогом статических файлов
-        auto handler = std::make_shared<http_handler::RequestHandler>(static_root, api_strand, app);
+        auto handler = std::make_shared<http_handler::RequestHandler>(static_root, simulation, app);
 
 		const auto address = net::ip::make_address(ServerParam::ADDR);
 		constexpr net::ip::port_type port = ServerParam::PORT;
@@ -231,9 +310,17 @@ int main(int argc, const char* argv[]) {
         server_logger::LogServerStart(address.to_string(), port);
 
         // Запускаем обработку асинхронных операций
+        simulation.Start();
         RunWorkers(std::max(1u, num_threads), [&ioc] {
             ioc.run();
         });
+        simulation.Stop(); // до сохранения состояния - шаги Tick больше не выполняются
+
+        if (journal) {
+            journal->Flush();
+            server_logger::LogMessage(json::object{{"records", journal->GetRecordsCount()}, {"ok", journal->IsGood()}},
+                "Journal recording finished");
+        }
 
         // Если указан путь, то сохраняем состояние игры
         if (state_saver.IsPathSet()) {
@@ -1,5 +1,10 @@
 #include "model.h"
 
+#include <algorithm>
+#include <array> // для замены отрезков в RoadIndex::Assign
+#include <atomic> // для барьеров при повторном использовании разделяемых записей журнала
+#include <iterator>
+#include <numeric> // для std::iota
 #include <stdexcept>
 
 
@@ -43,6 +48,13 @@ bool IsValidDirection(std::string_view str) {
     return c == 'U' || c == 'L' || c == 'R' || c == 'D';
 }
 
+uint64_t MixSeed(uint64_t seed, uint64_t stream) noexcept {
+    uint64_t z = seed + (stream + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
 bool IsRectanglesIntersect(geom::Point2D corner1A, geom::Point2D corner2A, geom::Point2D corner1B, geom::Point2D corner2B) {
     double x1_min = corner1A.x;
     double y1_min = corner1A.y;
@@ -75,14 +87,18 @@ bool Road::IsHorizontal() const noexcept {
         return end_;
     }
 
-    geom::Point2D Road::GetRandomPosition() const noexcept {
+    double Road::GetLength() const noexcept {
+        return static_cast<double>(end_.x - start_.x) + static_cast<double>(end_.y - start_.y);
+    }
+
+    geom::Point2D Road::GetRandomPosition(RandomEngine& random) const noexcept {
         geom::Point2D pos;
         if (IsHorizontal()) {
-            pos.y = static_cast<double>(start_.y); 
-            pos.x = GetRandomNumber(static_cast<double>(start_.x), static_cast<double>(end_.x)); 
+            pos.y = static_cast<double>(start_.y);
+            pos.x = GetRandomNumber(static_cast<double>(start_.x), static_cast<double>(end_.x), random);
         } else {
-            pos.x = static_cast<double>(start_.x); 
-            pos.y = GetRandomNumber(static_cast<double>(start_.y), static_cast<double>(end_.y)); 
+            pos.x = static_cast<double>(start_.x);
+            pos.y = GetRandomNumber(static_cast<double>(start_.y), static_cast<double>(end_.y), random);
         }
         return pos;
     }
@@ -135,19 +151,129 @@ bool Road::IsHorizontal() const noexcept {
         return IsRectanglesIntersect(corner1A, corner2A, corner1B, corner2B);
     }
 
-    // все целочисленные координаты на отрезке дороги (x для горизонтальной, y для вертикальной)
-    std::unordered_set<Coord> Road::GetCoords() const {
-        std::unordered_set<Coord> coords;
-        if (IsHorizontal()) {
-            for (int x = start_.x; x <= end_.x; ++x) {
-                coords.insert(x);
-            }
-        } else {
-            for (int y = start_.y; y <= end_.y; ++y) {
-                coords.insert(y);
+// методы класса RoadIndex
+
+    void RoadIndex::Assign(Coord line, Coord from, Coord to, const RoadPtr& road) {
+        Intervals& intervals = lines_[line];
+
+        // отрезки, пересекающиеся с [from, to], заменяются новым и остатками крайних из них
+        auto first = std::lower_bound(intervals.begin(), intervals.end(), from, [](const Interval& interval, Coord coord) {
+            return interval.to < coord;
+        });
+        auto last = first;
+        while (last != intervals.end() && last->from <= to) {
+            ++last;
+        }
+
+        std::array<Interval, 3> replacement;
+        size_t replacement_size = 0;
+        if (first != last && first->from < from) {
+            replacement[replacement_size++] = Interval{first->from, from - 1, first->road};
+        }
+        replacement[replacement_size++] = Interval{from, to, road};
+        if (first != last && std::prev(last)->to > to) {
+            replacement[replacement_size++] = Interval{to + 1, std::prev(last)->to, std::prev(last)->road};
+        }
+
+        const auto position = intervals.erase(first, last);
+        intervals.insert(position, std::make_move_iterator(replacement.begin()),
+                         std::make_move_iterator(replacement.begin() + replacement_size));
+    }
+
+    RoadPtr RoadIndex::Find(Coord line, Coord coord) const noexcept {
+        auto line_it = lines_.find(line);
+        if (line_it == lines_.end()) {
+            return nullptr;
+        }
+        const Intervals& intervals = line_it->second;
+        auto it = std::upper_bound(intervals.begin(), intervals.end(), coord, [](Coord coord, const Interval& interval) {
+            return coord < interval.from;
+        });
+        if (it == intervals.begin() || std::prev(it)->to < coord) {
+            return nullptr;
+        }
+        return std::prev(it)->road;
+    }
+
+    RoadSpan RoadIndex::FindSpan(Coord line, Coord coord) const noexcept {
+        RoadSpan span{line, std::numeric_limits<Coord>::min(), std::numeric_limits<Coord>::max(), nullptr};
+        auto line_it = lines_.find(line);
+        if (line_it == lines_.end()) {
+            return span;
+        }
+        const Intervals& intervals = line_it->second;
+        auto it = std::upper_bound(intervals.begin(), intervals.end(), coord, [](Coord coord, const Interval& interval) {
+            return coord < interval.from;
+        });
+        if (it != intervals.begin() && std::prev(it)->to >= coord) {
+            return RoadSpan{line, std::prev(it)->from, std::prev(it)->to, std::prev(it)->road.get()};
+        }
+        if (it != intervals.begin()) {
+            span.from = std::prev(it)->to + 1;
+        }
+        if (it != intervals.end()) {
+            span.to = it->from - 1;
+        }
+        return span;
+    }
+
+    void RoadIndex::Clear() noexcept {
+        lines_.clear();
+    }
+
+    size_t RoadIndex::GetIntervalsCount() const noexcept {
+        size_t count = 0;
+        for (const auto& [line, intervals] : lines_) {
+            count += intervals.size();
+        }
+        return count;
+    }
+
+// методы класса RoadSampler
+
+    void RoadSampler::Build(const RoadPtrs& roads) {
+        const size_t count = roads.size();
+        std::vector<double> weights(count);
+        double total = 0.0;
+        for (size_t i = 0; i < count; ++i) {
+            weights[i] = roads[i]->GetLength();
+            total += weights[i];
+        }
+
+        // столбцы со средним весом 1: недостающее до 1 в лёгком столбце берётся из тяжёлого
+        std::vector<uint32_t> light;
+        std::vector<uint32_t> heavy;
+        for (size_t i = 0; i < count; ++i) {
+            weights[i] = total > 0.0 ? weights[i] * static_cast<double>(count) / total : 1.0;
+            (weights[i] < 1.0 ? light : heavy).push_back(static_cast<uint32_t>(i));
+        }
+
+        thresholds_.assign(count, 1.0);
+        aliases_.resize(count);
+        std::iota(aliases_.begin(), aliases_.end(), uint32_t{0});
+        while (!light.empty() && !heavy.empty()) {
+            const uint32_t small = light.back();
+            light.pop_back();
+            const uint32_t large = heavy.back();
+            thresholds_[small] = weights[small];
+            aliases_[small] = large;
+            weights[large] -= 1.0 - weights[small];
+            if (weights[large] < 1.0) {
+                heavy.pop_back();
+                light.push_back(large);
             }
         }
-        return coords;
+        // оставшиеся столбцы заполнены до 1 с точностью округления - порог 1.0 без псевдонима
+    }
+
+    size_t RoadSampler::Sample(RandomEngine& random) const {
+        const double value = GetRandomNumber(0.0, static_cast<double>(thresholds_.size()), random);
+        const size_t column = std::min(static_cast<size_t>(value), thresholds_.size() - 1);
+        return value - static_cast<double>(column) < thresholds_[column] ? column : aliases_[column];
+    }
+
+    size_t RoadSampler::GetSize() const noexcept {
+        return thresholds_.size();
     }
 
 // методы класса Building
@@ -192,6 +318,14 @@ bool Road::IsHorizontal() const noexcept {
         return offices_;
     }
 
+    void Map::QueryOffices(geom::Point2D min_corner, geom::Point2D max_corner, std::vector<uint32_t>& out) const {
+        if (max_corner.x < offices_min_corner_.x || offices_max_corner_.x < min_corner.x
+            || max_corner.y < offices_min_corner_.y || offices_max_corner_.y < min_corner.y) {
+            return;
+        }
+        office_index_.QueryRect(min_corner, max_corner, out);
+    }
+
     const Map::LootTypes& Map::GetLootTypes() const noexcept {
         return loot_types_;
     }
@@ -200,14 +334,11 @@ bool Road::IsHorizontal() const noexcept {
         return loot_types_.size();
     }
 
-    const RoadPtr Map::GetRandomRoad() const noexcept {
+    const RoadPtr Map::GetRandomRoad(RandomEngine& random) const noexcept {
         if (road_ptrs_.empty()) {
             return nullptr;
         }
-
-        size_t start = 0;
-        size_t ind = GetRandomNumber(start, road_ptrs_.size() - 1);
-        return road_ptrs_.at(ind);
+        return road_ptrs_[road_sampler_.Sample(random)];
     }
 
     std::optional<double> Map::GetSpeed() const noexcept {
@@ -218,6 +349,10 @@ bool Road::IsHorizontal() const noexcept {
         return bag_capacity_;
     }
 
+    std::optional<size_t> Map::GetMaxPlayers() const noexcept {
+        return max_players_;
+    }
+
     void Map::AddRoad(const Road& road) {
         if (road.IsHorizontal()) { // для горизонтальной дороги
             const auto road_ptr_by_start = FindHorizontalRoadByPoint(road.GetStart()); // для проверки пересечения с дорогой в начале новой дороги
@@ -227,10 +362,7 @@ bool Road::IsHorizontal() const noexcept {
                 Road new_road = Road(model::Road::HORIZONTAL, road_ptr_by_start->GetStart(), road_ptr_by_end->GetEnd().x); // новая дорога от начала road_ptr_by_start до конца road_ptr_by_end
                 RoadPtr road_ptr = std::make_shared<Road>(new_road);
                 road_ptrs_.push_back(road_ptr);
-                const auto coord_y = new_road.GetStart().y;
-                for (const auto coord : new_road.GetCoords()) {
-                    horizontal_road_by_point_[Point{coord, coord_y}] = road_ptrs_.back();
-                }
+                horizontal_roads_.Assign(new_road.GetStart().y, new_road.GetStart().x, new_road.GetEnd().x, road_ptrs_.back());
                 RemoveRoad(road_ptr_by_start); // удалить road_ptr_by_start
                 RemoveRoad(road_ptr_by_end); // удалить road_ptr_by_end
 
@@ -238,29 +370,20 @@ bool Road::IsHorizontal() const noexcept {
                 Road new_road = Road(model::Road::HORIZONTAL, road_ptr_by_start->GetStart(), road.GetEnd().x); // новая дорога от начала road_ptr_by_start до конца road
                 RoadPtr road_ptr = std::make_shared<Road>(new_road);
                 road_ptrs_.push_back(road_ptr);
-                const auto coord_y = new_road.GetStart().y;
-                for (const auto coord : new_road.GetCoords()) {
-                    horizontal_road_by_point_[Point{coord, coord_y}] = road_ptrs_.back();
-                }
+                horizontal_roads_.Assign(new_road.GetStart().y, new_road.GetStart().x, new_road.GetEnd().x, road_ptrs_.back());
                 RemoveRoad(road_ptr_by_start); // удалить road_ptr_by_start
 
             } else if (road_ptr_by_end) { // 3. есть пересечение только со end
                 Road new_road = Road(model::Road::HORIZONTAL, road.GetStart(), road_ptr_by_end->GetEnd().x); // новая дорога от начала road до конца road_ptr_by_end
                 RoadPtr road_ptr = std::make_shared<Road>(new_road);
                 road_ptrs_.push_back(road_ptr);
-                const auto coord_y = new_road.GetStart().y;
-                for (const auto coord : new_road.GetCoords()) {
-                    horizontal_road_by_point_[Point{coord, coord_y}] = road_ptrs_.back();
-                }
+                horizontal_roads_.Assign(new_road.GetStart().y, new_road.GetStart().x, new_road.GetEnd().x, road_ptrs_.back());
                 RemoveRoad(road_ptr_by_end); // удалить road_ptr_by_end
 
             } else { // 4. если нет пересечения ни на start, ни на end - просто создаём указатель на новую дорогу
                 RoadPtr road_ptr = std::make_shared<Road>(road);
                 road_ptrs_.push_back(road_ptr);
-                const auto coord_y = road.GetStart().y;
-                for (const auto coord : road.GetCoords()) {
-                    horizontal_road_by_point_[Point{coord, coord_y}] = road_ptrs_.back();
-                }
+                horizontal_roads_.Assign(road.GetStart().y, road.GetStart().x, road.GetEnd().x, road_ptrs_.back());
             }
 
         } else { // аналогично для вертикальной дороги
@@ -270,10 +393,7 @@ bool Road::IsHorizontal() const noexcept {
                 Road new_road = Road(model::Road::VERTICAL, road_ptr_by_start->GetStart(), road_ptr_by_end->GetEnd().y); // новая дорога от начала road_ptr_by_start до конца road_ptr_by_end
                 RoadPtr road_ptr = std::make_shared<Road>(new_road);
                 road_ptrs_.push_back(road_ptr);
-                const auto coord_x = new_road.GetStart().x;
-                for (const auto coord : new_road.GetCoords()) {
-                    vertical_road_by_point_[Point{coord_x, coord}] = road_ptrs_.back();
-                }
+                vertical_roads_.Assign(new_road.GetStart().x, new_road.GetStart().y, new_road.GetEnd().y, road_ptrs_.back());
                 RemoveRoad(road_ptr_by_start); // удалить road_ptr_by_start
                 RemoveRoad(road_ptr_by_end); // удалить road_ptr_by_end
 
@@ -281,31 +401,23 @@ bool Road::IsHorizontal() const noexcept {
                 Road new_road = Road(model::Road::VERTICAL, road_ptr_by_start->GetStart(), road.GetEnd().y); // новая дорога от начала road_ptr_by_start до конца road
                 RoadPtr road_ptr = std::make_shared<Road>(new_road);
                 road_ptrs_.push_back(road_ptr);
-                const auto coord_x = new_road.GetStart().x;
-                for (const auto coord : new_road.GetCoords()) {
-                    vertical_road_by_point_[Point{coord_x, coord}] = road_ptrs_.back();
-                }
+                vertical_roads_.Assign(new_road.GetStart().x, new_road.GetStart().y, new_road.GetEnd().y, road_ptrs_.back());
                 RemoveRoad(road_ptr_by_start); // удалить road_ptr_by_start
 
             } else if (road_ptr_by_end) { // 3. есть пересечение только со end
                 Road new_road = Road(model::Road::VERTICAL, road.GetStart(), road_ptr_by_end->GetEnd().y); // новая дорога от начала road до конца road_ptr_by_end
                 RoadPtr road_ptr = std::make_shared<Road>(new_road);
                 road_ptrs_.push_back(road_ptr);
-                const auto coord_x = new_road.GetStart().x;
-                for (const auto coord : new_road.GetCoords()) {
-                    vertical_road_by_point_[Point{coord_x, coord}] = road_ptrs_.back();
-                }
+                vertical_roads_.Assign(new_road.GetStart().x, new_road.GetStart().y, new_road.GetEnd().y, road_ptrs_.back());
                 RemoveRoad(road_ptr_by_end); // удалить road_ptr_by_end
 
             } else { // 4. если нет пересечения ни на start, ни на end - просто создаём указатель на новую дорогу
                 RoadPtr road_ptr = std::make_shared<Road>(road);
                 road_ptrs_.push_back(road_ptr);
-                const auto coord_x = road.GetStart().x;
-                for (const auto coord : road.GetCoords()) {
-                    vertical_road_by_point_[Point{coord_x, coord}] = road_ptrs_.back();
-                }
+                vertical_roads_.Assign(road.GetStart().x, road.GetStart().y, road.GetEnd().y, road_ptrs_.back());
             }
         }
+        road_sampler_.Build(road_ptrs_);
     }
 
     void Map::AddBuilding(const Building& building) {
@@ -330,6 +442,17 @@ bool Road::IsHorizontal() const noexcept {
             offices_.pop_back();
             throw;
         }
+        const Point point = o.GetPosition();
+        const geom::Point2D pos{static_cast<double>(point.x), static_cast<double>(point.y)};
+        try {
+            office_index_.Insert(static_cast<uint32_t>(index), pos);
+        } catch (const std::exception& ex) {
+            warehouse_id_to_index_.erase(o.GetId());
+            offices_.pop_back();
+            throw;
+        }
+        offices_min_corner_ = {std::min(offices_min_corner_.x, pos.x), std::min(offices_min_corner_.y, pos.y)};
+        offices_max_corner_ = {std::max(offices_max_corner_.x, pos.x), std::max(offices_max_corner_.y, pos.y)};
     }
 
     void Map::SetDogSpeed(double speed) {
@@ -340,6 +463,10 @@ bool Road::IsHorizontal() const noexcept {
         bag_capacity_ = bag_capacity;
     }
 
+    void Map::SetMaxPlayers(size_t max_players) {
+        max_players_ = max_players;
+    }
+
     const RoadPtr Map::FindRoadByPositionAndDirection(geom::Point2D pos, Direction dir, bool by_direction) const noexcept {
         Point point = Point{static_cast<int>(std::round(pos.x)), static_cast<int>(std::round(pos.y))};
 
@@ -356,12 +483,26 @@ bool Road::IsHorizontal() const noexcept {
         }
     }
 
+    const Road* Map::FindRoad(geom::Point2D pos, bool horizontal, RoadCursor& cursor) const noexcept {
+        const Point point = Point{static_cast<int>(std::round(pos.x)), static_cast<int>(std::round(pos.y))};
+        if (horizontal) {
+            if (!cursor.horizontal.Contains(point.y, point.x)) {
+                cursor.horizontal = horizontal_roads_.FindSpan(point.y, point.x);
+            }
+            return cursor.horizontal.road;
+        }
+        if (!cursor.vertical.Contains(point.x, point.y)) {
+            cursor.vertical = vertical_roads_.FindSpan(point.x, point.y);
+        }
+        return cursor.vertical.road;
+    }
+
     const RoadPtr Map::FindHorizontalRoadByPoint(const Point& point) const noexcept {
-        return horizontal_road_by_point_.contains(point) ? horizontal_road_by_point_.at(point) : nullptr;
+        return horizontal_roads_.Find(point.y, point.x);
     }
 
     const RoadPtr Map::FindVerticalRoadByPoint(const Point& point) const noexcept {
-        return vertical_road_by_point_.contains(point) ? vertical_road_by_point_.at(point) : nullptr;
+        return vertical_roads_.Find(point.x, point.y);
     }
 
     void Map::RemoveRoad(const RoadPtr road) {
@@ -378,6 +519,87 @@ bool Road::IsHorizontal() const noexcept {
     }
 }
 
+// методы класса MapBuilder
+
+    void MapBuilder::AddRoad(const Road& road) {
+        roads_.push_back(road);
+    }
+
+    void MapBuilder::Build() {
+        struct Segment {
+            bool is_horizontal;
+            Coord line; // y для горизонтальной дороги, x для вертикальной
+            Coord from;
+            Coord to;
+            size_t order; // порядок добавления
+        };
+
+        std::vector<Segment> segments;
+        segments.reserve(map_.road_ptrs_.size() + roads_.size());
+        const auto add_segment = [&segments](const Road& road) {
+            const size_t order = segments.size();
+            if (road.IsHorizontal()) {
+                segments.push_back(Segment{true, road.GetStart().y, road.GetStart().x, road.GetEnd().x, order});
+            } else {
+                segments.push_back(Segment{false, road.GetStart().x, road.GetStart().y, road.GetEnd().y, order});
+            }
+        };
+        for (const RoadPtr& road : map_.road_ptrs_) {
+            add_segment(*road);
+        }
+        for (const Road& road : roads_) {
+            add_segment(road);
+        }
+
+        std::sort(segments.begin(), segments.end(), [](const Segment& lhs, const Segment& rhs) {
+            return std::tie(lhs.is_horizontal, lhs.line, lhs.from) < std::tie(rhs.is_horizontal, rhs.line, rhs.from);
+        });
+
+        // отрезки одной линии, начинающиеся не дальше конца предыдущих, входят в одну дорогу
+        std::vector<Segment> merged;
+        for (const Segment& segment : segments) {
+            if (!merged.empty()) {
+                Segment& last = merged.back();
+                if (last.is_horizontal == segment.is_horizontal && last.line == segment.line && segment.from <= last.to) {
+                    last.to = std::max(last.to, segment.to);
+                    last.order = std::min(last.order, segment.order);
+                    continue;
+                }
+            }
+            merged.push_back(segment);
+        }
+
+        // индекс заполняется по возрастанию начала отрезков на каждой линии - вставка в конец списка линии
+        map_.road_ptrs_.clear();
+        map_.road_ptrs_.reserve(merged.size());
+        map_.horizontal_roads_.Clear();
+        map_.vertical_roads_.Clear();
+        for (const Segment& segment : merged) {
+            if (segment.is_horizontal) {
+                map_.road_ptrs_.push_back(std::make_shared<Road>(Road::HORIZONTAL, Point{segment.from, segment.line}, segment.to));
+                map_.horizontal_roads_.Assign(segment.line, segment.from, segment.to, map_.road_ptrs_.back());
+            } else {
+                map_.road_ptrs_.push_back(std::make_shared<Road>(Road::VERTICAL, Point{segment.line, segment.from}, segment.to));
+                map_.vertical_roads_.Assign(segment.line, segment.from, segment.to, map_.road_ptrs_.back());
+            }
+        }
+
+        // порядок дорог - по первому отрезку каждой (от него зависит выбор случайной дороги)
+        std::vector<size_t> orders(merged.size());
+        std::iota(orders.begin(), orders.end(), size_t{0});
+        std::sort(orders.begin(), orders.end(), [&merged](size_t lhs, size_t rhs) {
+            return merged[lhs].order < merged[rhs].order;
+        });
+        RoadPtrs road_ptrs;
+        road_ptrs.reserve(orders.size());
+        for (size_t index : orders) {
+            road_ptrs.push_back(std::move(map_.road_ptrs_[index]));
+        }
+        map_.road_ptrs_ = std::move(road_ptrs);
+        map_.road_sampler_.Build(map_.road_ptrs_);
+        roads_.clear();
+    }
+
 // методы класса Dog
 
     const Dog::Id& Dog::GetId() const noexcept {
@@ -416,12 +638,12 @@ bool Road::IsHorizontal() const noexcept {
         return bag_.size() >= bag_capacity_;
     }
 
-    const LootPtrs& Dog::GetBag() const noexcept {
+    const Dog::Bag& Dog::GetBag() const noexcept {
         return bag_;
     }
 
-    void Dog::AddLootIntoBag(LootPtr loot) {
-        bag_.push_back(std::move(loot));
+    void Dog::AddLootIntoBag(const Loot& loot) {
+        bag_.push_back(loot);
     }
 
     void Dog::IncreaseScore(size_t score) noexcept {
@@ -430,7 +652,7 @@ bool Road::IsHorizontal() const noexcept {
 
     void Dog::UpdateScore(const Map::LootTypes& loot_types) {
         for (const auto& loot_in_bag : bag_) {
-            size_t score_for_loot = std::get<int64_t>(loot_types.at(loot_in_bag->type).properties.at("value"));
+            size_t score_for_loot = std::get<int64_t>(loot_types.at(loot_in_bag.type).properties.at("value"));
             IncreaseScore(score_for_loot);
         }
         bag_.clear();
@@ -468,6 +690,10 @@ bool Road::IsHorizontal() const noexcept {
         }
     }
 
+    RoadCursor& Dog::GetRoadCursor() noexcept {
+        return road_cursor_;
+    }
+
     void Dog::SetPosition(geom::Point2D pos) noexcept {
         prev_pos_ = pos_; // позиция до начала хода
         pos_ = pos; // позиция после хода
@@ -489,20 +715,12 @@ bool Road::IsHorizontal() const noexcept {
         return play_time_;
     }
 
-    void Dog::ResetInactivityTime() noexcept {
-        inactivity_time_ = 0;
-    }
-
-    void Dog::IncreaseInactivityTime(const int time_delta) noexcept {
-        inactivity_time_ += static_cast<uint32_t>(time_delta);
-    }
-
-    void Dog::SetInactivityTime(const int time_delta) noexcept {
-        inactivity_time_ = static_cast<uint32_t>(time_delta);
+    void Dog::SetLastActivityTime(int64_t time) noexcept {
+        last_activity_time_ = time;
     }
 
-    uint32_t Dog::GetInactivityTime() const noexcept {
-        return inactivity_time_;
+    int64_t Dog::GetLastActivityTime() const noexcept {
+        return last_activity_time_;
     }
 
     bool Dog::IsMoving() const noexcept {
@@ -517,33 +735,170 @@ bool Road::IsHorizontal() const noexcept {
         is_moving_ = true;
     }
 
+// методы класса AreaIndex
+
+    std::optional<size_t> AreaIndex::FindDogIndex(Dog::Id id) const noexcept {
+        auto it = std::lower_bound(dog_indices.begin(), dog_indices.end(), id, [](const auto& item, Dog::Id id) {
+            return *item.first < *id;
+        });
+        if (it != dog_indices.end() && it->first == id) {
+            return it->second;
+        }
+        return std::nullopt;
+    }
+
+    bool AreaIndex::QueryArea(Dog::Id viewer, const AreaOfInterest& area_of_interest,
+                              std::vector<uint32_t>& dog_indices, std::vector<uint32_t>& loot_indices) const {
+        const std::optional<size_t> viewer_index = FindDogIndex(viewer);
+        if (!viewer_index) {
+            return false;
+        }
+        const geom::Point2D center = dogs.GetPosition(*viewer_index);
+        dogs.Query(center, area_of_interest.radius, area_of_interest.metric, dog_indices);
+        loots.Query(center, area_of_interest.radius, area_of_interest.metric, loot_indices);
+        return true;
+    }
+
+// методы класса TickChanges
+
+    bool TickChanges::IsEmpty() const noexcept {
+        return changed_dogs.empty() && removed_dogs.empty() && added_loots.empty() && removed_loots.empty();
+    }
+
+// методы класса ChangesNode
+
+    ChangesNode::ChangesNode(TickChangesPtr changes, std::shared_ptr<const ChangesNode> older) noexcept
+        : changes{std::move(changes)}
+        , older{std::move(older)} {
+    }
+
+    ChangesNode::~ChangesNode() {
+        // узлы, которыми больше никто не владеет, освобождаются по одному - длина списка не ограничена стеком
+        std::shared_ptr<const ChangesNode> next = std::move(older);
+        while (next && next.use_count() == 1) {
+            std::atomic_thread_fence(std::memory_order_acquire); // чтения узла из снимков - до его изменения
+            next = std::move(const_cast<ChangesNode&>(*next).older);
+        }
+    }
+
+// методы класса StateDelta
+
+    void StateDelta::Clear() noexcept {
+        dogs.clear();
+        removed_dogs.clear();
+        loots.clear();
+        removed_loots.clear();
+    }
+
+    bool CollectDelta(const ChangesHistory& history, uint64_t since, uint64_t tick, StateDelta& delta) {
+        delta.Clear();
+        if (since < history.start || since > tick) {
+            return false;
+        }
+
+        // от новых шагов к старым: первое изменение собаки - её последнее состояние
+        for (const ChangesNode* node = history.newest.get(); node && node->changes->tick > since; node = node->older.get()) {
+            const TickChanges& changes = *node->changes;
+            for (const Dog& dog : changes.changed_dogs) {
+                delta.dogs.push_back(&dog);
+            }
+            delta.removed_dogs.insert(delta.removed_dogs.end(), changes.removed_dogs.begin(), changes.removed_dogs.end());
+            for (const Loot& loot : changes.added_loots) {
+                delta.loots.push_back(&loot);
+            }
+            delta.removed_loots.insert(delta.removed_loots.end(), changes.removed_loots.begin(), changes.removed_loots.end());
+        }
+
+        std::stable_sort(delta.dogs.begin(), delta.dogs.end(), [](const Dog* lhs, const Dog* rhs) {
+            return lhs->GetId() < rhs->GetId();
+        });
+        delta.dogs.erase(std::unique(delta.dogs.begin(), delta.dogs.end(), [](const Dog* lhs, const Dog* rhs) {
+            return lhs->GetId() == rhs->GetId();
+        }), delta.dogs.end());
+
+        // собака и предмет удаляются один раз и больше не появляются - удалённые после изменения не передаются
+        std::sort(delta.removed_dogs.begin(), delta.removed_dogs.end());
+        std::erase_if(delta.dogs, [&delta](const Dog* dog) {
+            return std::binary_search(delta.removed_dogs.begin(), delta.removed_dogs.end(), dog->GetId());
+        });
+        std::sort(delta.removed_loots.begin(), delta.removed_loots.end());
+        std::erase_if(delta.loots, [&delta](const Loot* loot) {
+            return std::binary_search(delta.removed_loots.begin(), delta.removed_loots.end(), loot->id);
+        });
+        return true;
+    }
+
 // методы класса GameSession
 
-    void GameSession::AddDog(DogPtr dog) {
-        dogs_.push_back(std::move(dog));
+    void GameSession::AddDog(Dog dog, uint32_t inactivity_time) {
+        const size_t index = dogs_.size();
+        if (auto [it, inserted] = dog_id_to_index_.emplace(dog.GetId(), index); !inserted) {
+            throw std::invalid_argument("Dog with id "s + std::to_string(*dog.GetId()) + " already exists"s);
+        } else {
+            try {
+                dog.SetLastActivityTime(time_ - inactivity_time);
+                retirement_wheel_.Schedule(dog.GetId(), dog.GetLastActivityTime() + retirement_time_);
+                if (dog.IsMoving()) { // восстановленная собака с меткой движения учитывается на ближайшем шаге
+                    acted_dogs_.push_back(dog.GetId());
+                }
+                dogs_.push_back(std::move(dog));
+                ++layout_version_;
+            } catch (const std::exception& ex) {
+                retirement_wheel_.Remove(it->first);
+                dog_id_to_index_.erase(it);
+                throw;
+            }
+        }
     }
 
-    void GameSession::AddLoot(LootPtr loot) {
-        loots_.push_back(std::move(loot));
+    void GameSession::AddLoot(Loot loot) {
+        const size_t index = loots_.size();
+        if (auto [it, inserted] = loot_id_to_index_.emplace(loot.id, index); !inserted) {
+            throw std::invalid_argument("Loot with id "s + std::to_string(*loot.id) + " already exists"s);
+        } else {
+            try {
+                loot_index_.Insert(static_cast<uint32_t>(index), loot.pos);
+                try {
+                    loots_.push_back(std::move(loot));
+                } catch (const std::exception& ex) {
+                    loot_index_.Erase(static_cast<uint32_t>(index), loot.pos);
+                    throw;
+                }
+                ++layout_version_;
+            } catch (const std::exception& ex) {
+                loot_id_to_index_.erase(it);
+                throw;
+            }
+        }
     }
 
     const Map* GameSession::GetMap() const noexcept {
         return map_;
     }
 
-    DogPtr GameSession::GetDog(Dog::Id id) noexcept {
-        auto it = std::find_if(dogs_.begin(), dogs_.end(), [&id](DogPtr& dog) {
-            return dog->GetId() == id;
-        });
+    Dog* GameSession::GetDog(Dog::Id id) noexcept {
+        if (auto it = dog_id_to_index_.find(id); it != dog_id_to_index_.end()) {
+            return &dogs_[it->second];
+        }
+        return nullptr;
+    }
 
-        return (it != dogs_.end()) ? *it : nullptr;
+    const Dog* GameSession::GetDog(Dog::Id id) const noexcept {
+        if (auto it = dog_id_to_index_.find(id); it != dog_id_to_index_.end()) {
+            return &dogs_[it->second];
+        }
+        return nullptr;
+    }
+
+    Dogs& GameSession::GetDogs() noexcept {
+        return dogs_;
     }
 
-    const DogPtrs& GameSession::GetDogs() const noexcept {
+    const Dogs& GameSession::GetDogs() const noexcept {
         return dogs_;
     }
 
-    const LootPtrs& GameSession::GetLoots() const noexcept {
+    const Loots& GameSession::GetLoots() const noexcept {
         return loots_;
     }
 
@@ -555,35 +910,287 @@ bool Road::IsHorizontal() const noexcept {
         return loots_.size();
     }
 
-    LootPtr GameSession::TakeLoot(Loot::Id id) {
-        auto it = std::find_if(loots_.begin(), loots_.end(), [&id](const LootPtr& loot) {
-            return loot->id == id;
-        });
+    std::optional<Loot> GameSession::TakeLoot(Loot::Id id) {
+        auto it = loot_id_to_index_.find(id);
+        if (it == loot_id_to_index_.end()) {
+            return std::nullopt;
+        }
 
-        if (it != loots_.end()) { // забираем предмет
-            LootPtr loot = std::move(*it); // передаем владение
-            *it = nullptr;
-            loots_.erase(it); // удаляем
-            return loot; // возвращаем владение
+        // забираем предмет, на его место переносим последний - остальные предметы не сдвигаются
+        const size_t index = it->second;
+        loot_id_to_index_.erase(it);
+        Loot loot = std::move(loots_[index]);
+        loot_index_.Erase(static_cast<uint32_t>(index), loot.pos);
+        if (index + 1 != loots_.size()) {
+            loots_[index] = std::move(loots_.back());
+            loot_id_to_index_[loots_[index].id] = index;
+            loot_index_.Renumber(static_cast<uint32_t>(loots_.size() - 1), static_cast<uint32_t>(index), loots_[index].pos);
         }
+        loots_.pop_back();
+        ++layout_version_;
+        return loot;
+    }
 
-        return nullptr;
+    void GameSession::QueryLoots(geom::Point2D min_corner, geom::Point2D max_corner, std::vector<uint32_t>& out) const {
+        loot_index_.QueryRect(min_corner, max_corner, out);
     }
 
     loot_gen::LootGenerator* GameSession::GetLootGenerator() noexcept {
         return &loot_generator_;
     }
 
-    void GameSession::RemoveDogById(Dog::Id id) {
-        auto it = std::find_if(dogs_.begin(), dogs_.end(), [&id](DogPtr& dog) {
-            return dog->GetId() == id;
+    void GameSession::SetRandomSeed(uint64_t seed) {
+        random_engine_.seed(seed);
+    }
+
+    RandomEngine& GameSession::GetRandomEngine() noexcept {
+        return random_engine_;
+    }
+
+    void GameSession::SetSerial(uint64_t serial) noexcept {
+        serial_ = serial;
+    }
+
+    uint64_t GameSession::GetSerial() const noexcept {
+        return serial_;
+    }
+
+    void GameSession::SetDraining(bool draining) noexcept {
+        draining_ = draining;
+    }
+
+    bool GameSession::IsDraining() const noexcept {
+        return draining_;
+    }
+
+    bool GameSession::DogState::operator==(const DogState& other) const noexcept {
+        return pos.x == other.pos.x && pos.y == other.pos.y
+            && speed.x == other.speed.x && speed.y == other.speed.y
+            && dir == other.dir && bag_size == other.bag_size && score == other.score;
+    }
+
+    void GameSession::CommitChanges(uint64_t tick, size_t history_ticks) {
+        std::shared_ptr<TickChanges> changes = std::move(pending_changes_); // пустая запись прошлого шага
+        if (!changes || changes.use_count() != 1) { // запись может делить копия сессии
+            changes = std::make_shared<TickChanges>();
+        } else {
+            std::atomic_thread_fence(std::memory_order_acquire); // use_count без упорядочения - как у буферов снимка
+        }
+        changes->tick = tick;
+
+        // собаки: слияние прошлого и текущего состояния по возрастанию Dog::Id
+        commit_order_.resize(dogs_.size());
+        std::iota(commit_order_.begin(), commit_order_.end(), 0);
+        std::sort(commit_order_.begin(), commit_order_.end(), [this](uint32_t lhs, uint32_t rhs) {
+            return dogs_[lhs].GetId() < dogs_[rhs].GetId();
+        });
+        next_committed_dogs_.clear();
+        auto committed = committed_dogs_.begin();
+        for (uint32_t index : commit_order_) {
+            const Dog& dog = dogs_[index];
+            const DogState state{dog.GetPosition(), dog.GetSpeed(), dog.GetDirection(), dog.GetBag().size(), dog.GetScore()};
+            for (; committed != committed_dogs_.end() && committed->first < dog.GetId(); ++committed) {
+                changes->removed_dogs.push_back(committed->first);
+            }
+            const bool is_known = committed != committed_dogs_.end() && committed->first == dog.GetId();
+            if (!is_known || !(committed->second == state)) {
+                changes->changed_dogs.push_back(dog);
+            }
+            if (is_known) {
+                ++committed;
+            }
+            next_committed_dogs_.emplace_back(dog.GetId(), state);
+        }
+        for (; committed != committed_dogs_.end(); ++committed) {
+            changes->removed_dogs.push_back(committed->first);
+        }
+        std::swap(committed_dogs_, next_committed_dogs_);
+
+        // предметы: только появляются и исчезают
+        next_committed_loots_.clear();
+        for (uint32_t i = 0; i < loots_.size(); ++i) {
+            next_committed_loots_.emplace_back(loots_[i].id, i);
+        }
+        std::sort(next_committed_loots_.begin(), next_committed_loots_.end());
+        auto committed_loot = committed_loots_.begin();
+        for (const auto& [id, index] : next_committed_loots_) {
+            for (; committed_loot != committed_loots_.end() && *committed_loot < id; ++committed_loot) {
+                changes->removed_loots.push_back(*committed_loot);
+            }
+            if (committed_loot != committed_loots_.end() && *committed_loot == id) {
+                ++committed_loot;
+            } else {
+                changes->added_loots.push_back(loots_[index]);
+            }
+        }
+        changes->removed_loots.insert(changes->removed_loots.end(), committed_loot, committed_loots_.end());
+        committed_loots_.clear();
+        for (const auto& [id, index] : next_committed_loots_) {
+            committed_loots_.push_back(id);
+        }
+
+        if (changes_history_.start == std::numeric_limits<uint64_t>::max()) { // первый вызов - журнал с шага tick
+            changes_history_.start = tick - 1;
+        }
+        if (!changes->IsEmpty()) {
+            history_changes_.push_back(changes);
+            changes_history_.newest = std::make_shared<const ChangesNode>(std::move(changes), std::move(changes_history_.newest));
+            ++history_nodes_;
+        } else {
+            pending_changes_ = std::move(changes);
+        }
+        if (tick > history_ticks) {
+            changes_history_.start = std::max(changes_history_.start, tick - history_ticks);
+        }
+        while (!history_changes_.empty() && history_changes_.front()->tick <= changes_history_.start) {
+            history_changes_.pop_front();
+        }
+
+        // устаревшие узлы не отрезаются от разделяемого списка - когда их становится больше, чем нужных,
+        // список строится заново из записей окна: O(1) на шаг в среднем, память - не больше двух окон
+        if (history_nodes_ > 2 * history_changes_.size()) {
+            std::shared_ptr<const ChangesNode> newest;
+            for (const TickChangesPtr& entry : history_changes_) {
+                newest = std::make_shared<const ChangesNode>(entry, std::move(newest));
+            }
+            changes_history_.newest = std::move(newest);
+            history_nodes_ = history_changes_.size();
+        }
+    }
+
+    const ChangesHistory& GameSession::GetChangesHistory() const noexcept {
+        return changes_history_;
+    }
+
+    void GameSession::Hibernate() {
+        if (!dogs_.empty()) {
+            throw std::logic_error("Session with dogs can't hibernate"s);
+        }
+        hibernating_ = true;
+
+        // память, нужная только работающей сессии, освобождается; предметы ужимаются до их числа
+        Dogs{}.swap(dogs_);
+        DogIdToIndex{}.swap(dog_id_to_index_);
+        std::vector<Dog::Id>{}.swap(acted_dogs_);
+        loots_.shrink_to_fit();
+        area_index_ = AreaIndex{};
+        area_index_key_.reset();
+
+        // после пробуждения журнал изменений начинается заново - в усыплённой сессии нет игроков, которым он нужен
+        changes_history_ = ChangesHistory{};
+        decltype(history_changes_){}.swap(history_changes_);
+        history_nodes_ = 0;
+        pending_changes_.reset();
+        decltype(committed_dogs_){}.swap(committed_dogs_);
+        decltype(committed_loots_){}.swap(committed_loots_);
+        decltype(commit_order_){}.swap(commit_order_);
+        decltype(next_committed_dogs_){}.swap(next_committed_dogs_);
+        decltype(next_committed_loots_){}.swap(next_committed_loots_);
+    }
+
+    void GameSession::Wake() noexcept {
+        hibernating_ = false;
+    }
+
+    bool GameSession::IsHibernating() const noexcept {
+        return hibernating_;
+    }
+
+    const AreaIndex& GameSession::GetAreaIndex(double cell_size) {
+        const std::tuple<int64_t, uint64_t, double> key{time_, layout_version_, cell_size};
+        if (area_index_key_ == key) {
+            return area_index_;
+        }
+
+        area_index_.dogs.Build(dogs_.size(), cell_size, [this](size_t i) {
+            return dogs_[i].GetPosition();
+        });
+        area_index_.loots.Build(loots_.size(), cell_size, [this](size_t i) {
+            return loots_[i].pos;
+        });
+        area_index_.dog_indices.clear();
+        area_index_.dog_indices.reserve(dogs_.size());
+        for (size_t i = 0; i < dogs_.size(); ++i) {
+            area_index_.dog_indices.emplace_back(dogs_[i].GetId(), static_cast<uint32_t>(i));
+        }
+        std::sort(area_index_.dog_indices.begin(), area_index_.dog_indices.end(), [](const auto& lhs, const auto& rhs) {
+            return *lhs.first < *rhs.first;
         });
 
-        if (it != dogs_.end()) {
-            dogs_.erase(it);
+        area_index_key_ = key;
+        return area_index_;
+    }
+
+    // удаление за O(1): на место удаляемой собаки переносится последняя
+    void GameSession::RemoveDogById(Dog::Id id) {
+        auto it = dog_id_to_index_.find(id);
+        if (it == dog_id_to_index_.end()) {
+            return;
+        }
+
+        const size_t index = it->second;
+        dog_id_to_index_.erase(it);
+        retirement_wheel_.Remove(id);
+        if (index != dogs_.size() - 1) {
+            dogs_[index] = std::move(dogs_.back());
+            dog_id_to_index_[dogs_[index].GetId()] = index;
+        }
+        dogs_.pop_back();
+        ++layout_version_;
+    }
+
+    void GameSession::SetRetirementTime(int64_t time_ms) {
+        if (time_ms == retirement_time_) {
+            return;
+        }
+        retirement_time_ = time_ms;
+        for (const Dog& dog : dogs_) {
+            retirement_wheel_.Schedule(dog.GetId(), dog.GetLastActivityTime() + retirement_time_);
         }
     }
 
+    void GameSession::SetDogAction(Dog::Id id, std::string_view direction) {
+        Dog* dog = GetDog(id);
+        if (!dog) {
+            throw std::invalid_argument("Dog with id "s + std::to_string(*id) + " not found"s);
+        }
+
+        dog->SetDirectionSpeed(direction);
+        if (!direction.empty()) {
+            dog->Moving(); // метка начала движения на текущем Tick'е
+        } else {
+            dog->Stopped(); // метка остановки на текущем Tick'е
+        }
+        acted_dogs_.push_back(id); // повторы безвредны: метка сбрасывается при первом учёте
+    }
+
+    // Обходятся только собаки, получившие действие на этом шаге, и собаки с наступившим сроком ухода
+    void GameSession::AdvanceTime(int time_delta, std::vector<Dog::Id>& retired_dogs) {
+        time_ += time_delta;
+
+        for (const Dog::Id id : acted_dogs_) {
+            Dog* dog = GetDog(id);
+            if (!dog || !dog->IsMoving()) { // ушла из игры или остановлена до шага
+                continue;
+            }
+            dog->IncreasePlayTime(time_delta); // время в игре растёт, только когда собака движется
+            dog->SetLastActivityTime(time_);
+            dog->Stopped(); // сбрасываем метку движения на текущем тике
+            retirement_wheel_.Schedule(id, time_ + retirement_time_);
+        }
+        acted_dogs_.clear();
+
+        retirement_wheel_.Advance(time_, retired_dogs);
+    }
+
+    int64_t GameSession::GetTime() const noexcept {
+        return time_;
+    }
+
+    uint32_t GameSession::GetInactivityTime(const Dog& dog) const noexcept {
+        return static_cast<uint32_t>(time_ - dog.GetLastActivityTime());
+    }
+
 // методы класса Game
 
     void Game::AddMap(Map map) {
@@ -608,8 +1215,19 @@ bool Road::IsHorizontal() const noexcept {
         default_bag_capacity_ = capacity;
     }
 
-    void Game::SetRetirementTime(double time_in_sec) noexcept {
+    void Game::SetDefaultMaxPlayers(size_t max_players) noexcept {
+        default_max_players_ = max_players;
+    }
+
+    void Game::SetAreaOfInterest(AreaOfInterest area_of_interest) noexcept {
+        area_of_interest_ = area_of_interest;
+    }
+
+    void Game::SetRetirementTime(double time_in_sec) {
         dog_retirement_time_in_sec_ = time_in_sec;
+        for (const GameSessionPtr& session : sessions_) {
+            session->SetRetirementTime(GetRetirementTimeMs());
+        }
     }
 
     void Game::SetLootConfig(double period, double probability) noexcept {
@@ -617,6 +1235,17 @@ bool Road::IsHorizontal() const noexcept {
         loot_probability_ = probability;
     }
 
+    void Game::SetRandomSeed(uint64_t seed) {
+        random_seed_ = seed;
+        for (const GameSessionPtr& session : sessions_) {
+            session->SetRandomSeed(MixSeed(random_seed_, session->GetSerial()));
+        }
+    }
+
+    uint64_t Game::GetRandomSeed() const noexcept {
+        return random_seed_;
+    }
+
     double Game::GetDefaultSpeed() const noexcept {
         return default_speed_;
     }
@@ -625,10 +1254,27 @@ bool Road::IsHorizontal() const noexcept {
         return default_bag_capacity_;
     }
 
+    size_t Game::GetDefaultMaxPlayers() const noexcept {
+        return default_max_players_;
+    }
+
+    const AreaOfInterest& Game::GetAreaOfInterest() const noexcept {
+        return area_of_interest_;
+    }
+
+    size_t Game::GetMaxPlayers(const Map& map) const noexcept {
+        return map.GetMaxPlayers().value_or(default_max_players_);
+    }
+
     double Game::GetRetirementTime() const noexcept {
         return dog_retirement_time_in_sec_;
     }
 
+    // собака уходит, когда время бездействия в целых ms достигает времени ухода
+    int64_t Game::GetRetirementTimeMs() const noexcept {
+        return static_cast<int64_t>(std::ceil(dog_retirement_time_in_sec_ * MILLISECONDS_PER_SECOND));
+    }
+
     double Game::GetLootPeriod() const noexcept {
         return loot_period_;
     }
@@ -650,32 +1296,88 @@ bool Road::IsHorizontal() const noexcept {
 
 
     void Game::AddSession(GameSessionPtr gamession) {
-        const size_t index = sessions_.size();
-        if (auto [it, inserted] = map_id_to_session_.emplace(gamession->GetMap()->GetId(), index); !inserted) {
-            throw std::invalid_argument("GameSession with id "s + *gamession->GetMap()->GetId() + " already exists"s);
-        } else {
-            try {
-                sessions_.emplace_back(std::move(gamession));
-            } catch (const std::exception& ex) {
-                map_id_to_session_.erase(it);
-                throw;
+        gamession->SetRetirementTime(GetRetirementTimeMs());
+        gamession->SetSerial(next_session_serial_++);
+        // поток сессии зависит только от seed и порядка создания: номер, в отличие от позиции в sessions_, не повторяется
+        // после RemoveSession
+        gamession->SetRandomSeed(MixSeed(random_seed_, gamession->GetSerial()));
+
+        GameSessionPtrs& map_sessions = map_id_to_sessions_[gamession->GetMap()->GetId()];
+        map_sessions.push_back(gamession);
+        try {
+            sessions_.emplace_back(std::move(gamession));
+        } catch (const std::exception& ex) {
+            map_sessions.pop_back();
+            throw;
+        }
+        UpdateActiveSessionIndices();
+    }
+
+    // порядок остальных сессий сохраняется - от него зависит сквозная нумерация новых предметов
+    void Game::RemoveSession(const GameSession* session) {
+        const Map::Id map_id = session->GetMap()->GetId(); // до удаления - сессия может освободиться вместе с указателем
+        const auto is_removed = [session](const GameSessionPtr& ptr) {
+            return ptr.get() == session;
+        };
+        std::erase_if(sessions_, is_removed);
+
+        if (auto it = map_id_to_sessions_.find(map_id); it != map_id_to_sessions_.end()) {
+            std::erase_if(it->second, is_removed);
+            if (it->second.empty()) {
+                map_id_to_sessions_.erase(it);
             }
-        } 
+        }
+        UpdateActiveSessionIndices();
+    }
+
+    void Game::HibernateSession(GameSession& session) {
+        if (!session.IsHibernating()) {
+            session.Hibernate();
+            UpdateActiveSessionIndices();
+        }
+    }
+
+    void Game::WakeSession(GameSession& session) {
+        if (session.IsHibernating()) {
+            session.Wake();
+            UpdateActiveSessionIndices();
+        }
+    }
+
+    const std::vector<size_t>& Game::GetActiveSessionIndices() const noexcept {
+        return active_session_indices_;
+    }
+
+    void Game::UpdateActiveSessionIndices() {
+        active_session_indices_.clear();
+        for (size_t i = 0; i < sessions_.size(); ++i) {
+            if (!sessions_[i]->IsHibernating()) {
+                active_session_indices_.push_back(i);
+            }
+        }
     }
 
     GameSessionPtr Game::GetSession(const Map::Id& id) noexcept {
-        if (auto it = map_id_to_session_.find(id); it != map_id_to_session_.end()) {
-            return sessions_.at(it->second);
+        if (auto it = map_id_to_sessions_.find(id); it != map_id_to_sessions_.end()) {
+            return it->second.front();
         }
         return nullptr;
     }
 
+    const GameSessionPtrs& Game::GetMapSessions(const Map::Id& id) const noexcept {
+        static const GameSessionPtrs no_sessions;
+        if (auto it = map_id_to_sessions_.find(id); it != map_id_to_sessions_.end()) {
+            return it->second;
+        }
+        return no_sessions;
+    }
+
     size_t Game::GetSessionsCount() const noexcept {
         return sessions_.size();
     }
 
     bool Game::HasSession(const Map::Id& id) const noexcept {
-        return map_id_to_session_.find(id) != map_id_to_session_.end();
+        return map_id_to_sessions_.find(id) != map_id_to_sessions_.end();
     }
 
     const GameSessionPtrs& Game::GetSessions() const noexcept {
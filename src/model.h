@@ -1,21 +1,26 @@
 #pragma once
 
+#include <boost/container/small_vector.hpp> // для рюкзака собаки без отдельного выделения памяти
 #include <cmath> // для round
 #include <cstdint> // uint32_t
+#include <deque> // для журнала изменений сессии
 #include <iomanip>
+#include <limits>
 #include <optional> // speed_, bag_capacity, Loot, 
 #include <memory> // для shared_ptr
 #include <random>
 #include <stdexcept>  // для std::out_of_range в GetRandomRoad
 #include <string>
+#include <tuple> // ключ актуальности AreaIndex
 #include <variant> // для .Properties для LootType
 #include <vector>
 #include <unordered_map>
-#include <unordered_set> // для Road::GetPoints()
 
 #include "geom.h" // для ::Point2D
 #include "loot_generator.h" // для генератора предметов в каждой GameSession
+#include "spatial_index.h" // для выборки собак и предметов в области видимости игрока
 #include "tagged.h" // для ::ID
+#include "timing_wheel.h" // для сроков ухода собак по бездействию
 
 
 namespace model {
@@ -23,12 +28,15 @@ namespace model {
 constexpr double DEFAULT_DOG_SPEED = 1.0;
 constexpr size_t DEFAULT_DOG_BAG_CAPACITY = 3;
 constexpr double DEFAULT_DOG_RETIREMENT_TIME_IN_SEC = 60.0;
+constexpr size_t DEFAULT_MAX_PLAYERS = 0; // игроков в одном экземпляре сессии карты, 0 - без ограничения
 
 constexpr double ROAD_HALF_WIDTH = 0.8 / 2;
 
 constexpr double DOG_HALF_WIDTH = 0.6 / 2; // 0.6 ширина собаки
 constexpr double OFFICE_HALF_WIDTH = 0.5 / 2; // 0.5 ширина офиса
 constexpr double LOOT_HALF_WIDTH = 0.0;
+constexpr double LOOT_INDEX_CELL_SIZE = 1.0; // ячейка индекса предметов сессии - порядка области сбора собаки за шаг
+constexpr double OFFICE_INDEX_CELL_SIZE = 4.0; // офисов на карте немного - ячейки крупнее
 
 constexpr size_t SIMPLE_NUMBER = 67; // для хэшера Point::Hasher
 //constexpr double EPS = 1.0e-10; // точность сравнения double
@@ -45,12 +53,10 @@ using RoadPtr = std::shared_ptr<Road>;
 using RoadPtrs = std::vector<RoadPtr>;
 
 class Dog; 
-using DogPtr = std::shared_ptr<Dog>;
-using DogPtrs = std::vector<DogPtr>;
+using Dogs = std::vector<Dog>; // собаки хранятся по значению, подряд в памяти
 
 struct Loot;
-using LootPtr = std::shared_ptr<Loot>;
-using LootPtrs = std::vector<LootPtr>;
+using Loots = std::vector<Loot>; // предметы хранятся по значению, подряд в памяти
 
 class GameSession;
 using GameSessionPtr = std::shared_ptr<GameSession>;
@@ -102,11 +108,15 @@ bool IsValidDirection(std::string_view str);
 // нужны: левый нижний и правый верхний угол на декартовой плоскости
 bool IsRectanglesIntersect(geom::Point2D corner1A, geom::Point2D corner2A, geom::Point2D corner1B, geom::Point2D corner2B);
 
-template <typename T>
-T GetRandomNumber(T start, T end) {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
+// Генератор псевдослучайных чисел сессии: при одинаковом seed даёт одинаковую последовательность,
+// что нужно для воспроизведения записанного журнала команд
+using RandomEngine = std::mt19937_64;
+
+// seed независимого потока номер stream, полученный из общего seed (перемешивание SplitMix64)
+uint64_t MixSeed(uint64_t seed, uint64_t stream) noexcept;
 
+template <typename T>
+T GetRandomNumber(T start, T end, RandomEngine& gen) {
     if constexpr (std::is_integral<T>::value) {
         std::uniform_int_distribution<T> dis(std::min(start, end), std::max(start, end));
         return dis(gen);
@@ -171,7 +181,8 @@ public:
     bool IsVertical() const noexcept;
     Point GetStart() const noexcept;
     Point GetEnd() const noexcept;
-    geom::Point2D GetRandomPosition() const noexcept;
+    double GetLength() const noexcept;
+    geom::Point2D GetRandomPosition(RandomEngine& random) const noexcept;
     bool IsPositionOnRoad(geom::Point2D pos) const noexcept; // для тестов - проверка добавленной дороги по координатам
 
     // позиция на границе дороги по направлению движения, можно указать сдвиг от границы: + наружу, - на дороге
@@ -181,8 +192,6 @@ public:
     geom::Point2D GetMaxVertexPosition() const noexcept; // правый верхний угол дороги на декартовой плоскости
     bool IsIntersect(const RoadPtr other) const noexcept; // проверяет пересечение с другой дорогой
 
-    std::unordered_set<Coord> GetCoords() const; // целочисленные координаты точки на оси дороги
-
 private:
     Point start_;
     Point end_;
@@ -221,6 +230,59 @@ private:
     Offset offset_;
 };
 
+// Участок линии индекса дорог: точки [from, to] линии line принадлежат road или лежат вне дорог (road == nullptr)
+struct RoadSpan {
+    Coord line = 0;
+    Coord from = 1; // по умолчанию участок пустой
+    Coord to = 0;
+    const Road* road = nullptr;
+
+    bool Contains(Coord point_line, Coord coord) const noexcept {
+        return line == point_line && from <= coord && coord <= to;
+    }
+};
+
+// Участки дорог, на которых собака была на прошлом шаге - поиск в индексе нужен, только когда она их покидает
+struct RoadCursor {
+    RoadSpan horizontal;
+    RoadSpan vertical;
+};
+
+// Дороги одного направления по целочисленным точкам оси: на каждой линии (y для горизонтальных, x для вертикальных)
+// отсортированные непересекающиеся отрезки. Память - O(числа дорог) независимо от их длины, поиск - O(log n) по линии
+class RoadIndex {
+public:
+    // точки [from, to] линии line принадлежат road - отрезки других дорог на них обрезаются
+    void Assign(Coord line, Coord from, Coord to, const RoadPtr& road);
+    RoadPtr Find(Coord line, Coord coord) const noexcept; // nullptr - точка не на дороге
+    RoadSpan FindSpan(Coord line, Coord coord) const noexcept; // дорога с точкой или промежуток между дорогами
+    size_t GetIntervalsCount() const noexcept;
+    void Clear() noexcept;
+
+private:
+    struct Interval {
+        Coord from;
+        Coord to;
+        RoadPtr road;
+    };
+    using Intervals = std::vector<Interval>; // по возрастанию from
+
+    std::unordered_map<Coord, Intervals> lines_;
+};
+
+// Выбор дороги с вероятностью, пропорциональной её длине, за O(1) - таблица псевдонимов (метод Воуза),
+// строится за O(числа дорог). Если у всех дорог нулевая длина, выбор равновероятный
+class RoadSampler {
+public:
+    void Build(const RoadPtrs& roads);
+    size_t Sample(RandomEngine& random) const; // индекс дороги, таблица не должна быть пустой
+    size_t GetSize() const noexcept;
+
+private:
+    std::vector<double> thresholds_; // вероятность выбрать дорогу столбца, иначе - его псевдоним
+    std::vector<uint32_t> aliases_;
+};
+
 class Map {
 public:
     using Id = util::Tagged<std::string, Map>;
@@ -232,7 +294,8 @@ public:
         : id_(std::move(id))
         , name_(std::move(name))
         , speed_(std::nullopt)
-        , bag_capacity_(std::nullopt) {
+        , bag_capacity_(std::nullopt)
+        , max_players_(std::nullopt) {
     }
 
     const Id& GetId() const noexcept;
@@ -243,13 +306,16 @@ public:
     const RoadPtrs& GetRoads() const noexcept;
 
     const Offices& GetOffices() const noexcept;
+    // Добавляет в out индексы GetOffices() офисов из ячеек индекса, пересекающих прямоугольник, - в том числе вне него
+    void QueryOffices(geom::Point2D min_corner, geom::Point2D max_corner, std::vector<uint32_t>& out) const;
     const LootTypes& GetLootTypes() const noexcept;
     size_t GetLootTypesCount() const noexcept;
 
-    const RoadPtr GetRandomRoad() const noexcept;
+    const RoadPtr GetRandomRoad(RandomEngine& random) const noexcept; // с вероятностью по длине дороги
 
     std::optional<double> GetSpeed() const noexcept;
     std::optional<size_t> GetBagCapacity() const noexcept;
+    std::optional<size_t> GetMaxPlayers() const noexcept;
 
     void AddRoad(const Road& road);
 
@@ -258,28 +324,36 @@ public:
     void AddOffice(Office office);
     void SetDogSpeed(double speed);
     void SetDogBagCapacity(size_t bag_capacity);
+    void SetMaxPlayers(size_t max_players);
 
     // поиск дороги по указанной позиции и по направлению движения по умолчанию
     const RoadPtr FindRoadByPositionAndDirection(geom::Point2D pos, Direction dir, bool by_direction = true) const noexcept;
+    // То же для горизонтальной или вертикальной дороги через участок курсора - O(1), пока точка в нём
+    const Road* FindRoad(geom::Point2D pos, bool horizontal, RoadCursor& cursor) const noexcept;
 
 private:
     using OfficeIdToIndex = std::unordered_map<Office::Id, size_t, util::TaggedHasher<Office::Id>>;
-    using PointToRoad = std::unordered_map<Point, RoadPtr, Point::Hasher>; // объединенные дороги, пересчитанные после добавления каждой
 
     Id id_;
     std::string name_;
 
     RoadPtrs road_ptrs_;
-    PointToRoad horizontal_road_by_point_; // для поиска горизонтальной дороги по координате
-    PointToRoad vertical_road_by_point_; // для поиска вертикальной дороги по координате
+    RoadIndex horizontal_roads_; // объединенные дороги для поиска горизонтальной дороги по координате
+    RoadIndex vertical_roads_; // для поиска вертикальной дороги по координате
+    RoadSampler road_sampler_; // перестраивается при изменении дорог - при выборе только чтение из потоков сессий
 
     Buildings buildings_;
 
     OfficeIdToIndex warehouse_id_to_index_;
     Offices offices_;
+    spatial_index::DynamicGrid office_index_{OFFICE_INDEX_CELL_SIZE}; // офисы не двигаются - индекс заполняется при загрузке карты
+    // прямоугольник, охватывающий все офисы, - большинство собак отсекается без обращения к индексу
+    geom::Point2D offices_min_corner_{std::numeric_limits<double>::max(), std::numeric_limits<double>::max()};
+    geom::Point2D offices_max_corner_{std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest()};
 
     std::optional<double> speed_; // по умолчанию использовать скорость из Game
     std::optional<size_t> bag_capacity_; // по умолчанию использовать вместимость рюкзака из Game
+    std::optional<size_t> max_players_; // по умолчанию использовать ограничение из Game
 
     LootTypes loot_types_;
 
@@ -287,11 +361,33 @@ private:
     const RoadPtr FindVerticalRoadByPoint(const Point& point) const noexcept; // поиск вертикальной дороги по целочисленной точке
 
     void RemoveRoad(const RoadPtr road); // для удаления дороги (повторные участки дорог при добавлении в методе Map::AddRoad)
+
+    friend class MapBuilder;
+};
+
+// Добавление дорог карты пачкой: отрезки сортируются по линии и началу, пересекающиеся и соприкасающиеся
+// в общей точке объединяются за один проход, индекс дорог строится один раз - O(n log n) по числу отрезков
+// вместо O(n^2) при последовательных Map::AddRoad
+class MapBuilder {
+public:
+    explicit MapBuilder(Map& map) noexcept
+        : map_{map} {
+    }
+
+    void AddRoad(const Road& road);
+    // Заменяет дороги карты объединёнными: уже добавленные в карту и накопленные. Объединённая дорога
+    // стоит на месте первого из своих отрезков, порядок дорог без пересечений сохраняется
+    void Build();
+
+private:
+    Map& map_;
+    std::vector<Road> roads_;
 };
 
 class Dog {
 public:
     using Id = util::Tagged<std::uint32_t, Dog>;
+    using Bag = boost::container::small_vector<Loot, DEFAULT_DOG_BAG_CAPACITY>; // при вместимости по умолчанию - без выделения памяти
 
     Dog(Id id, std::string name, geom::Point2D pos, double default_speed, size_t bag_capacity) noexcept
         : id_{id}
@@ -311,8 +407,8 @@ public:
 
     size_t GetBagCapacity() const noexcept;
     bool IsBagFull() const noexcept;
-    const LootPtrs& GetBag() const noexcept;
-    void AddLootIntoBag(LootPtr loot);
+    const Bag& GetBag() const noexcept;
+    void AddLootIntoBag(const Loot& loot);
 
     void IncreaseScore(size_t score) noexcept;
     void UpdateScore(const Map::LootTypes& loot_types);
@@ -326,15 +422,17 @@ public:
     void SetPlayTime(const int time_delta) noexcept;
     uint32_t GetPlayTime() const noexcept;
 
-    void ResetInactivityTime() noexcept;
-    void IncreaseInactivityTime(const int time_delta) noexcept;
-    void SetInactivityTime(const int time_delta) noexcept;
-    uint32_t GetInactivityTime() const noexcept;
+    // время сессии GameSession::GetTime() на конце последнего шага Tick, в котором собака двигалась
+    void SetLastActivityTime(int64_t time) noexcept;
+    int64_t GetLastActivityTime() const noexcept;
 
+    // метку движения нужно ставить через GameSession::SetDogAction, иначе сессия её не учтёт
     bool IsMoving() const noexcept;
     void Stopped() noexcept;
     void Moving() noexcept;
 
+    RoadCursor& GetRoadCursor() noexcept; // кэш для Map::FindRoad, не входит в состояние собаки
+
 private:
     Id id_;
     std::string name_;
@@ -348,13 +446,84 @@ private:
 
     size_t score_ = 0;
     uint32_t play_time_ = 0; // ms
-    uint32_t inactivity_time_ = 0; // ms
+    int64_t last_activity_time_ = 0; // ms
 
     bool is_moving_ = false;
 
-    LootPtrs bag_;
+    Bag bag_;
+
+    RoadCursor road_cursor_;
+};
+
+// Область видимости игрока в ответе /api/v1/game/state: объекты не дальше radius от его собаки
+struct AreaOfInterest {
+    double radius = 0.0; // 0 - видно всё состояние сессии
+    spatial_index::Metric metric = spatial_index::Metric::EUCLIDEAN;
+
+    bool IsEnabled() const noexcept {
+        return radius > 0.0;
+    }
+};
+
+// Пространственный индекс собак и предметов сессии на конец шага Tick
+struct AreaIndex {
+    spatial_index::SpatialGrid dogs; // индексы совпадают с GameSession::GetDogs()
+    spatial_index::SpatialGrid loots; // индексы совпадают с GameSession::GetLoots()
+    std::vector<std::pair<Dog::Id, uint32_t>> dog_indices; // индекс собаки по Dog::Id, по возрастанию Dog::Id
+
+    std::optional<size_t> FindDogIndex(Dog::Id id) const noexcept;
+    // Добавляет индексы собак и предметов в области видимости собаки viewer - O(видимых объектов),
+    // false - собаки нет в индексе
+    bool QueryArea(Dog::Id viewer, const AreaOfInterest& area_of_interest,
+                   std::vector<uint32_t>& dog_indices, std::vector<uint32_t>& loot_indices) const;
+};
+
+// Изменения собак и предметов сессии за один шаг Tick
+struct TickChanges {
+    uint64_t tick = 0; // номер шага Tick приложения
+    Dogs changed_dogs; // добавленные и изменённые собаки - состояние на конец шага
+    std::vector<Dog::Id> removed_dogs;
+    Loots added_loots; // предметы не меняются - только появляются и исчезают
+    std::vector<Loot::Id> removed_loots;
+
+    bool IsEmpty() const noexcept;
+};
+
+using TickChangesPtr = std::shared_ptr<const TickChanges>;
+
+// Узел неизменяемого списка записей журнала - от новых шагов к старым
+struct ChangesNode {
+    ChangesNode(TickChangesPtr changes, std::shared_ptr<const ChangesNode> older) noexcept;
+    ~ChangesNode(); // освобождает хвост списка без рекурсии
+    ChangesNode(const ChangesNode&) = delete;
+    ChangesNode& operator=(const ChangesNode&) = delete;
+
+    TickChangesPtr changes;
+    std::shared_ptr<const ChangesNode> older;
+};
+
+// Журнал изменений сессии за последние шаги Tick: покрывает все шаги после start, шаги без изменений не хранятся.
+// Список неизменяем и разделяется между копиями журнала (снимками состояния) - копия стоит O(1).
+// Узлы шагов не позже start могут оставаться в хвосте списка, CollectDelta до них не доходит
+struct ChangesHistory {
+    uint64_t start = std::numeric_limits<uint64_t>::max(); // изменения не отслеживаются
+    std::shared_ptr<const ChangesNode> newest; // по убыванию tick
 };
 
+// Изменения после шага since: собаки и предметы указывают в записи журнала и действительны, пока он жив
+struct StateDelta {
+    std::vector<const Dog*> dogs; // добавленные и изменённые - последнее состояние
+    std::vector<Dog::Id> removed_dogs;
+    std::vector<const Loot*> loots; // добавленные
+    std::vector<Loot::Id> removed_loots;
+
+    void Clear() noexcept;
+};
+
+// Собирает изменения шагов (since, tick] - O(изменений в журнале после since).
+// false - журнал не покрывает эти шаги, нужно всё состояние
+bool CollectDelta(const ChangesHistory& history, uint64_t since, uint64_t tick, StateDelta& delta);
+
 class GameSession {
 public:
     explicit GameSession(const Map* map, double period, double probability) noexcept
@@ -362,29 +531,116 @@ public:
         , loot_generator_(milliseconds(static_cast<int>(period * MILLISECONDS_PER_SECOND)), probability) {
     }
 
-    void AddDog(DogPtr dog);
-    void AddLoot(LootPtr loot);
+    void AddDog(Dog dog, uint32_t inactivity_time = 0); // inactivity_time - для восстановления состояния
+    void AddLoot(Loot loot); // исключение, если предмет с таким Loot::Id уже есть
 
     const Map* GetMap() const noexcept;
-    DogPtr GetDog(Dog::Id id) noexcept;
-    const DogPtrs& GetDogs() const noexcept;
-    const LootPtrs& GetLoots() const noexcept;
+    // указатель действителен до следующего добавления или удаления собаки в сессии
+    Dog* GetDog(Dog::Id id) noexcept;
+    const Dog* GetDog(Dog::Id id) const noexcept;
+    Dogs& GetDogs() noexcept;
+    const Dogs& GetDogs() const noexcept;
+    // порядок предметов меняется при удалении - на место забранного встаёт последний
+    const Loots& GetLoots() const noexcept;
 
     size_t GetDogsCount() const noexcept;
     size_t GetLootsCount() const noexcept;
 
-    LootPtr TakeLoot(Loot::Id id);
+    std::optional<Loot> TakeLoot(Loot::Id id); // O(1): поиск по Loot::Id, на место предмета переносится последний
+    // Добавляет в out индексы GetLoots() предметов из ячеек индекса, пересекающих прямоугольник, - в том числе
+    // вне прямоугольника. Индекс ведётся при добавлении и удалении предметов
+    void QueryLoots(geom::Point2D min_corner, geom::Point2D max_corner, std::vector<uint32_t>& out) const;
 
     loot_gen::LootGenerator* GetLootGenerator() noexcept;
 
+    // случайные числа сессии (места появления собак и предметов, типы предметов)
+    void SetRandomSeed(uint64_t seed);
+    RandomEngine& GetRandomEngine() noexcept;
+
+    // Порядковый номер сессии в игре - назначается Game::AddSession и не повторяется у новых сессий,
+    // даже если память освобождённой сессии используется заново
+    void SetSerial(uint64_t serial) noexcept;
+    uint64_t GetSerial() const noexcept;
+
+    // экземпляр карты, в который не направляются новые игроки - освобождается, когда уйдёт последняя собака
+    void SetDraining(bool draining) noexcept;
+    bool IsDraining() const noexcept;
+
+    // Индекс перестраивается при первом обращении после шага AdvanceTime или изменения состава собак и предметов
+    const AreaIndex& GetAreaIndex(double cell_size);
+
+    // Записывает в журнал изменения собак и предметов с прошлого вызова как шаг tick - O(n log n) по числу
+    // собак и предметов. В журнале остаются последние history_ticks шагов
+    void CommitChanges(uint64_t tick, size_t history_ticks);
+    const ChangesHistory& GetChangesHistory() const noexcept;
+
     void RemoveDogById(Dog::Id id);
 
+    // Усыплённая сессия без собак не участвует в шаге Tick и не держит рабочую память (индексы, журнал изменений),
+    // предметы на карте сохраняются. Усыплять и будить через Game - он ведёт список активных сессий
+    void Hibernate();
+    void Wake() noexcept;
+    bool IsHibernating() const noexcept;
+
+    // время сессии и уход собак по бездействию
+
+    void SetRetirementTime(int64_t time_ms); // пересчитывает сроки ухода всех собак - O(число собак)
+    void SetDogAction(Dog::Id id, std::string_view direction); // направление движения и метка движения на текущем шаге
+    // Продвигает время сессии на time_delta: учитывает собак, получивших действие на этом шаге,
+    // и добавляет в retired_dogs собак, бездействующих не меньше времени ухода
+    void AdvanceTime(int time_delta, std::vector<Dog::Id>& retired_dogs);
+    int64_t GetTime() const noexcept;
+    uint32_t GetInactivityTime(const Dog& dog) const noexcept;
+
 private:
+    using DogIdToIndex = std::unordered_map<Dog::Id, size_t, util::TaggedHasher<Dog::Id>>;
+    using LootIdToIndex = std::unordered_map<Loot::Id, size_t, util::TaggedHasher<Loot::Id>>;
+    using RetirementWheel = timing_wheel::TimingWheel<Dog::Id, util::TaggedHasher<Dog::Id>>;
+
     const Map* map_;
     loot_gen::LootGenerator loot_generator_;
 
-    DogPtrs dogs_;
-    LootPtrs loots_;
+    Dogs dogs_;
+    DogIdToIndex dog_id_to_index_; // для поиска собаки по Dog::Id за O(1)
+    Loots loots_;
+    LootIdToIndex loot_id_to_index_; // для поиска предмета по Loot::Id за O(1)
+    spatial_index::DynamicGrid loot_index_{LOOT_INDEX_CELL_SIZE}; // индексы loots_ по ячейкам карты
+
+    RandomEngine random_engine_;
+    uint64_t serial_ = 0;
+    bool draining_ = false;
+    bool hibernating_ = false;
+
+    uint64_t layout_version_ = 0; // меняется при добавлении и удалении собак и предметов
+    AreaIndex area_index_;
+    std::optional<std::tuple<int64_t, uint64_t, double>> area_index_key_; // время, версия и размер ячейки индекса
+
+    // видимое клиенту состояние собаки - для поиска изменённых собак
+    struct DogState {
+        geom::Point2D pos;
+        geom::Vec2D speed;
+        Direction dir;
+        size_t bag_size;
+        size_t score;
+
+        bool operator==(const DogState& other) const noexcept;
+    };
+
+    ChangesHistory changes_history_;
+    std::deque<TickChangesPtr> history_changes_; // записи шагов после changes_history_.start, по возрастанию tick
+    size_t history_nodes_ = 0; // длина списка changes_history_ вместе с устаревшими узлами
+    std::shared_ptr<TickChanges> pending_changes_; // не попавшая в журнал пустая запись - для следующего шага
+    std::vector<std::pair<Dog::Id, DogState>> committed_dogs_; // на последний CommitChanges, по возрастанию Dog::Id
+    std::vector<Loot::Id> committed_loots_; // по возрастанию
+    // рабочие массивы CommitChanges - память переиспользуется между шагами
+    std::vector<uint32_t> commit_order_;
+    std::vector<std::pair<Dog::Id, DogState>> next_committed_dogs_;
+    std::vector<std::pair<Loot::Id, uint32_t>> next_committed_loots_;
+
+    int64_t time_ = 0; // ms, сумма шагов AdvanceTime
+    int64_t retirement_time_ = static_cast<int64_t>(DEFAULT_DOG_RETIREMENT_TIME_IN_SEC * MILLISECONDS_PER_SECOND); // ms
+    RetirementWheel retirement_wheel_; // срок ухода собаки: время последней активности + retirement_time_
+    std::vector<Dog::Id> acted_dogs_; // собаки, получившие действие после последнего AdvanceTime
 };
 
 class Game {
@@ -405,23 +661,39 @@ public:
 
     void SetDefaultSpeed(double speed) noexcept;
     void SetDefaultBagCapacity(size_t capacity) noexcept;
-    void SetRetirementTime(double time_in_sec) noexcept;
+    void SetDefaultMaxPlayers(size_t max_players) noexcept;
+    void SetAreaOfInterest(AreaOfInterest area_of_interest) noexcept;
+    void SetRetirementTime(double time_in_sec); // применяется и к уже созданным сессиям
     void SetLootConfig(double period, double probability) noexcept;
+    // seed случайных чисел: сессия получает свой поток по порядковому номеру, применяется и к уже созданным сессиям
+    void SetRandomSeed(uint64_t seed);
+    uint64_t GetRandomSeed() const noexcept;
 
     double GetDefaultSpeed() const noexcept;
     size_t GetDefaultBagCapacity() const noexcept;
+    size_t GetDefaultMaxPlayers() const noexcept;
+    size_t GetMaxPlayers(const Map& map) const noexcept; // ограничение карты или по умолчанию, 0 - без ограничения
+    const AreaOfInterest& GetAreaOfInterest() const noexcept;
     double GetRetirementTime() const noexcept;
+    int64_t GetRetirementTimeMs() const noexcept;
     double GetLootPeriod() const noexcept;
     double GetLootProbability() const noexcept;
 
     const Maps& GetMaps() const noexcept;
     const Map* FindMap(const Map::Id& id) const noexcept;
 
+    // У карты может быть несколько экземпляров сессии - новый создаётся, когда остальные заполнены
     void AddSession(GameSessionPtr gamession);
-    GameSessionPtr GetSession(const Map::Id& id) noexcept;
+    void RemoveSession(const GameSession* session); // индексы следующих сессий в GetSessions() сдвигаются
+    GameSessionPtr GetSession(const Map::Id& id) noexcept; // первый экземпляр карты
+    const GameSessionPtrs& GetMapSessions(const Map::Id& id) const noexcept; // все экземпляры карты в порядке создания
     size_t GetSessionsCount() const noexcept;
     bool HasSession(const Map::Id& id) const noexcept;
     const GameSessionPtrs& GetSessions() const noexcept;
+    // Сессия без собак усыпляется, а при входе игрока будится. Шаг Tick обходит только активные сессии
+    void HibernateSession(GameSession& session);
+    void WakeSession(GameSession& session);
+    const std::vector<size_t>& GetActiveSessionIndices() const noexcept; // индексы в GetSessions() по возрастанию
 
     uint32_t GetTotalLootsCount() const noexcept;
     void SetTotalLootsCount(uint32_t loot_count) noexcept;
@@ -434,21 +706,29 @@ public:
 private:
     double default_speed_;
     size_t default_bag_capacity_;
+    size_t default_max_players_ = DEFAULT_MAX_PLAYERS;
+    AreaOfInterest area_of_interest_;
     double dog_retirement_time_in_sec_; // время в секундах
     uint32_t total_loot_count_; // число всех добавленных предметов в игре
     uint32_t total_dog_count_; // число всех добавленных собак игроков в игре
     double loot_period_; 
     double loot_probability_;
+    uint64_t random_seed_ = std::random_device{}();
 
     using MapIdHasher = util::TaggedHasher<Map::Id>;
     using MapIdToIndex = std::unordered_map<Map::Id, size_t, MapIdHasher>;
+    using MapIdToSessions = std::unordered_map<Map::Id, GameSessionPtrs, MapIdHasher>;
 
     Maps maps_;
     MapIdToIndex map_id_to_index_;
 
     GameSessionPtrs sessions_;
+    std::vector<size_t> active_session_indices_; // неусыплённые сессии
+    uint64_t next_session_serial_ = 0;
+
+    MapIdToSessions map_id_to_sessions_;
 
-    MapIdToIndex map_id_to_session_;
+    void UpdateActiveSessionIndices(); // O(число сессий) - при добавлении, удалении, усыплении и пробуждении
 };
 
 }  // namespace model
\ No newline at end of file
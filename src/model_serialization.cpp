@@ -21,11 +21,10 @@ namespace serialization {
         dog.SetDirectionSpeed(DirectionToString(dir_));
         dog.SetSpeed(speed_);
         dog.IncreaseScore(score_);
-        for (LootPtr loot : bag_) {
-            dog.AddLootIntoBag(std::move(loot));
+        for (const Loot& loot : bag_) {
+            dog.AddLootIntoBag(loot);
         }
         dog.SetPlayTime(play_time_);
-        dog.SetInactivityTime(inactivity_time_);
         if (is_moving_) {
             dog.Moving();
         } else {
@@ -43,10 +42,10 @@ namespace serialization {
         }
         GameSession session{map, game.GetLootPeriod(), game.GetLootProbability()};
         for (const DogRepr& dog_repr : dogs_) {
-            session.AddDog(std::make_shared<Dog>(dog_repr.Restore()));
+            session.AddDog(dog_repr.Restore(), dog_repr.GetInactivityTime());
         }
         for (const LootRepr loot_repr : loots_) {
-            session.AddLoot(std::make_shared<Loot>(loot_repr.Restore()));
+            session.AddLoot(loot_repr.Restore());
         }
         return session;
     }
@@ -1,7 +1,10 @@
 #pragma once
 
-#include <boost/serialization/shared_ptr.hpp>
+#include <boost/serialization/shared_ptr.hpp> // рюкзак в архивах версии 0
 #include <boost/serialization/vector.hpp>
+#include <boost/serialization/version.hpp>
+
+#include <memory>
 
 #include "geom.h"
 #include "model.h"
@@ -73,13 +76,15 @@ private:
     int value_;
 };
 
-// DogRepr (DogRepresentation) - сериализованное представление класса Dog
+// DogRepr (DogRepresentation) - сериализованное представление класса Dog.
+// Версия 0 - предметы рюкзака через shared_ptr, версия 1 - по значению
 class DogRepr {
 
 public:
     DogRepr() = default;
 
-    explicit DogRepr(const Dog& dog)
+    // время бездействия хранится в сессии (GameSession::GetInactivityTime)
+    explicit DogRepr(const Dog& dog, uint32_t inactivity_time = 0)
         : id_(dog.GetId()) // Id id_
         , name_(dog.GetName()) // std::string name_
         , pos_(dog.GetPosition()) // geom::Point2D pos_
@@ -89,13 +94,16 @@ public:
         , speed_(dog.GetSpeed()) // geom::Vec2D speed_ 
         , dir_(dog.GetDirection()) // Direction dir_ size_t score_
         , score_(dog.GetScore()) // size_t score_
-        , bag_(dog.GetBag())  // LootPtrs bag_;
+        , bag_(dog.GetBag().begin(), dog.GetBag().end())  // std::vector<Loot> bag_;
         , play_time_(dog.GetPlayTime()) // ms
-        , inactivity_time_(dog.GetInactivityTime()) // ms
+        , inactivity_time_(inactivity_time) // ms
         , is_moving_(dog.IsMoving()) {
     }
 
     [[nodiscard]] Dog Restore() const;
+    uint32_t GetInactivityTime() const noexcept {
+        return inactivity_time_;
+    }
 
 private:
     friend class boost::serialization::access;
@@ -111,12 +119,31 @@ private:
         ar& speed_;
         ar& dir_;
         ar& score_;
-        ar& bag_;
+        if constexpr (Archive::is_loading::value) {
+            if (version == 0) {
+                LoadSharedBag(ar);
+            } else {
+                ar& bag_;
+            }
+        } else {
+            ar& bag_;
+        }
         ar& play_time_;
         ar& inactivity_time_;
         ar& is_moving_;
     }
 
+    // файлы состояния, записанные до хранения предметов по значению
+    template <typename Archive>
+    void LoadSharedBag(Archive& ar) {
+        std::vector<std::shared_ptr<Loot>> bag;
+        ar& bag;
+        bag_.clear();
+        for (const std::shared_ptr<Loot>& loot : bag) {
+            bag_.push_back(*loot);
+        }
+    }
+
     Dog::Id id_ = Dog::Id{0u};
     std::string name_;
     geom::Point2D pos_;
@@ -126,7 +153,7 @@ private:
     geom::Vec2D speed_;
     Direction dir_ = Direction::NORTH;
     size_t score_ = 0;
-    LootPtrs bag_;
+    std::vector<Loot> bag_;
     uint32_t play_time_ = 0; // ms
     uint32_t inactivity_time_ = 0; // ms
     bool is_moving_ = false;
@@ -138,11 +165,11 @@ public:
     GameSessionRepr() = default;
     explicit GameSessionRepr(const GameSession& session)
         : id_(session.GetMap()->GetId()) {
-        for (DogPtr dog : session.GetDogs()) {
-            dogs_.emplace_back(*dog);
+        for (const Dog& dog : session.GetDogs()) {
+            dogs_.emplace_back(dog, session.GetInactivityTime(dog));
         }
-        for (LootPtr loot: session.GetLoots()) {
-            loots_.emplace_back(*loot);
+        for (const Loot& loot: session.GetLoots()) {
+            loots_.emplace_back(loot);
         }
     }
 
@@ -193,3 +220,5 @@ private:
 };
 
 }  // namespace serialization
+
+BOOST_CLASS_VERSION(::serialization::DogRepr, 1)
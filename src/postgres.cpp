@@ -78,4 +78,32 @@ namespace postgres {
         }
     }
 
+    void DataBase::AddRecords(ConnectionPoolPtr pool, const PlayersRecords& records) {
+        if (records.empty()) {
+            return;
+        }
+
+        try {
+            auto connection_ = pool->GetConnection(std::chrono::milliseconds(DELAY_TIME_MS));
+            pqxx::work work{ *connection_ };
+
+            // многострочный VALUES: число параметров меняется от пакета к пакету, поэтому значения экранируются через quote
+            std::string query = "INSERT INTO retired_players (id, name, score, play_time_ms) VALUES "s;
+            for (size_t i = 0; i < records.size(); ++i) {
+                const PlayerRecord& record = records[i];
+                query += (i == 0 ? "("s : ", ("s) + work.quote(record.uuid) + ", "s + work.quote(record.name) + ", "s
+                    + std::to_string(record.score) + ", "s + std::to_string(record.play_time_ms) + ")"s;
+            }
+            query += R"(
+                ON CONFLICT (id)
+                DO UPDATE SET name = excluded.name, score = excluded.score, play_time_ms = excluded.play_time_ms;
+            )"s;
+
+            work.exec(query);
+            work.commit();
+        } catch (const std::exception& ex) {
+            throw std::runtime_error("Error saving records: "s + ex.what());
+        }
+    }
+
 } // namespace postgres
\ No newline at end of file
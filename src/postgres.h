@@ -109,6 +109,7 @@ public:
     static void Init(ConnectionPoolPtr pool);
     static PlayersRecords GetRecords(ConnectionPoolPtr pool, int start, int maxItems);
     static void AddRecord(ConnectionPoolPtr pool, PlayerRecord record);
+    static void AddRecords(ConnectionPoolPtr pool, const PlayersRecords& records); // один INSERT на все записи
 };
 
 
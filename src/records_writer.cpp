@@ -0,0 +1,127 @@
+#include "records_writer.h"
+
+#include <algorithm>
+
+
+namespace records_writer {
+
+// методы класса RecordsWriter
+
+    RecordsWriter::RecordsWriter(WriteBatch write_batch, size_t capacity, size_t max_batch)
+        : write_batch_{std::move(write_batch)}
+        , capacity_{std::max<size_t>(capacity, 1)}
+        , max_batch_{std::max<size_t>(max_batch, 1)}
+        , thread_{[this] { WriterLoop(); }} {
+    }
+
+    RecordsWriter::~RecordsWriter() {
+        {
+            std::lock_guard lock{mutex_};
+            stop_ = true;
+        }
+        queue_cv_.notify_one();
+        // std::jthread дожидается записи оставшейся очереди в деструкторе thread_
+    }
+
+    bool RecordsWriter::Push(postgres::PlayerRecord record) {
+        {
+            std::lock_guard lock{mutex_};
+            if (queue_.size() >= capacity_) {
+                ++stats_.dropped;
+                return false;
+            }
+
+            queue_.push_back({std::move(record), Clock::now()});
+            ++pushed_;
+            ++stats_.enqueued;
+            stats_.max_queue_depth = std::max(stats_.max_queue_depth, queue_.size());
+        }
+        queue_cv_.notify_one();
+        return true;
+    }
+
+    bool RecordsWriter::WaitFlushed(std::chrono::milliseconds timeout) {
+        std::unique_lock lock{mutex_};
+        const uint64_t target = pushed_;
+        return flushed_cv_.wait_for(lock, timeout, [this, target] {
+            return flushed_ >= target;
+        });
+    }
+
+    RecordsWriterStats RecordsWriter::GetStats() const {
+        std::lock_guard lock{mutex_};
+        RecordsWriterStats stats = stats_;
+        stats.queue_depth = queue_.size();
+        return stats;
+    }
+
+    void RecordsWriter::WriterLoop() {
+        postgres::PlayersRecords batch;
+        batch.reserve(max_batch_);
+
+        std::unique_lock lock{mutex_};
+        while (true) {
+            queue_cv_.wait(lock, [this] {
+                return stop_ || !queue_.empty();
+            });
+            if (queue_.empty()) { // остановка и всё записано
+                break;
+            }
+
+            // копируем пакет, не извлекая из очереди: при ошибке БД он будет записан повторно
+            const size_t batch_size = std::min(queue_.size(), max_batch_);
+            batch.clear();
+            for (size_t i = 0; i < batch_size; ++i) {
+                batch.push_back(queue_[i].record);
+            }
+            const Clock::time_point oldest = queue_.front().enqueued;
+
+            lock.unlock();
+            const Clock::time_point start = Clock::now();
+            bool written = true;
+            try {
+                write_batch_(batch);
+            } catch (const std::exception&) {
+                written = false;
+            }
+            const Clock::duration write_time = Clock::now() - start;
+            lock.lock();
+
+            if (written) {
+                queue_.erase(queue_.begin(), queue_.begin() + batch_size);
+                flushed_ += batch_size;
+                UpdateStats(batch_size, oldest, write_time);
+                flushed_cv_.notify_all();
+                continue;
+            }
+
+            ++stats_.failed_batches;
+            if (stop_) { // при остановке не ждём восстановления БД - оставшиеся записи теряются
+                stats_.dropped += queue_.size();
+                flushed_ += queue_.size();
+                queue_.clear();
+                flushed_cv_.notify_all();
+                break;
+            }
+            queue_cv_.wait_for(lock, RETRY_DELAY, [this] {
+                return stop_;
+            });
+        }
+    }
+
+    void RecordsWriter::UpdateStats(size_t batch_size, Clock::time_point oldest, Clock::duration write_time) {
+        using std::chrono::duration_cast;
+
+        const microseconds latency = duration_cast<microseconds>(Clock::now() - oldest);
+        const microseconds write_us = duration_cast<microseconds>(write_time);
+
+        stats_.written += batch_size;
+        ++stats_.batches;
+        stats_.last_flush_latency = latency;
+        stats_.max_flush_latency = std::max(stats_.max_flush_latency, latency);
+        stats_.total_flush_latency += latency;
+        stats_.max_write_time = std::max(stats_.max_write_time, write_us);
+        stats_.total_write_time += write_us;
+    }
+
+} // namespace records_writer
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "postgres.h" // для PlayerRecord
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+
+namespace records_writer {
+
+using Clock = std::chrono::steady_clock;
+using microseconds = std::chrono::microseconds;
+
+constexpr size_t DEFAULT_QUEUE_CAPACITY = 10000; // записи сверх ёмкости отбрасываются, а не блокируют Tick
+constexpr size_t DEFAULT_MAX_BATCH = 500; // записей в одном INSERT
+constexpr std::chrono::milliseconds RETRY_DELAY{500}; // пауза перед повтором пакета после ошибки БД
+
+// Статистика очереди записи рекордов с момента запуска
+struct RecordsWriterStats {
+    size_t queue_depth = 0; // записи в очереди, включая записываемый пакет
+    size_t max_queue_depth = 0;
+    uint64_t enqueued = 0;
+    uint64_t written = 0;
+    uint64_t dropped = 0; // отброшены из-за переполнения очереди или ошибки БД при остановке
+    uint64_t batches = 0;
+    uint64_t failed_batches = 0;
+
+    microseconds last_flush_latency{0}; // от постановки в очередь самой старой записи пакета до фиксации транзакции
+    microseconds max_flush_latency{0};
+    microseconds total_flush_latency{0}; // сумма по пакетам
+    microseconds max_write_time{0}; // время выполнения одного пакета в БД
+    microseconds total_write_time{0};
+};
+
+// Отложенная запись рекордов в БД: Push только ставит запись в ограниченную очередь,
+// а отдельный поток забирает записи пакетами до max_batch и передаёт их в write_batch.
+// Если write_batch бросает исключение, пакет остаётся в очереди и повторяется через RETRY_DELAY
+class RecordsWriter {
+public:
+    using WriteBatch = std::function<void(const postgres::PlayersRecords& records)>;
+
+    RecordsWriter(WriteBatch write_batch, size_t capacity = DEFAULT_QUEUE_CAPACITY, size_t max_batch = DEFAULT_MAX_BATCH);
+    ~RecordsWriter(); // дописывает оставшиеся записи и останавливает поток
+
+    RecordsWriter(const RecordsWriter&) = delete;
+    RecordsWriter& operator=(const RecordsWriter&) = delete;
+
+    bool Push(postgres::PlayerRecord record); // false - очередь заполнена, запись отброшена
+
+    // Ждёт, пока все поставленные до вызова записи окажутся в БД. false - не дождались за timeout.
+    // Блокирует вызывающий поток - не для обработчиков запросов
+    bool WaitFlushed(std::chrono::milliseconds timeout);
+
+    RecordsWriterStats GetStats() const; // можно вызывать из любого потока
+
+private:
+    struct Entry {
+        postgres::PlayerRecord record;
+        Clock::time_point enqueued;
+    };
+
+    WriteBatch write_batch_;
+    size_t capacity_;
+    size_t max_batch_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable queue_cv_; // уведомление потока записи о новых записях и остановке
+    std::condition_variable flushed_cv_; // уведомление WaitFlushed о записанном пакете
+    std::deque<Entry> queue_;
+    uint64_t pushed_ = 0; // номер последней поставленной записи
+    uint64_t flushed_ = 0; // номер последней записи, покинувшей очередь (записанной или отброшенной)
+    bool stop_ = false;
+    RecordsWriterStats stats_;
+
+    std::jthread thread_; // запускается последним, после инициализации остальных полей
+
+    void WriterLoop();
+    void UpdateStats(size_t batch_size, Clock::time_point oldest, Clock::duration write_time);
+};
+
+} // namespace records_writer
@@ -0,0 +1,99 @@
+#include "replay.h"
+
+#include <bit>
+
+
+namespace replay {
+
+namespace {
+
+constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+constexpr uint64_t FNV_PRIME = 1099511628211ULL;
+
+// FNV-1a по 64-битным словам
+class Checksum {
+public:
+    void Add(uint64_t value) noexcept {
+        hash_ = (hash_ ^ value) * FNV_PRIME;
+    }
+
+    void Add(double value) noexcept {
+        Add(std::bit_cast<uint64_t>(value));
+    }
+
+    void Add(geom::Point2D point) noexcept {
+        Add(point.x);
+        Add(point.y);
+    }
+
+    uint64_t Get() const noexcept {
+        return hash_;
+    }
+
+private:
+    uint64_t hash_ = FNV_OFFSET_BASIS;
+};
+
+} // namespace
+
+double ReplayStats::GetTicksPerSecond() const noexcept {
+    const double seconds = std::chrono::duration<double>(tick_time).count();
+    return seconds > 0.0 ? ticks / seconds : 0.0;
+}
+
+ReplayStats ReplayJournal(journal::JournalReader& reader, app::Application& app) {
+    using Clock = std::chrono::steady_clock;
+
+    app.SetRandomSeed(reader.GetHeader().random_seed);
+
+    ReplayStats stats;
+    const auto start = Clock::now();
+    while (std::optional<journal::Record> record = reader.Next()) {
+        stats.recorded_time = std::chrono::microseconds{record->time_us};
+
+        if (const auto* join = std::get_if<journal::JoinCommand>(&record->command)) {
+            app.JoinGame(join->name, model::Map::Id{join->map_id});
+            ++stats.joins;
+        } else if (const auto* action = std::get_if<journal::ActionCommand>(&record->command)) {
+            // Dog::Id выдаются по порядку входа в игру, поэтому совпадают с записанными
+            if (app::PlayerPtr player = app.GetPlayers().FindByDogId(model::Dog::Id{action->dog_id})) {
+                app.SetDogAction(*player, action->direction);
+                ++stats.actions;
+            } else {
+                ++stats.skipped_actions;
+            }
+        } else if (const auto* tick = std::get_if<journal::TickCommand>(&record->command)) {
+            const auto tick_start = Clock::now();
+            app.Tick(std::chrono::milliseconds{tick->delta_ms});
+            stats.tick_time += Clock::now() - tick_start;
+            ++stats.ticks;
+        }
+    }
+    stats.elapsed = Clock::now() - start;
+    stats.state_checksum = GetStateChecksum(app.GetGame());
+    return stats;
+}
+
+uint64_t GetStateChecksum(const model::Game& game) {
+    Checksum checksum;
+    for (const model::GameSessionPtr& session : game.GetSessions()) {
+        for (const model::Dog& dog : session->GetDogs()) {
+            checksum.Add(uint64_t{*dog.GetId()});
+            checksum.Add(dog.GetPosition());
+            checksum.Add(dog.GetSpeed().x);
+            checksum.Add(dog.GetSpeed().y);
+            checksum.Add(uint64_t{dog.GetScore()});
+            for (const model::Loot& loot : dog.GetBag()) {
+                checksum.Add(uint64_t{*loot.id});
+            }
+        }
+        for (const model::Loot& loot : session->GetLoots()) {
+            checksum.Add(uint64_t{*loot.id});
+            checksum.Add(static_cast<uint64_t>(loot.type));
+            checksum.Add(loot.pos);
+        }
+    }
+    return checksum.Get();
+}
+
+} // namespace replay
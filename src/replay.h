@@ -0,0 +1,34 @@
+#pragma once
+
+#include "app.h" // для Application
+#include "journal.h" // для JournalReader
+
+#include <chrono>
+#include <cstdint>
+
+
+namespace replay {
+
+// Итоги воспроизведения журнала
+struct ReplayStats {
+    uint64_t joins = 0;
+    uint64_t actions = 0;
+    uint64_t ticks = 0;
+    uint64_t skipped_actions = 0; // действия собак, которых нет в игре - признак расхождения с записью
+    std::chrono::microseconds recorded_time{0}; // длительность записи журнала
+    std::chrono::nanoseconds elapsed{0}; // время воспроизведения
+    std::chrono::nanoseconds tick_time{0}; // из него время выполнения шагов Tick
+    uint64_t state_checksum = 0; // GetStateChecksum по окончании
+
+    double GetTicksPerSecond() const noexcept; // по времени выполнения шагов Tick
+};
+
+// Выполняет команды журнала без пауз между ними. Перед первой командой применяет seed из заголовка журнала,
+// поэтому app должно быть создано с тем же randomize_spawn_points и без игроков
+ReplayStats ReplayJournal(journal::JournalReader& reader, app::Application& app);
+
+// Контрольная сумма состояния игры (позиции, скорости, рюкзаки и очки собак, предметы на картах)
+// для сравнения записанного и воспроизведённого прогона
+uint64_t GetStateChecksum(const model::Game& game);
+
+} // namespace replay
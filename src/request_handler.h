@@ -7,6 +7,7 @@
 #include "json_loader.h"
 #include "magic_defs.h"
 #include "response_m.h"
+#include "simulation.h"
 
 #include <boost/beast/core.hpp>
 #include <boost/beast/http.hpp>
@@ -31,11 +32,9 @@ using namespace json_constants;
 
 class RequestHandler : public std::enable_shared_from_this<RequestHandler> {
 public:
-    using Strand = net::strand<net::io_context::executor_type>;
-    
-    RequestHandler(const fs::path static_root, Strand api_strand, app::Application& app)
+    RequestHandler(const fs::path static_root, simulation::Simulation& simulation, app::Application& app)
         : static_root_{fs::weakly_canonical(std::move(static_root))}
-        , api_strand_{api_strand}
+        , simulation_{simulation}
         , api_handler_{app} {
     }
 
@@ -49,17 +48,27 @@ public:
 
         try {
             if (api_handler_.IsApiRequest(req)) {
+                // чтение состояния игры по снимку последнего шага Tick - без ожидания потока симуляции
+                if (auto response = api_handler_.TryHandleFromSnapshot(req)) {
+                    return send(std::move(*response));
+                }
+
+                const bool is_stateless = api_handler_.IsStatelessRequest(req);
                 auto handle = [self = shared_from_this(), send,
                                req = std::forward<decltype(req)>(req), version, keep_alive] {
                     try {
-                        // лямбда-функция будет выполняться внутри strand
                         return send(self->api_handler_.HandleApiRequest(req));
                     } catch (const std::exception& ex) {
                         server_logger::LogServerStop(EXIT_FAILURE, "Error by request to API: "s + ex.what());
                         send(ReportServerError(version, keep_alive));
                     }
                 };
-                return net::dispatch(api_strand_, handle);
+
+                if (is_stateless) { // карты и рекорды не зависят от состояния игры - отвечаем в потоке ввода-вывода
+                    return handle();
+                }
+                // команда выполнится в потоке симуляции, ответ отправит обработчик send
+                return simulation_.Submit(std::move(handle));
             }
             // Возвращаем результат обработки запроса к файлу
             return std::visit(
@@ -75,7 +84,7 @@ public:
 
 private:
     fs::path static_root_;
-    Strand api_strand_;
+    simulation::Simulation& simulation_;
     ApiRequestHandler api_handler_;
 
     template <typename Body, typename Allocator>
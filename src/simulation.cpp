@@ -0,0 +1,60 @@
+#include "simulation.h"
+
+
+namespace simulation {
+
+// методы класса Simulation
+
+    Simulation::Simulation()
+        : strand_{net::make_strand(ioc_)}
+        , work_{net::make_work_guard(ioc_)} {
+    }
+
+    Simulation::~Simulation() {
+        Stop();
+    }
+
+    Simulation::Strand Simulation::GetStrand() const noexcept {
+        return strand_;
+    }
+
+    void Simulation::SetDrainOnTick(bool drain_on_tick) noexcept {
+        drain_on_tick_ = drain_on_tick;
+    }
+
+    void Simulation::Submit(Command command) {
+        if (commands_.Push(std::move(command)) && !drain_on_tick_) {
+            ScheduleDrain();
+        }
+    }
+
+    size_t Simulation::DrainCommands() {
+        const size_t executed = commands_.Drain();
+        // команды, поставленные во время выполнения, без шагов Ticker никто больше не заберёт
+        if (!drain_on_tick_ && commands_.GetSize() != 0) {
+            ScheduleDrain();
+        }
+        return executed;
+    }
+
+    void Simulation::Start() {
+        thread_ = std::thread([this] {
+            ioc_.run();
+        });
+    }
+
+    void Simulation::Stop() {
+        work_.reset();
+        ioc_.stop();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    void Simulation::ScheduleDrain() {
+        net::post(strand_, [this] {
+            DrainCommands();
+        });
+    }
+
+} // namespace simulation
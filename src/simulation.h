@@ -0,0 +1,52 @@
+#pragma once
+
+#include "command_queue.h"
+
+#include <boost/asio.hpp>
+
+#include <atomic>
+#include <thread>
+
+
+namespace simulation {
+
+namespace net = boost::asio;
+
+// Выделенный поток симуляции: в нём выполняются шаги Ticker и команды, изменяющие состояние игры.
+// Потоки ввода-вывода передают команды через очередь без блокировок и не ждут их выполнения -
+// ответ отправляется из команды через обработчик завершения запроса
+class Simulation {
+public:
+    using Strand = net::strand<net::io_context::executor_type>;
+    using Command = command_queue::CommandQueue::Command;
+
+    Simulation();
+    ~Simulation(); // останавливает поток, невыполненные команды отбрасываются
+
+    Simulation(const Simulation&) = delete;
+    Simulation& operator=(const Simulation&) = delete;
+
+    Strand GetStrand() const noexcept; // для Ticker - шаги выполняются в потоке симуляции
+
+    // true - команды копятся до очередного шага и выполняются через DrainCommands в его начале,
+    // false - поток симуляции будится на каждую команду (шаги по запросу /api/v1/game/tick)
+    void SetDrainOnTick(bool drain_on_tick) noexcept;
+
+    void Submit(Command command); // из любого потока
+    size_t DrainCommands(); // только в потоке симуляции
+
+    void Start();
+    void Stop(); // дожидается завершения потока
+
+private:
+    net::io_context ioc_{1};
+    Strand strand_;
+    net::executor_work_guard<net::io_context::executor_type> work_;
+    command_queue::CommandQueue commands_;
+    std::atomic<bool> drain_on_tick_{false};
+    std::thread thread_;
+
+    void ScheduleDrain();
+};
+
+} // namespace simulation
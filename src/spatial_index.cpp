@@ -0,0 +1,186 @@
+#include "spatial_index.h"
+
+
+namespace spatial_index {
+
+// методы класса SpatialGrid
+
+    void SpatialGrid::Query(geom::Point2D center, double radius, Metric metric, std::vector<uint32_t>& out) const {
+        if (positions_.empty() || radius < 0.0) {
+            return;
+        }
+        if (center.x + radius < origin_.x || center.y + radius < origin_.y) { // область левее или ниже сетки
+            return;
+        }
+
+        const size_t first_column = GetColumn(center.x - radius);
+        const size_t last_column = GetColumn(center.x + radius);
+        const size_t first_row = GetRow(center.y - radius);
+        const size_t last_row = GetRow(center.y + radius);
+
+        const size_t first_out = out.size();
+        for (size_t row = first_row; row <= last_row; ++row) {
+            for (size_t column = first_column; column <= last_column; ++column) {
+                const size_t cell = row * columns_ + column;
+                for (uint32_t i = cell_starts_[cell]; i < cell_starts_[cell + 1]; ++i) {
+                    const uint32_t item = items_[i];
+                    const double dx = std::abs(positions_[item].x - center.x);
+                    const double dy = std::abs(positions_[item].y - center.y);
+                    const bool is_visible = metric == Metric::EUCLIDEAN
+                        ? dx * dx + dy * dy <= radius * radius
+                        : dx + dy <= radius;
+                    if (is_visible) {
+                        out.push_back(item);
+                    }
+                }
+            }
+        }
+        std::sort(out.begin() + first_out, out.end()); // порядок как в исходных данных
+    }
+
+    void SpatialGrid::QueryRect(geom::Point2D min_corner, geom::Point2D max_corner, std::vector<uint32_t>& out) const {
+        if (positions_.empty() || min_corner.x > max_corner.x || min_corner.y > max_corner.y) {
+            return;
+        }
+        if (max_corner.x < origin_.x || max_corner.y < origin_.y) { // прямоугольник левее или ниже сетки
+            return;
+        }
+
+        const size_t first_column = GetColumn(min_corner.x);
+        const size_t last_column = GetColumn(max_corner.x);
+        const size_t first_row = GetRow(min_corner.y);
+        const size_t last_row = GetRow(max_corner.y);
+
+        const size_t first_out = out.size();
+        for (size_t row = first_row; row <= last_row; ++row) {
+            for (size_t column = first_column; column <= last_column; ++column) {
+                const size_t cell = row * columns_ + column;
+                for (uint32_t i = cell_starts_[cell]; i < cell_starts_[cell + 1]; ++i) {
+                    const uint32_t item = items_[i];
+                    const geom::Point2D pos = positions_[item];
+                    if (min_corner.x <= pos.x && pos.x <= max_corner.x && min_corner.y <= pos.y && pos.y <= max_corner.y) {
+                        out.push_back(item);
+                    }
+                }
+            }
+        }
+        std::sort(out.begin() + first_out, out.end());
+    }
+
+    geom::Point2D SpatialGrid::GetPosition(size_t index) const noexcept {
+        return positions_[index];
+    }
+
+    size_t SpatialGrid::GetItemsCount() const noexcept {
+        return positions_.size();
+    }
+
+    size_t SpatialGrid::GetCellsCount() const noexcept {
+        return columns_ * rows_;
+    }
+
+    // координаты вне сетки прижимаются к крайним ячейкам
+    size_t SpatialGrid::GetColumn(double x) const noexcept {
+        const double column = std::floor((x - origin_.x) / cell_size_);
+        return static_cast<size_t>(std::clamp(column, 0.0, static_cast<double>(columns_ - 1)));
+    }
+
+    size_t SpatialGrid::GetRow(double y) const noexcept {
+        const double row = std::floor((y - origin_.y) / cell_size_);
+        return static_cast<size_t>(std::clamp(row, 0.0, static_cast<double>(rows_ - 1)));
+    }
+
+// методы класса DynamicGrid
+
+    void DynamicGrid::Insert(uint32_t item, geom::Point2D pos) {
+        cells_[GetKey(GetCellCoord(pos.x), GetCellCoord(pos.y))].push_back(item);
+        ++items_count_;
+    }
+
+    bool DynamicGrid::Erase(uint32_t item, geom::Point2D pos) {
+        auto cell = cells_.find(GetKey(GetCellCoord(pos.x), GetCellCoord(pos.y)));
+        if (cell == cells_.end()) {
+            return false;
+        }
+        std::vector<uint32_t>& items = cell->second;
+        auto it = std::find(items.begin(), items.end(), item);
+        if (it == items.end()) {
+            return false;
+        }
+        *it = items.back();
+        items.pop_back();
+        if (items.empty()) { // пустые ячейки не хранятся
+            cells_.erase(cell);
+        }
+        --items_count_;
+        return true;
+    }
+
+    bool DynamicGrid::Renumber(uint32_t item, uint32_t new_item, geom::Point2D pos) {
+        auto cell = cells_.find(GetKey(GetCellCoord(pos.x), GetCellCoord(pos.y)));
+        if (cell == cells_.end()) {
+            return false;
+        }
+        auto it = std::find(cell->second.begin(), cell->second.end(), item);
+        if (it == cell->second.end()) {
+            return false;
+        }
+        *it = new_item;
+        return true;
+    }
+
+    void DynamicGrid::QueryRect(geom::Point2D min_corner, geom::Point2D max_corner, std::vector<uint32_t>& out) const {
+        if (cells_.empty() || min_corner.x > max_corner.x || min_corner.y > max_corner.y) {
+            return;
+        }
+        const int32_t first_column = GetCellCoord(min_corner.x);
+        const int32_t last_column = GetCellCoord(max_corner.x);
+        const int32_t first_row = GetCellCoord(min_corner.y);
+        const int32_t last_row = GetCellCoord(max_corner.y);
+
+        // прямоугольник больше числа непустых ячеек - быстрее перебрать их
+        const double rect_cells = (static_cast<double>(last_column) - first_column + 1) * (static_cast<double>(last_row) - first_row + 1);
+        if (rect_cells > static_cast<double>(cells_.size())) {
+            for (const auto& [key, items] : cells_) {
+                const int32_t column = static_cast<int32_t>(static_cast<uint32_t>(key >> 32));
+                const int32_t row = static_cast<int32_t>(static_cast<uint32_t>(key));
+                if (first_column <= column && column <= last_column && first_row <= row && row <= last_row) {
+                    out.insert(out.end(), items.begin(), items.end());
+                }
+            }
+            return;
+        }
+
+        for (int32_t row = first_row; row <= last_row; ++row) {
+            for (int32_t column = first_column; column <= last_column; ++column) {
+                if (auto cell = cells_.find(GetKey(column, row)); cell != cells_.end()) {
+                    out.insert(out.end(), cell->second.begin(), cell->second.end());
+                }
+            }
+        }
+    }
+
+    size_t DynamicGrid::GetItemsCount() const noexcept {
+        return items_count_;
+    }
+
+    size_t DynamicGrid::GetCellsCount() const noexcept {
+        return cells_.size();
+    }
+
+    void DynamicGrid::Clear() noexcept {
+        cells_.clear();
+        items_count_ = 0;
+    }
+
+    // координаты за пределами int32_t ячеек прижимаются к крайним ячейкам
+    int32_t DynamicGrid::GetCellCoord(double value) const noexcept {
+        const double cell = std::floor(value / cell_size_);
+        return static_cast<int32_t>(std::clamp(cell, static_cast<double>(INT32_MIN), static_cast<double>(INT32_MAX)));
+    }
+
+    DynamicGrid::CellKey DynamicGrid::GetKey(int32_t column, int32_t row) noexcept {
+        return (static_cast<CellKey>(static_cast<uint32_t>(column)) << 32) | static_cast<uint32_t>(row);
+    }
+
+} // namespace spatial_index
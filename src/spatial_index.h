@@ -0,0 +1,124 @@
+#pragma once
+
+#include "geom.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+
+namespace spatial_index {
+
+constexpr size_t MAX_CELLS_PER_ITEM = 4; // ячеек в сетке не больше, чем 4 на объект (но не меньше MIN_CELLS)
+constexpr size_t MIN_CELLS = 64;
+
+// Способ измерения расстояния до объекта
+enum class Metric {
+    EUCLIDEAN,
+    MANHATTAN // |dx| + |dy| - по дорогам, параллельным осям, путь не короче этого расстояния
+};
+
+// Равномерная сетка с ячейками не меньше cell_size: объекты ячейки лежат подряд (сортировка подсчётом),
+// поэтому построение - O(число объектов), а запрос обходит только ячейки, пересекающие область поиска
+class SpatialGrid {
+public:
+    // get_pos(i) - позиция объекта с индексом i из [0, count)
+    template <typename PositionGetter>
+    void Build(size_t count, double cell_size, PositionGetter get_pos);
+
+    // Добавляет в out индексы объектов на расстоянии не больше radius от center, по возрастанию
+    void Query(geom::Point2D center, double radius, Metric metric, std::vector<uint32_t>& out) const;
+    // Добавляет в out индексы объектов в прямоугольнике [min_corner, max_corner], по возрастанию
+    void QueryRect(geom::Point2D min_corner, geom::Point2D max_corner, std::vector<uint32_t>& out) const;
+
+    geom::Point2D GetPosition(size_t index) const noexcept;
+    size_t GetItemsCount() const noexcept;
+    size_t GetCellsCount() const noexcept;
+
+private:
+    double cell_size_ = 1.0;
+    geom::Point2D origin_; // левый нижний угол сетки
+    size_t columns_ = 0;
+    size_t rows_ = 0;
+    std::vector<uint32_t> cell_starts_; // начало объектов ячейки в items_, ячеек + 1 значений
+    std::vector<uint32_t> items_; // индексы объектов, сгруппированные по ячейкам
+    std::vector<geom::Point2D> positions_; // позиции по индексу объекта - для проверки расстояния без исходных данных
+
+    size_t GetColumn(double x) const noexcept;
+    size_t GetRow(double y) const noexcept;
+};
+
+// Равномерная сетка с добавлением и удалением объектов по одному за O(объектов в ячейке). Хранятся только
+// непустые ячейки - память O(числа объектов) без ограничения области. Позиции объектов сетка не хранит
+class DynamicGrid {
+public:
+    explicit DynamicGrid(double cell_size = 1.0) noexcept
+        : cell_size_{cell_size} {
+    }
+
+    void Insert(uint32_t item, geom::Point2D pos);
+    bool Erase(uint32_t item, geom::Point2D pos); // pos - позиция при добавлении, false - объекта нет
+    bool Renumber(uint32_t item, uint32_t new_item, geom::Point2D pos); // смена индекса объекта на месте
+
+    // Добавляет в out объекты ячеек, пересекающих прямоугольник [min_corner, max_corner], - в том числе вне него
+    void QueryRect(geom::Point2D min_corner, geom::Point2D max_corner, std::vector<uint32_t>& out) const;
+
+    size_t GetItemsCount() const noexcept;
+    size_t GetCellsCount() const noexcept;
+    void Clear() noexcept;
+
+private:
+    using CellKey = uint64_t;
+
+    double cell_size_;
+    size_t items_count_ = 0;
+    std::unordered_map<CellKey, std::vector<uint32_t>> cells_;
+
+    int32_t GetCellCoord(double value) const noexcept;
+    static CellKey GetKey(int32_t column, int32_t row) noexcept;
+};
+
+template <typename PositionGetter>
+void SpatialGrid::Build(size_t count, double cell_size, PositionGetter get_pos) {
+    positions_.resize(count);
+    geom::Point2D min_pos;
+    geom::Point2D max_pos;
+    for (size_t i = 0; i < count; ++i) {
+        const geom::Point2D pos = get_pos(i);
+        positions_[i] = pos;
+        if (i == 0) {
+            min_pos = max_pos = pos;
+        } else {
+            min_pos = {std::min(min_pos.x, pos.x), std::min(min_pos.y, pos.y)};
+            max_pos = {std::max(max_pos.x, pos.x), std::max(max_pos.y, pos.y)};
+        }
+    }
+
+    // ячейки укрупняются, если объекты разбросаны по большой площади - память сетки O(число объектов)
+    const double width = max_pos.x - min_pos.x;
+    const double height = max_pos.y - min_pos.y;
+    const double max_cells = static_cast<double>(std::max(count * MAX_CELLS_PER_ITEM, MIN_CELLS));
+    cell_size_ = std::max({cell_size, std::sqrt(width * height / max_cells), (width + height) / max_cells, 1e-6});
+    origin_ = min_pos;
+    columns_ = static_cast<size_t>(width / cell_size_) + 1;
+    rows_ = static_cast<size_t>(height / cell_size_) + 1;
+
+    cell_starts_.assign(columns_ * rows_ + 1, 0);
+    for (const geom::Point2D& pos : positions_) {
+        ++cell_starts_[GetRow(pos.y) * columns_ + GetColumn(pos.x) + 1];
+    }
+    for (size_t cell = 1; cell < cell_starts_.size(); ++cell) {
+        cell_starts_[cell] += cell_starts_[cell - 1];
+    }
+
+    items_.resize(count);
+    std::vector<uint32_t> next(cell_starts_.begin(), cell_starts_.end() - 1);
+    for (size_t i = 0; i < count; ++i) {
+        const size_t cell = GetRow(positions_[i].y) * columns_ + GetColumn(positions_[i].x);
+        items_[next[cell]++] = static_cast<uint32_t>(i);
+    }
+}
+
+} // namespace spatial_index
@@ -0,0 +1,193 @@
+#include "tick_profiler.h"
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+
+namespace tick_profiler {
+
+using namespace std::literals;
+
+std::string_view PhaseToString(Phase phase) {
+    switch (phase) {
+        case Phase::MOVE_DOGS:
+            return "moveDogs"sv;
+        case Phase::UPDATE_LOOTS:
+            return "updateLoots"sv;
+        case Phase::HANDLE_COLLISIONS:
+            return "handleCollisions"sv;
+        case Phase::UPDATE_DOGS_TIMES_AND_REMOVE:
+            return "updateDogsTimesAndRemove"sv;
+        case Phase::COMMIT_CHANGES:
+            return "commitChanges"sv;
+        case Phase::PUBLISH_SNAPSHOT:
+            return "publishSnapshot"sv;
+        default:
+            return "unknown"sv;
+    }
+}
+
+// методы класса RollingHistogram
+
+    RollingHistogram::RollingHistogram(size_t window)
+        : samples_(std::max<size_t>(window, 1), 0) {
+    }
+
+    void RollingHistogram::Add(microseconds value) {
+        const uint32_t us = static_cast<uint32_t>(std::clamp<int64_t>(value.count(), 0, std::numeric_limits<uint32_t>::max()));
+
+        if (count_ == samples_.size()) { // окно заполнено - вытесняем самое старое значение
+            const uint32_t old = samples_[next_];
+            sum_ -= old;
+            --buckets_[GetBucket(old)];
+        } else {
+            ++count_;
+        }
+
+        samples_[next_] = us;
+        sum_ += us;
+        ++buckets_[GetBucket(us)];
+        next_ = (next_ + 1) % samples_.size();
+    }
+
+    size_t RollingHistogram::GetCount() const noexcept {
+        return count_;
+    }
+
+    microseconds RollingHistogram::GetMean() const noexcept {
+        return count_ == 0 ? microseconds{0} : microseconds{static_cast<int64_t>(sum_ / count_)};
+    }
+
+    microseconds RollingHistogram::GetMax() const noexcept {
+        if (count_ == 0) {
+            return microseconds{0};
+        }
+        return microseconds{*std::max_element(samples_.begin(), samples_.begin() + count_)};
+    }
+
+    microseconds RollingHistogram::GetPercentile(double percent) const {
+        if (count_ == 0) {
+            return microseconds{0};
+        }
+
+        std::vector<uint32_t> sorted(samples_.begin(), samples_.begin() + count_);
+        const size_t rank = std::min(count_ - 1, static_cast<size_t>(percent / 100.0 * static_cast<double>(count_)));
+        std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+        return microseconds{sorted[rank]};
+    }
+
+    const std::array<uint64_t, HISTOGRAM_BUCKETS>& RollingHistogram::GetBuckets() const noexcept {
+        return buckets_;
+    }
+
+    // верхняя граница корзины (не включительно), для последней корзины - максимальное значение
+    microseconds RollingHistogram::GetBucketUpperBound(size_t bucket) noexcept {
+        if (bucket + 1 >= HISTOGRAM_BUCKETS) {
+            return microseconds{std::numeric_limits<uint32_t>::max()};
+        }
+        return microseconds{int64_t{1} << bucket};
+    }
+
+    size_t RollingHistogram::GetBucket(uint32_t value) noexcept {
+        return std::min<size_t>(std::bit_width(value), HISTOGRAM_BUCKETS - 1);
+    }
+
+// методы класса SessionProfile
+
+    SessionProfile::SessionProfile(const model::GameSession& session, size_t window)
+        : session_serial{session.GetSerial()}
+        , map_id{session.GetMap()->GetId()}
+        , phases(PHASES_COUNT, RollingHistogram(window)) {
+    }
+
+// методы класса TickProfiler
+
+    TickProfiler::TickProfiler(size_t window)
+        : window_{window}
+        , tick_signal_{window}
+        , tick_{window} {
+    }
+
+    void TickProfiler::BeginTick(const model::GameSessionPtrs& sessions, const std::vector<size_t>& active_sessions) {
+        SyncSessions(sessions);
+        tick_sessions_.assign(active_sessions.begin(), active_sessions.end());
+    }
+
+    void TickProfiler::SyncSessions(const model::GameSessionPtrs& sessions) {
+        // Сессии добавляются в конец с растущим номером и удаляются без смены порядка, поэтому состав не изменился,
+        // если совпадают число сессий и номер последней: новая сессия сменила бы последний номер, удаление - число
+        if (sessions_.size() == sessions.size()
+            && (sessions.empty() || sessions_.back().session_serial == sessions.back()->GetSerial())) {
+            return;
+        }
+
+        // профили и сессии упорядочены по номеру - сливаем, профили удалённых сессий отбрасываются
+        constexpr size_t REMOVED = std::numeric_limits<size_t>::max();
+        std::vector<size_t> new_index(sessions_.size(), REMOVED);
+        std::vector<SessionProfile> synced;
+        synced.reserve(sessions.size());
+        size_t profile = 0;
+        for (const model::GameSessionPtr& session : sessions) {
+            const uint64_t serial = session->GetSerial();
+            while (profile < sessions_.size() && sessions_[profile].session_serial < serial) {
+                ++profile;
+            }
+            if (profile < sessions_.size() && sessions_[profile].session_serial == serial) {
+                new_index[profile] = synced.size();
+                synced.push_back(std::move(sessions_[profile++]));
+            } else {
+                synced.emplace_back(*session, window_);
+            }
+        }
+        sessions_ = std::move(synced);
+
+        // сессии шага сохраняют порядок - переводим их индексы, удалённые выбывают
+        size_t kept = 0;
+        for (const size_t index : tick_sessions_) {
+            if (index < new_index.size() && new_index[index] != REMOVED) {
+                tick_sessions_[kept++] = new_index[index];
+            }
+        }
+        tick_sessions_.resize(kept);
+    }
+
+    void TickProfiler::AddSessionTime(size_t session_index, Phase phase, Clock::duration duration) noexcept {
+        sessions_[session_index].current[static_cast<size_t>(phase)] += std::chrono::duration_cast<microseconds>(duration);
+    }
+
+    void TickProfiler::EndTick(Clock::duration signal_duration, Clock::duration tick_duration) {
+        // сессия, усыплённая посреди шага, получает значение за этот шаг, а потом не получает, пока спит
+        for (const size_t index : tick_sessions_) {
+            SessionProfile& session = sessions_[index];
+            for (size_t phase = 0; phase < PHASES_COUNT; ++phase) {
+                session.phases[phase].Add(session.current[phase]);
+                session.current[phase] = microseconds{0};
+            }
+        }
+        tick_signal_.Add(std::chrono::duration_cast<microseconds>(signal_duration));
+        tick_.Add(std::chrono::duration_cast<microseconds>(tick_duration));
+        ++ticks_count_;
+    }
+
+    size_t TickProfiler::GetWindow() const noexcept {
+        return window_;
+    }
+
+    uint64_t TickProfiler::GetTicksCount() const noexcept {
+        return ticks_count_;
+    }
+
+    const std::vector<SessionProfile>& TickProfiler::GetSessions() const noexcept {
+        return sessions_;
+    }
+
+    const RollingHistogram& TickProfiler::GetTickSignal() const noexcept {
+        return tick_signal_;
+    }
+
+    const RollingHistogram& TickProfiler::GetTick() const noexcept {
+        return tick_;
+    }
+
+} // namespace tick_profiler
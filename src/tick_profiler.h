@@ -0,0 +1,127 @@
+#pragma once
+
+#include "model.h" // для GameSession и Map::Id профилируемых сессий
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+
+namespace tick_profiler {
+
+using Clock = std::chrono::steady_clock;
+using microseconds = std::chrono::microseconds;
+
+constexpr size_t DEFAULT_PROFILE_WINDOW = 1000; // число последних шагов Tick в скользящем окне
+constexpr size_t HISTOGRAM_BUCKETS = 21; // корзины по степеням двойки: 0, [1, 2), [2, 4), ... , [2^19, inf) мкс
+
+// Фазы Application::Tick, время которых измеряется отдельно для каждой сессии
+enum class Phase {
+    MOVE_DOGS,
+    UPDATE_LOOTS,
+    HANDLE_COLLISIONS,
+    UPDATE_DOGS_TIMES_AND_REMOVE,
+    COMMIT_CHANGES,
+    PUBLISH_SNAPSHOT
+};
+
+constexpr size_t PHASES_COUNT = 6;
+
+std::string_view PhaseToString(Phase phase);
+
+// Гистограмма длительностей за последние window измерений: старые значения вытесняются новыми
+class RollingHistogram {
+public:
+    explicit RollingHistogram(size_t window);
+
+    void Add(microseconds value);
+
+    size_t GetCount() const noexcept; // число значений в окне
+    microseconds GetMean() const noexcept;
+    microseconds GetMax() const noexcept;
+    microseconds GetPercentile(double percent) const; // точное значение по окну - для редких запросов
+    const std::array<uint64_t, HISTOGRAM_BUCKETS>& GetBuckets() const noexcept;
+
+    static microseconds GetBucketUpperBound(size_t bucket) noexcept;
+
+private:
+    std::vector<uint32_t> samples_; // кольцевой буфер значений в мкс
+    size_t next_ = 0; // позиция для следующего значения
+    size_t count_ = 0;
+    uint64_t sum_ = 0;
+    std::array<uint64_t, HISTOGRAM_BUCKETS> buckets_{};
+
+    static size_t GetBucket(uint32_t value) noexcept;
+};
+
+// Профиль одной игровой сессии - по гистограмме на каждую фазу
+struct SessionProfile {
+    explicit SessionProfile(const model::GameSession& session, size_t window);
+
+    uint64_t session_serial; // GameSession::GetSerial() - у карты может быть несколько экземпляров сессии
+    model::Map::Id map_id;
+    std::array<microseconds, PHASES_COUNT> current{}; // накопленное время фаз текущего шага
+    std::vector<RollingHistogram> phases;
+};
+
+// Профилировщик шага Tick: время фаз по сессиям, время подписчиков tick_signal_ и всего шага.
+// AddSessionTime для разных сессий можно вызывать параллельно, остальные методы - из потока Tick
+class TickProfiler {
+public:
+    explicit TickProfiler(size_t window = DEFAULT_PROFILE_WINDOW);
+
+    // Выравнивает профили по списку сессий. В шаге участвуют сессии active_sessions (индексы в sessions) -
+    // только их время попадает в гистограммы, усыплённые сессии не получают нулевых значений
+    void BeginTick(const model::GameSessionPtrs& sessions, const std::vector<size_t>& active_sessions);
+    // Выравнивает профили по списку сессий с сохранением времени текущего шага - вызывается и после
+    // удаления сессий посреди шага, чтобы индексы следующих фаз указывали на свои профили
+    void SyncSessions(const model::GameSessionPtrs& sessions);
+    void AddSessionTime(size_t session_index, Phase phase, Clock::duration duration) noexcept;
+    void EndTick(Clock::duration signal_duration, Clock::duration tick_duration); // O(сессий шага)
+
+    size_t GetWindow() const noexcept;
+    uint64_t GetTicksCount() const noexcept;
+    const std::vector<SessionProfile>& GetSessions() const noexcept;
+    const RollingHistogram& GetTickSignal() const noexcept;
+    const RollingHistogram& GetTick() const noexcept;
+
+private:
+    size_t window_;
+    uint64_t ticks_count_ = 0;
+    std::vector<SessionProfile> sessions_; // индексы совпадают с Game::GetSessions()
+    std::vector<size_t> tick_sessions_; // индексы sessions_ участвующих в текущем шаге сессий
+    RollingHistogram tick_signal_;
+    RollingHistogram tick_;
+};
+
+// Измеряет время от создания до разрушения и добавляет его к фазе сессии. При profiler == nullptr ничего не делает
+class ScopedPhaseTimer {
+public:
+    ScopedPhaseTimer(TickProfiler* profiler, size_t session_index, Phase phase) noexcept
+        : profiler_{profiler}
+        , session_index_{session_index}
+        , phase_{phase} {
+        if (profiler_) {
+            start_ = Clock::now();
+        }
+    }
+
+    ~ScopedPhaseTimer() {
+        if (profiler_) {
+            profiler_->AddSessionTime(session_index_, phase_, Clock::now() - start_);
+        }
+    }
+
+    ScopedPhaseTimer(const ScopedPhaseTimer&) = delete;
+    ScopedPhaseTimer& operator=(const ScopedPhaseTimer&) = delete;
+
+private:
+    TickProfiler* profiler_;
+    size_t session_index_;
+    Phase phase_;
+    Clock::time_point start_;
+};
+
+} // namespace tick_profiler
@@ -1,5 +1,7 @@
 #include "ticker.h"
 
+#include <algorithm>
+
 
 namespace ticker {
 
@@ -7,12 +9,18 @@ namespace ticker {
     void Ticker::Start() {
         net::dispatch(strand_, [self = shared_from_this()] {
             self->last_tick_ = Clock::now(); // last_tick_
+            self->deadline_ = self->last_tick_ + self->period_;
             self->ScheduleTick();
         });
     }
 
+    TickerStats Ticker::GetStats() const {
+        std::lock_guard lock{stats_mutex_};
+        return stats_;
+    }
+
     void Ticker::ScheduleTick() {
-        timer_.expires_after(period_);
+        timer_.expires_at(deadline_);
         timer_.async_wait([self = shared_from_this()](sys::error_code ec) {
             self->OnTick(ec);
         });
@@ -21,13 +29,65 @@ namespace ticker {
     void Ticker::OnTick(sys::error_code ec) {
         using namespace std::chrono;
 
-        if (!ec) {
-            auto this_tick = Clock::now();
-            auto delta = duration_cast<milliseconds>(this_tick - last_tick_);
-            last_tick_ = this_tick;
-            handler_(delta);
-            ScheduleTick();
+        if (ec) {
+            return;
+        }
+
+        const auto this_tick = Clock::now();
+        const auto interval = this_tick - last_tick_;
+        const auto lateness = std::max(Clock::duration::zero(), this_tick - deadline_);
+        const uint64_t missed_periods = static_cast<uint64_t>(lateness / period_); // целые периоды, прошедшие после deadline_
+        last_tick_ = this_tick;
+
+        uint64_t steps = 1;
+        uint64_t dropped_steps = 0;
+        if (options_.mode == TickMode::RELATIVE) {
+            handler_(duration_cast<milliseconds>(interval));
+        } else if (options_.catch_up == CatchUpPolicy::SUBSTEPS) {
+            const uint64_t due_steps = missed_periods + 1;
+            steps = std::min<uint64_t>(due_steps, std::max(1u, options_.max_substeps));
+            dropped_steps = due_steps - steps;
+            for (uint64_t i = 0; i < steps; ++i) {
+                handler_(period_);
+            }
+        } else { // CatchUpPolicy::COALESCE
+            handler_(period_ * (missed_periods + 1));
         }
+
+        const auto handler_end = Clock::now();
+        UpdateStats(lateness, interval, handler_end - this_tick, steps, missed_periods, dropped_steps);
+
+        if (options_.mode == TickMode::RELATIVE) {
+            deadline_ = handler_end + period_;
+        } else { // следующий момент остаётся на сетке start + n * period
+            deadline_ += period_ * (missed_periods + 1);
+        }
+        ScheduleTick();
+    }
+
+    void Ticker::UpdateStats(Clock::duration lateness, Clock::duration interval, Clock::duration handler_time,
+                             uint64_t steps, uint64_t missed_periods, uint64_t dropped_steps) {
+        using namespace std::chrono;
+
+        const auto lateness_us = duration_cast<microseconds>(lateness);
+        const auto jitter_us = duration_cast<microseconds>(interval > period_ ? interval - period_ : period_ - interval);
+        const auto handler_us = duration_cast<microseconds>(handler_time);
+
+        const auto bucket = std::upper_bound(LATENESS_BUCKETS_MS.begin(), LATENESS_BUCKETS_MS.end(),
+                                             duration_cast<milliseconds>(lateness).count());
+
+        std::lock_guard lock{stats_mutex_};
+        ++stats_.ticks;
+        stats_.steps += steps;
+        stats_.overruns += missed_periods > 0 ? 1 : 0;
+        stats_.dropped_steps += dropped_steps;
+        stats_.total_lateness += lateness_us;
+        stats_.max_lateness = std::max(stats_.max_lateness, lateness_us);
+        stats_.total_jitter += jitter_us;
+        stats_.max_jitter = std::max(stats_.max_jitter, jitter_us);
+        stats_.total_handler_time += handler_us;
+        stats_.max_handler_time = std::max(stats_.max_handler_time, handler_us);
+        ++stats_.lateness_histogram[bucket - LATENESS_BUCKETS_MS.begin()];
     }
 
-} // namespace ticker
\ No newline at end of file
+} // namespace ticker
@@ -1,12 +1,15 @@
-#pragma once 
+#pragma once
 
 #include <boost/asio.hpp>
 #include <boost/asio/steady_timer.hpp>
 #include <boost/system/error_code.hpp>
 
+#include <array>
 #include <chrono>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <utility>
 
 
@@ -15,31 +18,81 @@ namespace ticker {
 namespace net = boost::asio;
 namespace sys = boost::system;
 
+using microseconds = std::chrono::microseconds;
+
+// верхние границы корзин гистограммы опозданий срабатывания (последняя корзина - всё, что больше)
+constexpr std::array<int, 7> LATENESS_BUCKETS_MS = {1, 2, 5, 10, 20, 50, 100};
+
+enum class TickMode {
+    RELATIVE, // следующий шаг через period после завершения обработчика (время обработчика накапливается как дрейф)
+    FIXED_STEP // шаги по абсолютным моментам start + n * period, без дрейфа
+};
+
+// что делать, если к моменту срабатывания прошло несколько периодов (только для TickMode::FIXED_STEP)
+enum class CatchUpPolicy {
+    SUBSTEPS, // догнать отдельными шагами по period, но не более max_substeps за раз, остальные отбросить
+    COALESCE // выполнить один шаг на всё пропущенное время
+};
+
+struct TickerOptions {
+    TickMode mode = TickMode::RELATIVE;
+    CatchUpPolicy catch_up = CatchUpPolicy::SUBSTEPS;
+    unsigned max_substeps = 5;
+};
+
+// Статистика срабатываний Ticker с момента запуска
+struct TickerStats {
+    uint64_t ticks = 0; // срабатывания таймера
+    uint64_t steps = 0; // вызовы обработчика (с учётом догоняющих шагов)
+    uint64_t overruns = 0; // срабатывания с опозданием на целый период и более
+    uint64_t dropped_steps = 0; // шаги, отброшенные из-за ограничения max_substeps
+
+    microseconds total_lateness{0}; // опоздание срабатывания относительно запланированного момента
+    microseconds max_lateness{0};
+    microseconds total_jitter{0}; // отклонение интервала между срабатываниями от period
+    microseconds max_jitter{0};
+    microseconds total_handler_time{0}; // время выполнения обработчика за одно срабатывание
+    microseconds max_handler_time{0};
+
+    std::array<uint64_t, LATENESS_BUCKETS_MS.size() + 1> lateness_histogram{};
+};
+
 class Ticker : public std::enable_shared_from_this<Ticker> {
 public:
     using Strand = net::strand<net::io_context::executor_type>;
     using Handler = std::function<void(std::chrono::milliseconds delta)>;
 
     // Функция handler будет вызываться внутри strand с интервалом period
-    Ticker(Strand strand, std::chrono::milliseconds period, Handler handler)
+    Ticker(Strand strand, std::chrono::milliseconds period, Handler handler, TickerOptions options = {})
         : strand_{strand}
         , period_{period}
-        , handler_{std::move(handler)} {
+        , handler_{std::move(handler)}
+        , options_{options} {
     }
 
     void Start();
 
+    TickerStats GetStats() const; // можно вызывать из любого потока
+
 private:
     void ScheduleTick();
     void OnTick(sys::error_code ec);
 
     using Clock = std::chrono::steady_clock;
 
+    void UpdateStats(Clock::duration lateness, Clock::duration interval, Clock::duration handler_time,
+                     uint64_t steps, uint64_t missed_periods, uint64_t dropped_steps);
+
     Strand strand_;
     std::chrono::milliseconds period_;
     net::steady_timer timer_{strand_};
     Handler handler_;
+    TickerOptions options_;
     std::chrono::steady_clock::time_point last_tick_;
+    std::chrono::steady_clock::time_point deadline_; // запланированный момент следующего срабатывания
+
+    mutable std::mutex stats_mutex_;
+    TickerStats stats_;
 };
 
 } // namespace ticker
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+
+namespace timing_wheel {
+
+// Иерархическое колесо таймеров: уровень level состоит из SLOTS слотов по 64^level единиц времени.
+// Таймер попадает на уровень старшего разряда, в котором его срок отличается от текущего времени,
+// и при наступлении своего слота спускается на нижние уровни. Advance обходит только непустые слоты
+// (по битовым маскам), поэтому его стоимость зависит от числа сработавших таймеров, а не от их общего числа.
+//
+// Перенос срока на более поздний не трогает слоты: таймер остаётся на месте и при наступлении старого
+// срока перекладывается под новый. Так частое продление (собака снова двигается) стоит O(1) без удаления
+template <typename Key, typename Hash = std::hash<Key>>
+class TimingWheel {
+public:
+    using Time = int64_t;
+
+    explicit TimingWheel(Time now = 0) noexcept
+        : now_{now} {
+    }
+
+    // Ставит таймер key на момент deadline или переносит уже поставленный. Срок не позже текущего
+    // времени срабатывает при следующем вызове Advance
+    void Schedule(const Key& key, Time deadline) {
+        auto [it, inserted] = timers_.try_emplace(key, Timer{deadline, deadline});
+        if (!inserted) {
+            it->second.deadline = deadline;
+            if (deadline >= it->second.slot_deadline) { // продление - таймер переложится при наступлении старого срока
+                return;
+            }
+            it->second.slot_deadline = deadline; // прежняя запись в слоте становится недействительной
+        }
+        Insert(key, deadline);
+    }
+
+    bool Remove(const Key& key) {
+        return timers_.erase(key) != 0; // записи в слотах отбрасываются при обходе
+    }
+
+    std::optional<Time> GetDeadline(const Key& key) const {
+        if (auto it = timers_.find(key); it != timers_.end()) {
+            return it->second.deadline;
+        }
+        return std::nullopt;
+    }
+
+    size_t GetSize() const noexcept {
+        return timers_.size();
+    }
+
+    Time GetTime() const noexcept {
+        return now_;
+    }
+
+    // Продвигает время до now и добавляет в expired ключи таймеров со сроком не позже now
+    void Advance(Time now, std::vector<Key>& expired) {
+        std::vector<Entry> due = std::exchange(due_, {});
+        for (const Entry& entry : due) {
+            HandleEntry(entry, expired);
+        }
+
+        while (true) {
+            const std::optional<Time> next = GetNextSlotTime();
+            if (!next || *next > now) {
+                break;
+            }
+            now_ = *next;
+
+            // сначала старшие уровни: их таймеры могут спуститься в слоты младших уровней с тем же временем
+            for (size_t level = LEVELS; level-- > 0;) {
+                const unsigned shift = SLOT_BITS * static_cast<unsigned>(level);
+                if ((static_cast<uint64_t>(now_) & LowMask(shift)) != 0) {
+                    continue;
+                }
+                const size_t slot = (static_cast<uint64_t>(now_) >> shift) & (SLOTS - 1);
+                if ((occupied_[level] & (uint64_t{1} << slot)) == 0) {
+                    continue;
+                }
+
+                occupied_[level] &= ~(uint64_t{1} << slot);
+                std::vector<Entry> entries = std::exchange(slots_[level][slot], {});
+                for (const Entry& entry : entries) {
+                    HandleEntry(entry, expired);
+                }
+            }
+        }
+
+        if (now > now_) {
+            now_ = now;
+        }
+    }
+
+private:
+    static constexpr unsigned SLOT_BITS = 6;
+    static constexpr size_t SLOTS = size_t{1} << SLOT_BITS; // по числу бит в маске occupied_
+    static constexpr size_t LEVELS = (64 + SLOT_BITS - 1) / SLOT_BITS; // покрывают весь диапазон Time
+
+    struct Timer {
+        Time deadline; // актуальный срок
+        Time slot_deadline; // срок, под который таймер лежит в слоте
+    };
+
+    struct Entry {
+        Key key;
+        Time slot_deadline;
+    };
+
+    Time now_;
+    std::unordered_map<Key, Timer, Hash> timers_;
+    std::array<std::array<std::vector<Entry>, SLOTS>, LEVELS> slots_;
+    std::array<uint64_t, LEVELS> occupied_{}; // битовые маски непустых слотов по уровням
+    std::vector<Entry> due_; // таймеры, поставленные на уже наступивший момент
+
+    static uint64_t LowMask(unsigned bits) noexcept {
+        return bits >= 64 ? ~uint64_t{0} : (uint64_t{1} << bits) - 1;
+    }
+
+    void Insert(const Key& key, Time deadline) {
+        if (deadline <= now_) {
+            due_.push_back({key, deadline});
+            return;
+        }
+
+        // уровень старшего отличающегося разряда: выше него срок и текущее время совпадают
+        const uint64_t diff = static_cast<uint64_t>(deadline) ^ static_cast<uint64_t>(now_);
+        const size_t level = (std::bit_width(diff) - 1) / SLOT_BITS;
+        const size_t slot = (static_cast<uint64_t>(deadline) >> (SLOT_BITS * level)) & (SLOTS - 1);
+        slots_[level][slot].push_back({key, deadline});
+        occupied_[level] |= uint64_t{1} << slot;
+    }
+
+    void HandleEntry(const Entry& entry, std::vector<Key>& expired) {
+        auto it = timers_.find(entry.key);
+        if (it == timers_.end() || it->second.slot_deadline != entry.slot_deadline) { // удалён или перенесён на более ранний срок
+            return;
+        }
+
+        if (it->second.deadline <= now_) {
+            expired.push_back(entry.key);
+            timers_.erase(it);
+        } else { // срок продлён - перекладываем
+            it->second.slot_deadline = it->second.deadline;
+            Insert(entry.key, it->second.deadline);
+        }
+    }
+
+    // Ближайший момент, когда нужно обработать какой-либо слот. Все занятые слоты уровня лежат
+    // правее текущей позиции на этом уровне, поэтому достаточно младшего занятого
+    std::optional<Time> GetNextSlotTime() const noexcept {
+        std::optional<Time> result;
+        for (size_t level = 0; level < LEVELS; ++level) {
+            if (occupied_[level] == 0) {
+                continue;
+            }
+            const unsigned shift = SLOT_BITS * static_cast<unsigned>(level);
+            const uint64_t slot = static_cast<uint64_t>(std::countr_zero(occupied_[level]));
+            const uint64_t base = static_cast<uint64_t>(now_) & ~LowMask(shift + SLOT_BITS);
+            const Time time = static_cast<Time>(base | (slot << shift));
+            if (!result || time < *result) {
+                result = time;
+            }
+        }
+        return result;
+    }
+};
+
+} // namespace timing_wheel
@@ -0,0 +1,111 @@
+#include "worker_pool.h"
+
+#include <algorithm>
+
+
+namespace worker_pool {
+
+// методы класса WorkerPool
+
+    WorkerPool::WorkerPool(unsigned threads_count) {
+        threads_count = std::max(1u, threads_count);
+        workers_.reserve(threads_count - 1);
+        for (unsigned i = 1; i < threads_count; ++i) { // вызывающий поток тоже выполняет задачи
+            workers_.emplace_back([this] {
+                WorkerLoop();
+            });
+        }
+    }
+
+    WorkerPool::~WorkerPool() {
+        {
+            std::lock_guard lock{mutex_};
+            stop_ = true;
+        }
+        start_cv_.notify_all();
+        // дожидаемся потоков явно - до уничтожения mutex_ и условных переменных, которые они используют
+        workers_.clear();
+    }
+
+    void WorkerPool::ParallelFor(size_t count, const Task& task) {
+        if (count == 0) {
+            return;
+        }
+
+        if (workers_.empty() || count == 1) { // нечего распараллеливать
+            for (size_t i = 0; i < count; ++i) {
+                task(i);
+            }
+            return;
+        }
+
+        {
+            std::lock_guard lock{mutex_};
+            task_ = &task;
+            count_ = count;
+            next_index_ = 0;
+            error_ = nullptr;
+            pending_workers_ = workers_.size();
+            ++generation_;
+        }
+        start_cv_.notify_all();
+
+        RunTasks(task, count);
+
+        std::unique_lock lock{mutex_};
+        done_cv_.wait(lock, [this] {
+            return pending_workers_ == 0;
+        });
+        task_ = nullptr;
+
+        if (error_) {
+            std::rethrow_exception(std::exchange(error_, nullptr));
+        }
+    }
+
+    unsigned WorkerPool::GetThreadsCount() const noexcept {
+        return static_cast<unsigned>(workers_.size()) + 1;
+    }
+
+    void WorkerPool::WorkerLoop() {
+        size_t seen_generation = 0;
+        while (true) {
+            const Task* task = nullptr;
+            size_t count = 0;
+            {
+                std::unique_lock lock{mutex_};
+                start_cv_.wait(lock, [this, seen_generation] {
+                    return stop_ || generation_ != seen_generation;
+                });
+                if (stop_) {
+                    return;
+                }
+                seen_generation = generation_;
+                task = task_;
+                count = count_;
+            }
+
+            RunTasks(*task, count);
+
+            {
+                std::lock_guard lock{mutex_};
+                --pending_workers_;
+            }
+            done_cv_.notify_one();
+        }
+    }
+
+    void WorkerPool::RunTasks(const Task& task, size_t count) {
+        for (size_t i = next_index_.fetch_add(1); i < count; i = next_index_.fetch_add(1)) {
+            try {
+                task(i);
+            } catch (...) {
+                std::lock_guard lock{mutex_};
+                if (!error_) {
+                    error_ = std::current_exception();
+                }
+            }
+        }
+    }
+
+} // namespace worker_pool
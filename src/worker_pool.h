@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+namespace worker_pool {
+
+// Пул потоков для параллельного выполнения независимых задач внутри одного шага Tick.
+// Задачи распределяются динамически: каждый освободившийся поток забирает следующий
+// ещё не взятый индекс (self-scheduling), поэтому длинная задача не задерживает остальные.
+class WorkerPool {
+public:
+    using Task = std::function<void(size_t index)>;
+
+    // threads_count - общее число потоков, включая вызывающий ParallelFor
+    explicit WorkerPool(unsigned threads_count);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Выполняет task(i) для всех i из [0, count) и возвращает управление только после
+    // завершения всех задач (барьер). Первое исключение из задач пробрасывается вызывающему.
+    void ParallelFor(size_t count, const Task& task);
+
+    unsigned GetThreadsCount() const noexcept;
+
+private:
+    std::mutex mutex_;
+    std::condition_variable start_cv_; // уведомление рабочих потоков о новом задании
+    std::condition_variable done_cv_; // уведомление вызывающего потока о завершении задания
+
+    const Task* task_ = nullptr;
+    size_t count_ = 0;
+    std::atomic<size_t> next_index_{0}; // следующий свободный индекс задачи
+    size_t generation_ = 0; // номер текущего задания
+    size_t pending_workers_ = 0; // рабочие потоки, ещё не закончившие текущее задание
+    bool stop_ = false;
+    std::exception_ptr error_;
+
+    std::vector<std::jthread> workers_; // объявлены последними - уничтожаются первыми, пока mutex_ и условные переменные живы
+
+    void WorkerLoop();
+    void RunTasks(const Task& task, size_t count);
+};
+
+} // namespace worker_pool
@@ -5,6 +5,7 @@
 #include <catch2/matchers/catch_matchers_templated.hpp> // для собственного матчера для IsEventEqual
 
 #include <sstream>
+#include <random>
 #include <vector>
 #include <cmath>
  
@@ -203,4 +204,186 @@ TEST_CASE("FindGatherEvents detects all collision in start point", "[FindGatherE
     for (size_t i = 0; i < events.size(); ++i) {
         CHECK_THAT(events[i], IsEventEqual(expected_events[i]));
     }
-}
\ No newline at end of file
+}
+namespace {
+
+// Проверка всех пар собирателей и предметов - образец для сравнения
+std::vector<GatheringEvent> FindGatherEventsExhaustive(const std::vector<Item>& items, const std::vector<Gatherer>& gatherers) {
+    std::vector<GatheringEvent> events;
+    for (size_t g = 0; g < gatherers.size(); ++g) {
+        const Gatherer& gatherer = gatherers[g];
+        if (gatherer.start_pos.x == gatherer.end_pos.x && gatherer.start_pos.y == gatherer.end_pos.y) {
+            continue;
+        }
+        for (size_t i = 0; i < items.size(); ++i) {
+            const CollectionResult result = TryCollectPoint(gatherer.start_pos, gatherer.end_pos, items[i].position);
+            if (result.IsCollected(gatherer.width + items[i].width)) {
+                events.push_back({i, g, result.sq_distance, result.proj_ratio});
+            }
+        }
+    }
+    std::sort(events.begin(), events.end(), [](const GatheringEvent& lhs, const GatheringEvent& rhs) {
+        return lhs.time < rhs.time;
+    });
+    return events;
+}
+
+} // namespace
+
+TEST_CASE("FindGatherEvents gives the same events as the exhaustive search", "[FindGatherEvents]") {
+    std::mt19937_64 random(11);
+    std::uniform_int_distribution<int> line(0, 10);
+    std::uniform_real_distribution<double> along(0.0, 100.0);
+    std::uniform_real_distribution<double> across(-0.5, 0.5);
+    std::uniform_real_distribution<double> step(-3.0, 3.0);
+
+    // предметы вдоль дорог решётки с шагом 10, часть - в одной точке, собиратели ходят вдоль дорог и стоят на месте
+    std::vector<Item> items;
+    for (int i = 0; i < 3000; ++i) {
+        const double coord = i % 10 == 0 ? 50.0 : along(random);
+        const double offset = i % 7 == 0 ? 0.0 : across(random);
+        const bool horizontal = i % 2 == 0;
+        const double road = line(random) * 10.0;
+        items.push_back({horizontal ? geom::Point2D{coord, road + offset} : geom::Point2D{road + offset, coord}, i % 3 == 0 ? 0.25 : 0.0});
+    }
+    std::vector<Gatherer> gatherers;
+    for (int g = 0; g < 1000; ++g) {
+        const double road = line(random) * 10.0;
+        const double start = along(random);
+        const double end = g % 5 == 0 ? start : start + step(random);
+        const bool horizontal = g % 2 == 0;
+        gatherers.push_back(horizontal
+            ? Gatherer{{start, road}, {end, road}, 0.3}
+            : Gatherer{{road, start}, {road, end}, 0.3});
+    }
+    gatherers.push_back({{0.0, 0.0}, {100.0, 100.0}, 0.3}); // путь не вдоль осей - прямоугольник поиска во всю карту
+
+    const std::vector<GatheringEvent> expected = FindGatherEventsExhaustive(items, gatherers);
+    const std::vector<GatheringEvent> events = FindGatherEvents(ModelItemGathererProvider(items, gatherers));
+    REQUIRE(expected.size() > 100);
+    REQUIRE(events.size() == expected.size());
+    for (size_t i = 0; i < events.size(); ++i) {
+        CHECK(events[i].gatherer_id == expected[i].gatherer_id);
+        CHECK(events[i].item_id == expected[i].item_id);
+        CHECK(events[i].sq_distance == expected[i].sq_distance);
+        CHECK(events[i].time == expected[i].time);
+    }
+}
+
+TEST_CASE("FindGatherEvents reads items and gatherers from spans without a provider", "[FindGatherEvents]") {
+    const std::vector<Item> items = {
+        {{2.0, 5.0}, 1.0},
+        {{0.0, 2.0}, 0.5},
+        {{-3.0, 4.0}, 2.0}
+    };
+    const std::vector<Gatherer> gatherers = {
+        {{0.0, 0.0}, {0.0, 5.0}, 1.0},
+        {{1.0, 1.0}, {1.0, 1.0}, 1.0} // стоит на месте - событий нет
+    };
+
+    const std::vector<GatheringEvent> expected_events = FindGatherEvents(ModelItemGathererProvider(items, gatherers));
+    const std::vector<GatheringEvent> events = FindGatherEvents(items, gatherers);
+    REQUIRE(events.size() == 3);
+    REQUIRE(events.size() == expected_events.size());
+    for (size_t i = 0; i < events.size(); ++i) {
+        CHECK_THAT(events[i], IsEventEqual(expected_events[i]));
+    }
+    CHECK(FindGatherEvents(std::span<const Item>{}, gatherers).empty());
+}
+
+TEST_CASE("FindGatherEvents with candidates from the caller's index", "[FindGatherEvents]") {
+    std::mt19937_64 random(13);
+    std::uniform_real_distribution<double> coord(0.0, 20.0);
+    std::vector<Item> items;
+    for (int i = 0; i < 500; ++i) {
+        items.push_back({{coord(random), std::round(coord(random))}, 0.0});
+    }
+    std::vector<Gatherer> gatherers;
+    for (int g = 0; g < 50; ++g) {
+        const double y = std::round(coord(random));
+        const double x = coord(random);
+        gatherers.push_back({{x, y}, {x + (g % 2 == 0 ? 1.5 : -1.5), y}, 0.3});
+    }
+
+    // кандидаты - предметы рядом с путём в обратном порядке: функция сама упорядочивает их
+    const auto find_candidates = [&items](const Gatherer& gatherer, std::vector<uint32_t>& out) {
+        const GatherBounds bounds = GetGatherBounds(gatherer, 0.0);
+        for (uint32_t i = static_cast<uint32_t>(items.size()); i-- > 0;) {
+            const geom::Point2D pos = items[i].position;
+            if (bounds.min_corner.x <= pos.x && pos.x <= bounds.max_corner.x && bounds.min_corner.y <= pos.y && pos.y <= bounds.max_corner.y) {
+                out.push_back(i);
+            }
+        }
+    };
+    const auto get_item = [&items](uint32_t i) {
+        return items[i];
+    };
+
+    const std::vector<GatheringEvent> expected = FindGatherEventsExhaustive(items, gatherers);
+    const std::vector<GatheringEvent> events = FindGatherEvents(std::span<const Gatherer>(gatherers), find_candidates, get_item);
+    REQUIRE_FALSE(expected.empty());
+    REQUIRE(events.size() == expected.size());
+    for (size_t i = 0; i < events.size(); ++i) {
+        CHECK(events[i].gatherer_id == expected[i].gatherer_id);
+        CHECK(events[i].item_id == expected[i].item_id);
+        CHECK(events[i].time == expected[i].time);
+    }
+
+    // все предметы - кандидаты: больше GATHER_KERNEL_MIN_CANDIDATES, проверка идёт пакетом через FindGatherCandidates
+    static_assert(GATHER_KERNEL_MIN_CANDIDATES < 500);
+    const auto all_items = [&items](const Gatherer&, std::vector<uint32_t>& out) {
+        for (uint32_t i = static_cast<uint32_t>(items.size()); i-- > 0;) {
+            out.push_back(i);
+        }
+    };
+    const std::vector<GatheringEvent> packed_events = FindGatherEvents(std::span<const Gatherer>(gatherers), all_items, get_item);
+    REQUIRE(packed_events.size() == expected.size());
+    for (size_t i = 0; i < packed_events.size(); ++i) {
+        CHECK(packed_events[i].gatherer_id == expected[i].gatherer_id);
+        CHECK(packed_events[i].item_id == expected[i].item_id);
+        CHECK(packed_events[i].sq_distance == expected[i].sq_distance);
+        CHECK(packed_events[i].time == expected[i].time);
+    }
+}
+
+TEST_CASE("FindGatherCandidates marks every collected item with each supported kernel", "[FindGatherCandidates]") {
+    std::mt19937_64 random(5);
+    std::uniform_real_distribution<double> coord(-5.0, 5.0);
+    std::uniform_real_distribution<double> width(0.0, 0.5);
+
+    PackedItems items;
+    for (int i = 0; i < 203; ++i) { // не кратно ни 2, ни 4 - проверяется и скалярный остаток
+        items.x.push_back(coord(random));
+        items.y.push_back(i % 5 == 0 ? 0.0 : coord(random));
+        items.width.push_back(width(random));
+    }
+    const std::vector<Gatherer> gatherers = {
+        {{-4.0, 0.0}, {4.0, 0.0}, 0.3},
+        {{1.0, -3.0}, {1.0, 2.5}, 0.6},
+        {{-3.0, -3.0}, {2.0, 4.0}, 0.1}
+    };
+    constexpr size_t FIRST = 3; // пакет не с начала массивов
+
+    for (const Gatherer& gatherer : gatherers) {
+        const size_t count = items.x.size() - FIRST;
+        std::vector<uint64_t> scalar_mask((count + 63) / 64);
+        FindGatherCandidates(GatherKernel::SCALAR, gatherer, items, FIRST, count, scalar_mask.data());
+
+        for (size_t i = 0; i < count; ++i) {
+            const bool is_marked = (scalar_mask[i / 64] >> (i % 64)) & 1;
+            const size_t item = FIRST + i;
+            if (TryCollectPoint(gatherer.start_pos, gatherer.end_pos, {items.x[item], items.y[item]}).IsCollected(gatherer.width + items.width[item])) {
+                CHECK(is_marked);
+            }
+        }
+
+        for (const GatherKernel kernel : {GatherKernel::SSE2, GatherKernel::AVX2}) {
+            if (!IsGatherKernelSupported(kernel)) {
+                continue;
+            }
+            std::vector<uint64_t> mask(scalar_mask.size(), ~uint64_t{0});
+            FindGatherCandidates(kernel, gatherer, items, FIRST, count, mask.data());
+            CHECK(mask == scalar_mask);
+        }
+    }
+}
@@ -0,0 +1,83 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/command_queue.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+SCENARIO("Command queue") {
+    using command_queue::CommandQueue;
+
+    GIVEN("an empty queue") {
+        CommandQueue queue;
+        std::vector<int> executed;
+
+        THEN("only the first push wakes the consumer") {
+            CHECK(queue.Push([&executed] { executed.push_back(1); }));
+            CHECK_FALSE(queue.Push([&executed] { executed.push_back(2); }));
+            CHECK(queue.GetSize() == 2);
+
+            AND_THEN("commands are executed in order and the queue becomes empty") {
+                CHECK(queue.Drain() == 2);
+                CHECK(executed == std::vector<int>{1, 2});
+                CHECK(queue.GetSize() == 0);
+                CHECK(queue.Drain() == 0);
+                CHECK(queue.Push([] {}));
+            }
+        }
+
+        WHEN("a command pushes another command while draining") {
+            queue.Push([&queue, &executed] {
+                executed.push_back(1);
+                queue.Push([&executed] { executed.push_back(2); });
+            });
+
+            THEN("the new command waits for the next drain") {
+                CHECK(queue.Drain() == 1);
+                CHECK(executed == std::vector<int>{1});
+                CHECK(queue.Drain() == 1);
+                CHECK(executed == std::vector<int>{1, 2});
+            }
+        }
+    }
+
+    GIVEN("several producers pushing concurrently") {
+        constexpr int PRODUCERS = 4;
+        constexpr int COMMANDS_PER_PRODUCER = 20000;
+
+        CommandQueue queue;
+        std::vector<std::vector<int>> executed(PRODUCERS); // изменяется только потребителем
+        std::atomic<int> finished_producers{0};
+
+        std::vector<std::thread> producers;
+        for (int producer = 0; producer < PRODUCERS; ++producer) {
+            producers.emplace_back([&, producer] {
+                for (int i = 0; i < COMMANDS_PER_PRODUCER; ++i) {
+                    queue.Push([&executed, producer, i] { executed[producer].push_back(i); });
+                }
+                ++finished_producers;
+            });
+        }
+
+        size_t total = 0;
+        while (finished_producers < PRODUCERS || queue.GetSize() != 0) {
+            total += queue.Drain();
+        }
+        for (std::thread& thread : producers) {
+            thread.join();
+        }
+
+        THEN("every command is executed once in the order of its producer") {
+            CHECK(total == PRODUCERS * COMMANDS_PER_PRODUCER);
+            for (const std::vector<int>& commands : executed) {
+                REQUIRE(commands.size() == COMMANDS_PER_PRODUCER);
+                bool ordered = true;
+                for (int i = 0; i < COMMANDS_PER_PRODUCER; ++i) {
+                    ordered = ordered && commands[i] == i;
+                }
+                CHECK(ordered);
+            }
+        }
+    }
+}
@@ -0,0 +1,139 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/app.h"
+#include "../src/journal.h"
+#include "../src/replay.h"
+
+#include <sstream>
+
+using namespace std::literals;
+
+namespace {
+
+model::Game MakeGame() {
+    using namespace model;
+    Game game;
+    game.SetLootConfig(0.5, 0.9);
+    Map map(Map::Id{"map1"}, "Map 1");
+    map.AddRoad(Road(Road::HORIZONTAL, {0, 0}, 40));
+    map.AddRoad(Road(Road::VERTICAL, {40, 0}, 30));
+    map.AddRoad(Road(Road::HORIZONTAL, {0, 30}, 40));
+    LootType loot_type;
+    loot_type.properties["value"] = int64_t{10};
+    map.AddLootType(loot_type);
+    map.AddLootType(loot_type);
+    map.AddOffice(Office(Office::Id{"o1"}, {20, 0}, {0, 0}));
+    game.AddMap(map);
+    return game;
+}
+
+} // namespace
+
+SCENARIO("Journal format") {
+    using namespace journal;
+
+    GIVEN("a journal with commands of every type") {
+        std::stringstream stream;
+        {
+            JournalWriter writer(stream, Header{0x0123456789ABCDEFULL, true});
+            writer.WriteJoin("dog"sv, "map1"sv);
+            writer.WriteAction(300, "L"sv);
+            writer.WriteAction(1, ""sv);
+            writer.WriteTick(100000);
+            CHECK(writer.GetRecordsCount() == 4);
+            CHECK(writer.IsGood());
+        }
+
+        WHEN("the journal is read") {
+            JournalReader reader(stream);
+
+            THEN("the header and commands are restored in order") {
+                CHECK(reader.GetHeader().random_seed == 0x0123456789ABCDEFULL);
+                CHECK(reader.GetHeader().randomize_spawn_points);
+
+                uint64_t time_us = 0;
+                const std::vector<Command> expected = {
+                    JoinCommand{"dog", "map1"},
+                    ActionCommand{300, "L"},
+                    ActionCommand{1, ""},
+                    TickCommand{100000}
+                };
+                for (const Command& command : expected) {
+                    const std::optional<Record> record = reader.Next();
+                    REQUIRE(record);
+                    CHECK(record->command == command);
+                    CHECK(record->time_us >= time_us);
+                    time_us = record->time_us;
+                }
+                CHECK_FALSE(reader.Next());
+            }
+        }
+
+        WHEN("the journal is truncated") {
+            std::string data = stream.str();
+            data.pop_back();
+            std::istringstream truncated(data);
+            JournalReader reader(truncated);
+
+            THEN("reading the last record throws") {
+                CHECK(reader.Next());
+                CHECK(reader.Next());
+                CHECK(reader.Next());
+                CHECK_THROWS_AS(reader.Next(), std::runtime_error);
+            }
+        }
+
+        WHEN("the data is not a journal") {
+            std::istringstream garbage("not a journal"s);
+
+            THEN("the reader throws") {
+                CHECK_THROWS_AS(JournalReader(garbage), std::runtime_error);
+            }
+        }
+    }
+}
+
+SCENARIO("Journal replay") {
+    using namespace model;
+
+    GIVEN("a recorded game with random spawn points and loot") {
+        std::stringstream stream;
+        Game recorded_game = MakeGame();
+        app::Application recorded_app{recorded_game, 0, true};
+        recorded_app.SetRandomSeed(42);
+        recorded_app.SetJournal(std::make_shared<journal::JournalWriter>(stream, journal::Header{42, true}));
+
+        std::vector<app::JoinInfo> players;
+        for (int i = 0; i < 5; ++i) {
+            players.push_back(recorded_app.JoinGame("dog"s + std::to_string(i), Map::Id{"map1"}));
+        }
+        constexpr std::string_view DIRECTIONS[] = {"L"sv, "R"sv, "U"sv, "D"sv, ""sv};
+        for (int tick = 0; tick < 50; ++tick) {
+            const app::JoinInfo& player = players[tick % players.size()];
+            recorded_app.SetDogAction(*recorded_app.FindPlayerByToken(player.token), DIRECTIONS[tick % std::size(DIRECTIONS)]);
+            recorded_app.Tick(std::chrono::milliseconds(100 + tick));
+        }
+        const uint64_t recorded_checksum = replay::GetStateChecksum(recorded_game);
+        REQUIRE(recorded_game.GetTotalLootsCount() > 0);
+
+        WHEN("the journal is replayed into a new game") {
+            journal::JournalReader reader(stream);
+            Game replayed_game = MakeGame();
+            app::Application replayed_app{replayed_game, 0, reader.GetHeader().randomize_spawn_points};
+            const replay::ReplayStats stats = replay::ReplayJournal(reader, replayed_app);
+
+            THEN("the state is the same and the tokens are not derived from the journal") {
+                CHECK(stats.joins == 5);
+                CHECK(stats.actions == 50);
+                CHECK(stats.ticks == 50);
+                CHECK(stats.skipped_actions == 0);
+                CHECK(stats.state_checksum == recorded_checksum);
+                CHECK(replayed_game.GetTotalLootsCount() == recorded_game.GetTotalLootsCount());
+                for (const app::JoinInfo& player : players) {
+                    CHECK(replayed_app.GetPlayers().FindByDogId(Dog::Id{player.id}));
+                    CHECK_FALSE(replayed_app.FindPlayerByToken(player.token));
+                }
+            }
+        }
+    }
+}
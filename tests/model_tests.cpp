@@ -7,6 +7,10 @@
 #include "../src/geom.h"
 #include "../src/model.h"
 
+#include <algorithm>
+#include <map>
+#include <tuple>
+
 using Catch::Matchers::WithinRel;
 using namespace model;
 
@@ -162,7 +166,8 @@ SCENARIO("Map with given speed and loot parameters", "[model::Map]") {
                     }
 
                     GIVEN("A random road") {
-                        auto random_road_ptr = map.GetRandomRoad();
+                        RandomEngine random;
+                        auto random_road_ptr = map.GetRandomRoad(random);
                         THEN("Check the selection of a random road") {
                             CHECK((random_road_ptr == road1_ptr || random_road_ptr == road2_ptr));
                         }
@@ -189,8 +194,8 @@ SCENARIO("Game Session with two players dogs", "[model::GameSession]") {
             }
 
             GIVEN("Two players dogs") {
-                DogPtr dog1(std::make_shared<Dog>(Dog::Id{0}, "Icy", geom::Point2D{-0.3, -0.4}, 4.5, 3));
-                DogPtr dog2(std::make_shared<Dog>(Dog::Id{1}, "Wolfy", geom::Point2D{1.1, 5.5}, 5.0, 3));
+                Dog dog1(Dog::Id{0}, "Icy", geom::Point2D{-0.3, -0.4}, 4.5, 3);
+                Dog dog2(Dog::Id{1}, "Wolfy", geom::Point2D{1.1, 5.5}, 5.0, 3);
 
 
                 WHEN("Let's add two players dogs") {
@@ -273,4 +278,306 @@ SCENARIO("Game Session with two players dogs", "[model::GameSession]") {
             }
         }
     }
-}
\ No newline at end of file
+}
+SCENARIO("Road index by intervals", "[model::RoadIndex]") {
+    GIVEN("an index with overlapping roads on one line") {
+        RoadIndex index;
+        std::map<Coord, RoadPtr> expected; // последняя дорога, назначенная точке линии
+        std::vector<RoadPtr> roads;
+        const std::vector<std::pair<Coord, Coord>> segments = {{0, 10}, {20, 30}, {5, 25}, {12, 14}, {-5, 40}, {30, 35}, {8, 8}};
+        for (const auto& [from, to] : segments) {
+            roads.push_back(std::make_shared<Road>(Road::HORIZONTAL, Point{from, 3}, to));
+            index.Assign(3, from, to, roads.back());
+            for (Coord x = from; x <= to; ++x) {
+                expected[x] = roads.back();
+            }
+        }
+
+        THEN("every point is found on the road assigned last") {
+            for (Coord x = -10; x <= 45; ++x) {
+                auto it = expected.find(x);
+                CHECK(index.Find(3, x) == (it != expected.end() ? it->second : nullptr));
+            }
+            CHECK(index.Find(4, 5) == nullptr);
+        }
+
+        THEN("memory does not depend on the length of roads") {
+            CHECK(index.GetIntervalsCount() <= 2 * segments.size() + 1);
+        }
+    }
+
+    GIVEN("a map with a long road") {
+        Map map(Map::Id{"map1"}, "Map 1");
+        map.AddRoad(Road(Road::HORIZONTAL, {0, 0}, 1000000));
+        map.AddRoad(Road(Road::HORIZONTAL, {1000000, 0}, 2000000));
+
+        THEN("joined roads are found by any point") {
+            REQUIRE(map.GetRoads().size() == 1);
+            CHECK(map.FindRoadByPositionAndDirection({1500000.2, 0.0}, Direction::EAST) == map.GetRoads().front());
+            CHECK(map.FindRoadByPositionAndDirection({1500000.2, 0.0}, Direction::NORTH) == nullptr);
+        }
+    }
+}
+
+SCENARIO("Bulk map builder", "[model::MapBuilder]") {
+    const auto road_extents = [](const Map& map) {
+        std::vector<std::tuple<bool, Coord, Coord, Coord, Coord>> extents;
+        for (const RoadPtr& road : map.GetRoads()) {
+            extents.emplace_back(road->IsHorizontal(), road->GetStart().x, road->GetStart().y, road->GetEnd().x, road->GetEnd().y);
+        }
+        return extents;
+    };
+
+    GIVEN("roads with joined collinear segments") {
+        const std::vector<Road> roads = {
+            Road(Road::HORIZONTAL, {0, 0}, 10),
+            Road(Road::VERTICAL, {10, 0}, 20),
+            Road(Road::HORIZONTAL, {10, 0}, 20),
+            Road(Road::HORIZONTAL, {0, 20}, 40),
+            Road(Road::VERTICAL, {10, 30}, 20),
+            Road(Road::HORIZONTAL, {25, 0}, 20),
+            Road(Road::VERTICAL, {40, 0}, 20)
+        };
+
+        Map sequential(Map::Id{"map1"}, "Map 1");
+        Map bulk(Map::Id{"map1"}, "Map 1");
+        MapBuilder builder(bulk);
+        for (const Road& road : roads) {
+            sequential.AddRoad(road);
+            builder.AddRoad(road);
+        }
+        builder.Build();
+
+        THEN("the roads are the same as after sequential adding") {
+            auto expected = road_extents(sequential);
+            auto actual = road_extents(bulk);
+            std::sort(expected.begin(), expected.end());
+            std::sort(actual.begin(), actual.end());
+            CHECK(actual == expected);
+        }
+
+        THEN("the merged road takes the place of its first segment") {
+            REQUIRE(bulk.GetRoads().size() == 4);
+            CHECK(bulk.GetRoads()[0]->GetEnd().x == 25);
+            CHECK(bulk.GetRoads()[1]->GetEnd().y == 30);
+            CHECK(bulk.FindRoadByPositionAndDirection({22.0, 0.0}, Direction::EAST) == bulk.GetRoads()[0]);
+            CHECK(bulk.FindRoadByPositionAndDirection({10.0, 25.0}, Direction::NORTH) == bulk.GetRoads()[1]);
+        }
+    }
+
+    GIVEN("thousands of adjacent segments on one line") {
+        Map map(Map::Id{"map1"}, "Map 1");
+        MapBuilder builder(map);
+        for (Coord x = 10000; x > 0; x -= 10) {
+            builder.AddRoad(Road(Road::HORIZONTAL, {x - 10, 5}, x));
+        }
+        builder.Build();
+
+        THEN("they are merged into one road") {
+            REQUIRE(map.GetRoads().size() == 1);
+            CHECK(map.GetRoads()[0]->GetStart().x == 0);
+            CHECK(map.GetRoads()[0]->GetEnd().x == 10000);
+        }
+    }
+}
+
+SCENARIO("Road lookup through a cursor", "[model::Map]") {
+    using namespace model;
+
+    GIVEN("a map with crossing and separated roads") {
+        Map map(Map::Id{"map1"}, "Map 1");
+        map.AddRoad(Road(Road::HORIZONTAL, {0, 0}, 20));
+        map.AddRoad(Road(Road::HORIZONTAL, {30, 0}, 50));
+        map.AddRoad(Road(Road::VERTICAL, {10, -10}, 10));
+        map.AddRoad(Road(Road::VERTICAL, {40, 0}, 30));
+
+        THEN("the cursor finds the same roads as the index along a walk") {
+            RoadCursor cursor;
+            for (double x = -5.0; x <= 55.0; x += 0.3) {
+                for (double y : {-0.4, 0.0, 0.4, 5.0}) {
+                    const geom::Point2D pos{x, y};
+                    CHECK(map.FindRoad(pos, true, cursor) == map.FindRoadByPositionAndDirection(pos, Direction::EAST).get());
+                    CHECK(map.FindRoad(pos, false, cursor) == map.FindRoadByPositionAndDirection(pos, Direction::NORTH).get());
+                }
+            }
+        }
+
+        THEN("a span covers the whole road or the gap between roads") {
+            RoadCursor cursor;
+            CHECK(map.FindRoad({5.0, 0.0}, true, cursor) == map.GetRoads()[0].get());
+            CHECK(cursor.horizontal.from == 0);
+            CHECK(cursor.horizontal.to == 20);
+
+            CHECK_FALSE(map.FindRoad({25.0, 0.0}, true, cursor));
+            CHECK(cursor.horizontal.from == 21);
+            CHECK(cursor.horizontal.to == 29);
+        }
+    }
+}
+
+SCENARIO("Random road weighted by length", "[model::RoadSampler]") {
+    using namespace model;
+
+    GIVEN("a long road and short stub roads") {
+        Map map(Map::Id{"map1"}, "Map 1");
+        map.AddRoad(Road(Road::HORIZONTAL, {0, 0}, 70));
+        map.AddRoad(Road(Road::VERTICAL, {100, 0}, 10));
+        map.AddRoad(Road(Road::VERTICAL, {200, 0}, 20));
+        map.AddRoad(Road(Road::HORIZONTAL, {300, 300}, 300));
+
+        WHEN("many roads are selected") {
+            RandomEngine random(42);
+            std::map<const Road*, int> counts;
+            constexpr int SAMPLES = 100000;
+            for (int i = 0; i < SAMPLES; ++i) {
+                ++counts[map.GetRandomRoad(random).get()];
+            }
+
+            THEN("the frequency of each road is proportional to its length") {
+                const RoadPtrs& roads = map.GetRoads();
+                REQUIRE(roads.size() == 4);
+                for (const RoadPtr& road : roads) {
+                    const double expected = road->GetLength() / 100.0;
+                    CHECK(std::abs(static_cast<double>(counts[road.get()]) / SAMPLES - expected) < 0.01);
+                }
+                CHECK(counts[roads[3].get()] == 0);
+            }
+        }
+    }
+
+    GIVEN("roads of zero length only") {
+        Map map(Map::Id{"map1"}, "Map 1");
+        map.AddRoad(Road(Road::HORIZONTAL, {0, 0}, 0));
+        map.AddRoad(Road(Road::HORIZONTAL, {10, 10}, 10));
+
+        THEN("both roads can be selected") {
+            RandomEngine random(7);
+            std::map<const Road*, int> counts;
+            for (int i = 0; i < 1000; ++i) {
+                ++counts[map.GetRandomRoad(random).get()];
+            }
+            CHECK(counts.size() == 2);
+        }
+    }
+}
+
+SCENARIO("Loot removal by swapping with the last one", "[model::GameSession]") {
+    using namespace model;
+
+    GIVEN("a session with four loot items") {
+        Map map(Map::Id{"map1"}, "Map 1");
+        GameSession session(&map, 5.0, 0.5);
+        for (uint32_t i = 0; i < 4; ++i) {
+            session.AddLoot(Loot{Loot::Id{i}, 0, {static_cast<double>(i), 0.0}});
+        }
+
+        THEN("a loot item with an existing id is rejected") {
+            CHECK_THROWS_AS(session.AddLoot(Loot{Loot::Id{2}, 0, {}}), std::invalid_argument);
+            CHECK(session.GetLootsCount() == 4);
+        }
+
+        WHEN("a loot item in the middle is taken") {
+            const std::optional<Loot> loot = session.TakeLoot(Loot::Id{1});
+
+            THEN("the last loot item takes its place") {
+                REQUIRE(loot);
+                CHECK(loot->pos == geom::Point2D{1.0, 0.0});
+                REQUIRE(session.GetLootsCount() == 3);
+                CHECK(session.GetLoots()[0].id == Loot::Id{0});
+                CHECK(session.GetLoots()[1].id == Loot::Id{3});
+                CHECK(session.GetLoots()[2].id == Loot::Id{2});
+            }
+
+            THEN("the loot index follows the new slots") {
+                std::vector<uint32_t> found;
+                session.QueryLoots({-1.0, -1.0}, {4.0, 1.0}, found);
+                std::sort(found.begin(), found.end());
+                CHECK(found == std::vector<uint32_t>{0, 1, 2});
+
+                found.clear();
+                session.QueryLoots({2.5, -0.5}, {3.5, 0.5}, found);
+                CHECK(std::find(found.begin(), found.end(), 1) != found.end()); // предмет 3 теперь на месте 1
+            }
+
+            THEN("the moved loot item is still found by id") {
+                CHECK_FALSE(session.TakeLoot(Loot::Id{1}));
+                REQUIRE(session.TakeLoot(Loot::Id{3}));
+                REQUIRE(session.TakeLoot(Loot::Id{2}));
+                REQUIRE(session.TakeLoot(Loot::Id{0}));
+                CHECK(session.GetLoots().empty());
+            }
+        }
+    }
+}
+
+SCENARIO("Session random streams after a session is removed", "[model::Game]") {
+    using namespace model;
+
+    GIVEN("a seeded game with three sessions on one map") {
+        Game game;
+        Map map(Map::Id{"map1"}, "Map 1");
+        map.AddRoad(Road(Road::HORIZONTAL, {0, 0}, 10));
+        game.AddMap(map);
+        game.SetRandomSeed(7);
+        const Map* game_map = game.FindMap(Map::Id{"map1"});
+        for (int i = 0; i < 3; ++i) {
+            game.AddSession(std::make_shared<GameSession>(game_map, 5.0, 0.5));
+        }
+        const GameSessionPtr third = game.GetSessions()[2];
+
+        WHEN("the second session is removed and a new one takes the freed position") {
+            game.RemoveSession(game.GetSessions()[1].get());
+            game.AddSession(std::make_shared<GameSession>(game_map, 5.0, 0.5));
+            const GameSessionPtr added = game.GetSessions()[2];
+
+            THEN("the new session does not repeat the stream of a live one") {
+                REQUIRE(game.GetSessions()[1] == third);
+                CHECK(added->GetSerial() == 3);
+                CHECK(added->GetRandomEngine()() != third->GetRandomEngine()());
+            }
+
+            THEN("reseeding derives each stream from the session serial") {
+                game.SetRandomSeed(7);
+                CHECK(third->GetRandomEngine()() == RandomEngine{MixSeed(7, 2)}());
+                CHECK(added->GetRandomEngine()() == RandomEngine{MixSeed(7, 3)}());
+            }
+        }
+    }
+}
+
+SCENARIO("Office lookup through the map index", "[model::Map]") {
+    using namespace model;
+
+    GIVEN("a map with offices far apart") {
+        Map map(Map::Id{"map1"}, "Map 1");
+        map.AddOffice(Office(Office::Id{"o0"}, {0, 0}, {0, 0}));
+        map.AddOffice(Office(Office::Id{"o1"}, {50, 0}, {0, 0}));
+        map.AddOffice(Office(Office::Id{"o2"}, {50, 50}, {0, 0}));
+
+        THEN("only offices near the rectangle are returned") {
+            std::vector<uint32_t> found;
+            map.QueryOffices({49.0, -1.0}, {51.0, 1.0}, found);
+            CHECK(found == std::vector<uint32_t>{1});
+
+            found.clear();
+            map.QueryOffices({-1.0, -1.0}, {51.0, 51.0}, found);
+            std::sort(found.begin(), found.end());
+            CHECK(found == std::vector<uint32_t>{0, 1, 2});
+
+            found.clear();
+            map.QueryOffices({20.0, 20.0}, {30.0, 30.0}, found);
+            CHECK(found.empty());
+
+            map.QueryOffices({60.0, -10.0}, {70.0, 60.0}, found); // правее всех офисов
+            CHECK(found.empty());
+        }
+
+        THEN("a duplicate office leaves the index unchanged") {
+            CHECK_THROWS_AS(map.AddOffice(Office(Office::Id{"o1"}, {20, 20}, {0, 0})), std::invalid_argument);
+            std::vector<uint32_t> found;
+            map.QueryOffices({19.0, 19.0}, {21.0, 21.0}, found);
+            CHECK(found.empty());
+            CHECK(map.GetOffices().size() == 3);
+        }
+    }
+}
@@ -0,0 +1,105 @@
+#include <catch2/catch_test_macros.hpp>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "../src/records_writer.h"
+
+using namespace std::literals;
+
+namespace {
+
+postgres::PlayerRecord MakeRecord(int score) {
+    return {"uuid-"s + std::to_string(score), "dog"s, score, 1000};
+}
+
+} // namespace
+
+SCENARIO("Records writer") {
+    using records_writer::RecordsWriter;
+
+    std::mutex mutex;
+    std::vector<postgres::PlayersRecords> batches;
+    int failures_left = 0;
+
+    auto write_batch = [&](const postgres::PlayersRecords& records) {
+        std::lock_guard lock{mutex};
+        if (failures_left > 0) {
+            --failures_left;
+            throw std::runtime_error("DB is unavailable");
+        }
+        batches.push_back(records);
+    };
+
+    GIVEN("a writer with batches of 3 records") {
+        RecordsWriter writer(write_batch, 100, 3);
+
+        WHEN("records are pushed") {
+            for (int i = 0; i < 7; ++i) {
+                CHECK(writer.Push(MakeRecord(i)));
+            }
+            REQUIRE(writer.WaitFlushed(5s));
+
+            THEN("all records are written in order in batches not larger than 3") {
+                std::lock_guard lock{mutex};
+                int expected_score = 0;
+                for (const auto& batch : batches) {
+                    CHECK(!batch.empty());
+                    CHECK(batch.size() <= 3);
+                    for (const auto& record : batch) {
+                        CHECK(record.score == expected_score++);
+                    }
+                }
+                CHECK(expected_score == 7);
+
+                const auto stats = writer.GetStats();
+                CHECK(stats.queue_depth == 0);
+                CHECK(stats.enqueued == 7);
+                CHECK(stats.written == 7);
+                CHECK(stats.dropped == 0);
+                CHECK(stats.batches == batches.size());
+            }
+        }
+    }
+
+    GIVEN("a writer with queue capacity of 2 records and unavailable DB") {
+        failures_left = 1;
+        RecordsWriter writer(write_batch, 2, 10);
+
+        WHEN("more records than capacity are pushed") {
+            const bool pushed1 = writer.Push(MakeRecord(1));
+            const bool pushed2 = writer.Push(MakeRecord(2));
+            const bool pushed3 = writer.Push(MakeRecord(3));
+
+            THEN("extra records are dropped and the rest is written after retry") {
+                CHECK(pushed1);
+                CHECK(pushed2);
+                CHECK_FALSE(pushed3);
+
+                REQUIRE(writer.WaitFlushed(5s));
+                const auto stats = writer.GetStats();
+                CHECK(stats.written == 2);
+                CHECK(stats.dropped == 1);
+                CHECK(stats.failed_batches == 1);
+                CHECK(stats.max_queue_depth == 2);
+            }
+        }
+    }
+
+    GIVEN("a writer with records in queue") {
+        {
+            RecordsWriter writer(write_batch, 100, 10);
+            for (int i = 0; i < 20; ++i) {
+                writer.Push(MakeRecord(i));
+            }
+        } // деструктор дописывает очередь
+
+        THEN("all records are written before destruction") {
+            size_t written = 0;
+            for (const auto& batch : batches) {
+                written += batch.size();
+            }
+            CHECK(written == 20);
+        }
+    }
+}
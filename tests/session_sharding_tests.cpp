@@ -0,0 +1,200 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/app.h"
+
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+// шаги по 100 мс, собаки active получают действие на каждом шаге, остальные уходят по бездействию
+void TickWithActive(app::Application& app, const std::vector<app::JoinInfo>& active, int ticks) {
+    for (int i = 0; i < ticks; ++i) {
+        for (const app::JoinInfo& player : active) {
+            app.SetDogAction(*app.FindPlayerByToken(player.token), i % 2 == 0 ? "R"sv : "L"sv);
+        }
+        app.Tick(100ms);
+    }
+}
+
+} // namespace
+
+SCENARIO("Session sharding by players cap") {
+    using namespace model;
+
+    GIVEN("a map with a cap of two players per session") {
+        Game game;
+        game.SetRetirementTime(1.0);
+        Map map(Map::Id{"map1"}, "Map 1");
+        map.AddRoad(Road(Road::HORIZONTAL, {0, 0}, 100));
+        map.SetMaxPlayers(2);
+        game.AddMap(map);
+        const Map::Id map_id{"map1"};
+
+        app::Application app{game, 0, false};
+        std::vector<app::JoinInfo> players;
+        for (int i = 0; i < 5; ++i) {
+            players.push_back(app.JoinGame("dog"s + std::to_string(i), map_id));
+        }
+        const auto session_of = [&app](const app::JoinInfo& player) {
+            return app.FindPlayerByToken(player.token)->GetSession().get();
+        };
+
+        THEN("new instances of the map are spawned when sessions are full") {
+            REQUIRE(game.GetMapSessions(map_id).size() == 3);
+            CHECK(game.GetSessionsCount() == 3);
+            CHECK(game.GetMapSessions(map_id)[0]->GetDogsCount() == 2);
+            CHECK(game.GetMapSessions(map_id)[1]->GetDogsCount() == 2);
+            CHECK(game.GetMapSessions(map_id)[2]->GetDogsCount() == 1);
+            CHECK(session_of(players[0]) == session_of(players[1]));
+            CHECK(session_of(players[2]) == session_of(players[3]));
+            CHECK(app.GetPlayers().CountPlayersAtMap(map_id) == 5);
+        }
+
+        WHEN("players leave and the rest fit into fewer instances") {
+            const GameSession* first = session_of(players[0]);
+            const GameSession* second = session_of(players[2]);
+            TickWithActive(app, {players[0], players[2]}, 15); // уходят 1, 3 и 4
+
+            THEN("the empty instance is freed and the least loaded one is drained") {
+                REQUIRE(game.GetMapSessions(map_id).size() == 2);
+                CHECK(game.GetSessions().size() == 2);
+                CHECK(game.GetMapSessions(map_id)[0].get() == first);
+                CHECK(game.GetMapSessions(map_id)[1].get() == second);
+                CHECK_FALSE(first->IsDraining());
+                CHECK(second->IsDraining());
+            }
+
+            AND_WHEN("new players join") {
+                const app::JoinInfo joined1 = app.JoinGame("new1"s, map_id);
+                const app::JoinInfo joined2 = app.JoinGame("new2"s, map_id);
+
+                THEN("they fill active instances first and reuse the draining one before spawning") {
+                    CHECK(session_of(joined1) == first);
+                    CHECK(session_of(joined2) == second);
+                    CHECK_FALSE(second->IsDraining());
+                    CHECK(game.GetSessionsCount() == 2);
+                }
+            }
+
+            AND_WHEN("the last player of the drained instance leaves") {
+                TickWithActive(app, {players[0]}, 15);
+
+                THEN("the instance is freed while the first instance of the map is kept") {
+                    REQUIRE(game.GetMapSessions(map_id).size() == 1);
+                    CHECK(game.GetMapSessions(map_id)[0].get() == first);
+                    CHECK(app.FindPlayerByToken(players[0].token));
+                    CHECK_FALSE(app.FindPlayerByToken(players[2].token));
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Hibernation of sessions without players") {
+    using namespace model;
+
+    GIVEN("two maps with loot and a player on each") {
+        Game game;
+        game.SetRetirementTime(1.0);
+        game.SetLootConfig(0.5, 1.0);
+        for (const std::string& id : {"map1"s, "map2"s}) {
+            Map map(Map::Id{id}, id);
+            map.AddRoad(Road(Road::HORIZONTAL, {0, 0}, 100));
+            map.AddLootType(LootType{});
+            game.AddMap(map);
+        }
+
+        app::Application app{game, 0, false};
+        app.EnableStateSnapshots();
+        app.SetTickProfileWindow(100);
+        const app::JoinInfo player1 = app.JoinGame("dog1"s, Map::Id{"map1"});
+        const app::JoinInfo player2 = app.JoinGame("dog2"s, Map::Id{"map2"});
+        app.Tick(100ms);
+        REQUIRE(game.GetActiveSessionIndices().size() == 2);
+
+        WHEN("the player of the second map leaves") {
+            const GameSessionPtr session = game.GetSession(Map::Id{"map2"});
+            TickWithActive(app, {player1}, 15);
+            const size_t loots_count = session->GetLootsCount();
+            const int64_t time = session->GetTime();
+
+            THEN("the session is kept asleep and skipped by the tick") {
+                CHECK(session->IsHibernating());
+                CHECK(game.GetSessionsCount() == 2);
+                CHECK(game.GetActiveSessionIndices() == std::vector<size_t>{0});
+
+                TickWithActive(app, {player1}, 10);
+                CHECK(session->GetTime() == time);
+                CHECK(session->GetLootsCount() == loots_count);
+            }
+
+            THEN("the snapshot and the profiler skip the sleeping session") {
+                const auto& profiles = app.GetTickProfiler()->GetSessions();
+                REQUIRE(profiles.size() == 2);
+                const size_t samples = profiles[1].phases[0].GetCount();
+                TickWithActive(app, {player1}, 10);
+                CHECK(profiles[1].phases[0].GetCount() == samples);
+                CHECK(profiles[0].phases[0].GetCount() == 26);
+
+                const app::StateSnapshotPtr snapshot = app.GetStateSnapshot();
+                REQUIRE(snapshot->sessions.size() == 2);
+                CHECK(snapshot->sessions[0] != nullptr);
+                CHECK(snapshot->sessions[1] == nullptr);
+            }
+
+            AND_WHEN("a new player joins the map") {
+                const app::JoinInfo joined = app.JoinGame("dog3"s, Map::Id{"map2"});
+                app.Tick(100ms);
+
+                THEN("the session wakes up with its loot") {
+                    CHECK(app.FindPlayerByToken(joined.token)->GetSession() == session);
+                    CHECK_FALSE(session->IsHibernating());
+                    CHECK(game.GetActiveSessionIndices().size() == 2);
+                    CHECK(session->GetTime() > time);
+                    CHECK(session->GetLootsCount() >= loots_count);
+                    CHECK(app.GetStateSnapshot()->FindSession(joined.token) != nullptr);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Several loot pickups in one move") {
+    using namespace model;
+
+    GIVEN("a dog on a road with loot items along its way") {
+        Game game;
+        game.SetDefaultSpeed(10.0);
+        game.SetDefaultBagCapacity(5);
+        Map map(Map::Id{"map1"}, "Map 1");
+        map.AddRoad(Road(Road::HORIZONTAL, {0, 0}, 100));
+        game.AddMap(map);
+
+        app::Application app{game, 0, false};
+        const app::JoinInfo player = app.JoinGame("dog"s, Map::Id{"map1"});
+        const app::PlayerPtr dog_player = app.FindPlayerByToken(player.token);
+        GameSession& session = *dog_player->GetSession();
+        session.AddLoot(Loot{Loot::Id{0}, 0, {0.3, 0.0}});
+        session.AddLoot(Loot{Loot::Id{1}, 0, {0.6, 0.0}});
+        session.AddLoot(Loot{Loot::Id{2}, 0, {0.9, 0.0}});
+        session.AddLoot(Loot{Loot::Id{3}, 0, {50.0, 0.0}});
+
+        WHEN("the dog passes all the nearby items in one tick") {
+            app.SetDogAction(*dog_player, "R"sv);
+            app.Tick(100ms);
+
+            THEN("every passed item is in the bag in the order of pickup") {
+                const Dog* dog = session.GetDog(dog_player->GetDogId());
+                REQUIRE(dog);
+                REQUIRE(dog->GetBag().size() == 3);
+                CHECK(dog->GetBag()[0].id == Loot::Id{0});
+                CHECK(dog->GetBag()[1].id == Loot::Id{1});
+                CHECK(dog->GetBag()[2].id == Loot::Id{2});
+                REQUIRE(session.GetLootsCount() == 1);
+                CHECK(session.GetLoots()[0].id == Loot::Id{3});
+            }
+        }
+    }
+}
@@ -0,0 +1,207 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/app.h"
+#include "../src/spatial_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+std::vector<uint32_t> BruteForceQuery(const std::vector<geom::Point2D>& points, geom::Point2D center,
+                                      double radius, spatial_index::Metric metric) {
+    std::vector<uint32_t> result;
+    for (uint32_t i = 0; i < points.size(); ++i) {
+        const double dx = std::abs(points[i].x - center.x);
+        const double dy = std::abs(points[i].y - center.y);
+        const bool is_visible = metric == spatial_index::Metric::EUCLIDEAN
+            ? dx * dx + dy * dy <= radius * radius
+            : dx + dy <= radius;
+        if (is_visible) {
+            result.push_back(i);
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+SCENARIO("Dynamic grid with insertions and removals") {
+    using namespace spatial_index;
+
+    GIVEN("a grid with points inserted one by one") {
+        std::mt19937_64 engine(3);
+        std::uniform_real_distribution<double> coord(-100.0, 100.0);
+        std::vector<geom::Point2D> points(500);
+        DynamicGrid grid(4.0);
+        for (uint32_t i = 0; i < points.size(); ++i) {
+            points[i] = {coord(engine), coord(engine)};
+            grid.Insert(i, points[i]);
+        }
+        REQUIRE(grid.GetItemsCount() == points.size());
+
+        // точки прямоугольника - все найдены, лишние - только из соседних ячеек
+        const auto check_query = [&grid, &points](geom::Point2D min_corner, geom::Point2D max_corner, const std::vector<bool>& is_present) {
+            std::vector<uint32_t> found;
+            grid.QueryRect(min_corner, max_corner, found);
+            std::sort(found.begin(), found.end());
+            CHECK(std::adjacent_find(found.begin(), found.end()) == found.end());
+            for (uint32_t i = 0; i < points.size(); ++i) {
+                const bool is_inside = min_corner.x <= points[i].x && points[i].x <= max_corner.x
+                    && min_corner.y <= points[i].y && points[i].y <= max_corner.y;
+                const bool is_found = std::binary_search(found.begin(), found.end(), i);
+                if (is_inside && is_present[i]) {
+                    CHECK(is_found);
+                }
+                if (is_found) {
+                    CHECK(is_present[i]);
+                    CHECK(points[i].x >= min_corner.x - 4.0);
+                    CHECK(points[i].x <= max_corner.x + 4.0);
+                }
+            }
+        };
+
+        THEN("small and large rectangles find the points inside") {
+            const std::vector<bool> is_present(points.size(), true);
+            check_query({-10.0, -10.0}, {10.0, 10.0}, is_present);
+            check_query({5.0, -100.0}, {5.5, 100.0}, is_present);
+            check_query({-1000.0, -1000.0}, {1000.0, 1000.0}, is_present);
+        }
+
+        WHEN("half of the points are erased") {
+            std::vector<bool> is_present(points.size(), true);
+            for (uint32_t i = 0; i < points.size(); i += 2) {
+                REQUIRE(grid.Erase(i, points[i]));
+                is_present[i] = false;
+            }
+
+            THEN("they are not found anymore") {
+                CHECK(grid.GetItemsCount() == points.size() / 2);
+                CHECK_FALSE(grid.Erase(0, points[0]));
+                check_query({-50.0, -50.0}, {50.0, 50.0}, is_present);
+                check_query({-1000.0, -1000.0}, {1000.0, 1000.0}, is_present);
+            }
+
+            THEN("erasing all points leaves no cells") {
+                for (uint32_t i = 1; i < points.size(); i += 2) {
+                    REQUIRE(grid.Erase(i, points[i]));
+                }
+                CHECK(grid.GetItemsCount() == 0);
+                CHECK(grid.GetCellsCount() == 0);
+            }
+        }
+    }
+}
+
+SCENARIO("Spatial grid queries") {
+    using namespace spatial_index;
+
+    GIVEN("random points on a large area") {
+        std::mt19937_64 engine(7);
+        std::uniform_real_distribution<double> coord(-50.0, 450.0);
+        std::vector<geom::Point2D> points(1000);
+        for (geom::Point2D& point : points) {
+            point = {coord(engine), coord(engine)};
+        }
+
+        SpatialGrid grid;
+        grid.Build(points.size(), 10.0, [&points](size_t i) {
+            return points[i];
+        });
+
+        THEN("the number of cells is bounded by the number of points") {
+            CHECK(grid.GetItemsCount() == points.size());
+            CHECK(grid.GetCellsCount() <= points.size() * MAX_CELLS_PER_ITEM);
+        }
+
+        THEN("queries return the same points as a full scan") {
+            for (Metric metric : {Metric::EUCLIDEAN, Metric::MANHATTAN}) {
+                for (double radius : {0.0, 5.0, 30.0, 1000.0}) {
+                    for (int i = 0; i < 20; ++i) {
+                        const geom::Point2D center{coord(engine), coord(engine)};
+                        std::vector<uint32_t> found;
+                        grid.Query(center, radius, metric, found);
+                        CHECK(found == BruteForceQuery(points, center, radius, metric));
+                    }
+                }
+            }
+        }
+
+        THEN("a query outside of the area returns nothing") {
+            std::vector<uint32_t> found;
+            grid.Query({-100.0, -100.0}, 10.0, Metric::EUCLIDEAN, found);
+            CHECK(found.empty());
+        }
+    }
+
+    GIVEN("an empty grid") {
+        SpatialGrid grid;
+        grid.Build(0, 10.0, [](size_t) {
+            return geom::Point2D{};
+        });
+
+        THEN("queries return nothing") {
+            std::vector<uint32_t> found;
+            grid.Query({0.0, 0.0}, 10.0, Metric::EUCLIDEAN, found);
+            CHECK(found.empty());
+        }
+    }
+}
+
+SCENARIO("Area of interest in the state snapshot") {
+    using namespace model;
+
+    GIVEN("a long road with players far apart and area of interest enabled") {
+        Game game;
+        game.SetAreaOfInterest(AreaOfInterest{10.0, spatial_index::Metric::EUCLIDEAN});
+        Map map(Map::Id{"map1"}, "Map 1");
+        map.AddRoad(Road(Road::HORIZONTAL, {0, 0}, 100));
+        game.AddMap(map);
+
+        app::Application app{game, 0, false};
+        const app::JoinInfo near = app.JoinGame("near"s, Map::Id{"map1"});
+        const app::JoinInfo far = app.JoinGame("far"s, Map::Id{"map1"});
+        GameSession& session = *app.FindPlayerByToken(far.token)->GetSession();
+        session.GetDog(Dog::Id{1})->SetPosition({50.0, 0.0});
+        session.AddLoot(Loot{Loot::Id{0}, 0, {5.0, 0.0}});
+        session.AddLoot(Loot{Loot::Id{1}, 0, {60.0, 0.0}});
+        app.EnableStateSnapshots();
+
+        WHEN("the area of the first player is queried from the snapshot") {
+            const app::StateSnapshotPtr snapshot = app.GetStateSnapshot();
+            const app::StateSnapshot::PlayerLocation* player = snapshot->FindPlayer(near.token);
+            REQUIRE(player);
+            const app::SessionSnapshot& session_snapshot = *snapshot->sessions[player->session_index];
+            REQUIRE(session_snapshot.area_index);
+
+            std::vector<uint32_t> dogs;
+            std::vector<uint32_t> loots;
+            REQUIRE(session_snapshot.area_index->QueryArea(player->dog_id, game.GetAreaOfInterest(), dogs, loots));
+
+            THEN("only the nearby dog and loot are visible") {
+                REQUIRE(dogs.size() == 1);
+                CHECK(session_snapshot.dogs[dogs[0]].GetId() == Dog::Id{0});
+                REQUIRE(loots.size() == 1);
+                CHECK(session_snapshot.loots[loots[0]].id == Loot::Id{0});
+            }
+        }
+
+        WHEN("the first player moves towards the other one") {
+            app.SetDogAction(*app.FindPlayerByToken(near.token), "R"sv);
+            app.Tick(45s);
+
+            THEN("the index of the session follows the new positions") {
+                std::vector<uint32_t> dogs;
+                std::vector<uint32_t> loots;
+                const AreaIndex* area_index = app.GetAreaIndex(app.FindPlayerByToken(near.token));
+                REQUIRE(area_index);
+                REQUIRE(area_index->QueryArea(Dog::Id{0}, game.GetAreaOfInterest(), dogs, loots));
+                CHECK(dogs.size() == 2);
+            }
+        }
+    }
+}
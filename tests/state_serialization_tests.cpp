@@ -78,9 +78,9 @@ SCENARIO_METHOD(Fixture, "Dog Serialization") {
             Dog dog = Dog(Dog::Id{42}, "Pluto"s, {42.2, 12.5}, 3, 4); // предыдущая позиция, 4 предмета возможны
             dog.IncreaseScore(42);
             Loot loot1 = {Loot::Id{5}, 2, {5.4, 2.0}};
-            dog.AddLootIntoBag(std::move(std::make_shared<Loot>(loot1)));
+            dog.AddLootIntoBag(loot1);
             Loot loot2 = {Loot::Id{9}, 1, {0.6, -0.4}};
-            dog.AddLootIntoBag(std::move(std::make_shared<Loot>(loot2)));
+            dog.AddLootIntoBag(loot2);
             dog.SetDirectionSpeed(model::DirectionToString(Direction::EAST));
             dog.SetSpeed({2.3, -1.2});
             dog.SetPosition({42.6, 12.5}); // новая позиция
@@ -109,26 +109,59 @@ SCENARIO_METHOD(Fixture, "Dog Serialization") {
                 CHECK(dog.GetScore() == restored.GetScore());
                 CHECK(dog.GetDirection() == restored.GetDirection());
                 for (size_t i = 0; i < dog.GetBag().size(); ++i) {
-                    CHECK(*(dog.GetBag()[i]) == *(restored.GetBag()[i]));
+                    CHECK(dog.GetBag()[i] == restored.GetBag()[i]);
                 }
             }
         }
     }
 }
 
+SCENARIO("Dog deserialization from a version 0 archive") {
+    GIVEN("a dog archived when bag items were stored through shared_ptr") {
+        // DogRepr версии 0: собака из "Dog Serialization", время игры 1500 мс, бездействия 700 мс
+        std::stringstream strm{
+            "22 serialization::archive 18 0 0 42 5 Pluto 0 0 4.26000000000000014e+01 1.25000000000000000e+01 "
+            "3.00000000000000000e+00 4 4.22000000000000028e+01 1.25000000000000000e+01 0 0 2.29999999999999982e+00 "
+            "-1.19999999999999996e+00 3 42 0 0 2 1 0 1 5 1 0\n"
+            "0 5 5.40000000000000036e+00 2.00000000000000000e+00 2 5\n"
+            "1 9 5.99999999999999978e-01 -4.00000000000000022e-01 1 1500 700 0"s};
+
+        WHEN("it is loaded by the current build") {
+            InputArchive input_archive{strm};
+            serialization::DogRepr repr;
+            input_archive >> repr;
+            const Dog restored = repr.Restore();
+
+            THEN("the bag and the fields after it are restored") {
+                CHECK(restored.GetId() == Dog::Id{42});
+                CHECK(restored.GetName() == "Pluto"s);
+                CHECK(restored.GetPosition() == geom::Point2D{42.6, 12.5});
+                CHECK(restored.GetScore() == 42);
+                CHECK(restored.GetDirection() == Direction::EAST);
+                REQUIRE(restored.GetBag().size() == 2);
+                CHECK(restored.GetBag()[0] == Loot{Loot::Id{5}, 2, {5.4, 2.0}});
+                CHECK(restored.GetBag()[1] == Loot{Loot::Id{9}, 1, {0.6, -0.4}});
+                CHECK(restored.GetPlayTime() == 1500);
+                CHECK(repr.GetInactivityTime() == 700);
+                CHECK_FALSE(restored.IsMoving());
+            }
+        }
+    }
+}
+
 SCENARIO_METHOD(Fixture, "GameSession Serialization") {
     GIVEN("a gamesession") {
         Map map(Map::Id{"id_1"}, "Map_1");
         GameSession session = [&map] {
             GameSession session = GameSession(&map, 5.0, 0.5);
-            DogPtr dog1(std::move(std::make_shared<Dog>(Dog::Id{0}, "Icy", geom::Point2D{-0.3, -0.4}, 4.5, 3)));
-            DogPtr dog2(std::move(std::make_shared<Dog>(Dog::Id{1}, "Wolfy", geom::Point2D{1.1, 5.5}, 5.0, 3)));
+            Dog dog1(Dog::Id{0}, "Icy", geom::Point2D{-0.3, -0.4}, 4.5, 3);
+            Dog dog2(Dog::Id{1}, "Wolfy", geom::Point2D{1.1, 5.5}, 5.0, 3);
             Loot loot1 = {Loot::Id{5}, 2, {5.4, 2.0}};
-            dog1->AddLootIntoBag(std::move(std::make_shared<Loot>(loot1)));
+            dog1.AddLootIntoBag(loot1);
             Loot loot2 = {Loot::Id{9}, 1, {0.6, -0.4}};
-            dog2->AddLootIntoBag(std::move(std::make_shared<Loot>(loot2)));
-            session.AddDog(dog1);
-            session.AddDog(dog2);
+            dog2.AddLootIntoBag(loot2);
+            session.AddDog(std::move(dog1));
+            session.AddDog(std::move(dog2));
             return session;
         }();
 
@@ -150,13 +183,13 @@ SCENARIO_METHOD(Fixture, "GameSession Serialization") {
                 CHECK(session.GetDogsCount() == restored.GetDogsCount());
                 CHECK(session.GetLootsCount() == restored.GetLootsCount());
                 for (size_t i = 0; i < session.GetDogsCount(); ++i) {
-                    CHECK(*session.GetDogs()[i]->GetId() == *restored.GetDogs()[i]->GetId());
-                    CHECK(session.GetDogs()[i]->GetName() == restored.GetDogs()[i]->GetName());
-                    CHECK(session.GetDogs()[i]->GetBagCapacity() == restored.GetDogs()[i]->GetBagCapacity());
-                    CHECK(session.GetDogs()[i]->GetPosition() == restored.GetDogs()[i]->GetPosition());
-                    CHECK(session.GetDogs()[i]->GetDefaultSpeed() == restored.GetDogs()[i]->GetDefaultSpeed());
-                    for (size_t j = 0; j < session.GetDogs()[i]->GetBag().size(); ++j) {
-                        CHECK(*(session.GetDogs()[i]->GetBag()[j]) == *(restored.GetDogs()[i]->GetBag()[j]));
+                    CHECK(*session.GetDogs()[i].GetId() == *restored.GetDogs()[i].GetId());
+                    CHECK(session.GetDogs()[i].GetName() == restored.GetDogs()[i].GetName());
+                    CHECK(session.GetDogs()[i].GetBagCapacity() == restored.GetDogs()[i].GetBagCapacity());
+                    CHECK(session.GetDogs()[i].GetPosition() == restored.GetDogs()[i].GetPosition());
+                    CHECK(session.GetDogs()[i].GetDefaultSpeed() == restored.GetDogs()[i].GetDefaultSpeed());
+                    for (size_t j = 0; j < session.GetDogs()[i].GetBag().size(); ++j) {
+                        CHECK(session.GetDogs()[i].GetBag()[j] == restored.GetDogs()[i].GetBag()[j]);
                     }
                 }
             }
@@ -171,14 +204,14 @@ SCENARIO_METHOD(Fixture, "Game Serialization") {
         Game game = [&map1, &map2] {
             GameSession session1 = GameSession(&map1, 5.0, 0.5);
             GameSession session2 = GameSession(&map2, 6.0, 0.2);
-            DogPtr dog1(std::move(std::make_shared<Dog>(Dog::Id{0}, "Icy", geom::Point2D{-0.3, -0.4}, 4.5, 3)));
-            DogPtr dog2(std::move(std::make_shared<Dog>(Dog::Id{1}, "Wolfy", geom::Point2D{1.1, 5.5}, 5.0, 3)));
+            Dog dog1(Dog::Id{0}, "Icy", geom::Point2D{-0.3, -0.4}, 4.5, 3);
+            Dog dog2(Dog::Id{1}, "Wolfy", geom::Point2D{1.1, 5.5}, 5.0, 3);
             Loot loot1 = {Loot::Id{5}, 2, {5.4, 2.0}};
-            dog1->AddLootIntoBag(std::move(std::make_shared<Loot>(loot1)));
+            dog1.AddLootIntoBag(loot1);
             Loot loot2 = {Loot::Id{9}, 1, {0.6, -0.4}};
-            dog2->AddLootIntoBag(std::move(std::make_shared<Loot>(loot2)));
-            session1.AddDog(dog1);
-            session1.AddDog(dog2);
+            dog2.AddLootIntoBag(loot2);
+            session1.AddDog(std::move(dog1));
+            session1.AddDog(std::move(dog2));
             Game game;
             game.AddMap(map1);
             game.AddMap(map2);
@@ -214,15 +247,15 @@ SCENARIO_METHOD(Fixture, "Game Serialization") {
                     auto session = game_sessions[i];
                     auto restored_session = restored_game_sessions[i];
                     for (size_t j = 0; j < session->GetDogsCount(); ++j) {
-                        auto dog = session->GetDogs()[j];
-                        auto restored_dog = restored_session->GetDogs()[j];
-                        CHECK(*dog->GetId() == *restored_dog->GetId());
-                        CHECK(dog->GetName() == restored_dog->GetName());
-                        CHECK(dog->GetBagCapacity() == restored_dog->GetBagCapacity());
-                        CHECK(dog->GetPosition() == restored_dog->GetPosition());
-                        CHECK(dog->GetDefaultSpeed() == restored_dog->GetDefaultSpeed());
-                        for (size_t k = 0; k < dog->GetBag().size(); ++k) {
-                            CHECK(*(dog->GetBag()[k]) == *(restored_dog->GetBag()[k]));
+                        const auto& dog = session->GetDogs()[j];
+                        const auto& restored_dog = restored_session->GetDogs()[j];
+                        CHECK(*dog.GetId() == *restored_dog.GetId());
+                        CHECK(dog.GetName() == restored_dog.GetName());
+                        CHECK(dog.GetBagCapacity() == restored_dog.GetBagCapacity());
+                        CHECK(dog.GetPosition() == restored_dog.GetPosition());
+                        CHECK(dog.GetDefaultSpeed() == restored_dog.GetDefaultSpeed());
+                        for (size_t k = 0; k < dog.GetBag().size(); ++k) {
+                            CHECK(dog.GetBag()[k] == restored_dog.GetBag()[k]);
                         }
                     }
                 }
@@ -0,0 +1,173 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+
+#include "../src/app.h"
+
+using namespace std::literals;
+
+SCENARIO("State snapshots") {
+    using namespace model;
+
+    GIVEN("an application with two players on one map") {
+        Game game;
+        Map map(Map::Id{"map1"}, "Map 1");
+        map.AddRoad(Road(Road::HORIZONTAL, {0, 0}, 10));
+        game.AddMap(map);
+
+        app::Application app{game, 50, false};
+        const app::JoinInfo player1 = app.JoinGame("dog1"s, Map::Id{"map1"});
+        const app::JoinInfo player2 = app.JoinGame("dog2"s, Map::Id{"map1"});
+
+        THEN("snapshots are disabled by default") {
+            CHECK(app.GetStateSnapshot() == nullptr);
+        }
+
+        WHEN("snapshots are enabled") {
+            app.EnableStateSnapshots();
+            app::StateSnapshotPtr snapshot = app.GetStateSnapshot();
+
+            THEN("the current state is published before the first tick") {
+                REQUIRE(snapshot);
+                CHECK(snapshot->tick == 0);
+                const app::SessionSnapshot* session = snapshot->FindSession(player1.token);
+                REQUIRE(session);
+                CHECK(session == snapshot->FindSession(player2.token));
+                CHECK(session->dogs.size() == 2);
+                CHECK(snapshot->FindSession(app::Token{"00000000000000000000000000000000"s}) == nullptr);
+            }
+
+            AND_WHEN("a dog moves and the tick is done") {
+                app.FindPlayerByToken(player1.token)->GetSession()->SetDogAction(Dog::Id{player1.id}, "R"sv);
+                app.Tick(100ms);
+                const app::StateSnapshotPtr next = app.GetStateSnapshot();
+
+                THEN("a new snapshot is published and the old one is not changed") {
+                    REQUIRE(next != snapshot);
+                    CHECK(next->tick == 1);
+                    CHECK(next->FindSession(player1.token)->dogs.front().GetPosition().x > 0.0);
+                    CHECK(snapshot->FindSession(player1.token)->dogs.front().GetPosition().x == 0.0);
+                }
+
+                AND_WHEN("the old snapshot is released and ticks continue") {
+                    const app::SessionSnapshot* old_session = snapshot->FindSession(player1.token);
+                    snapshot.reset(); // последний читатель отпускает снимок
+                    app.Tick(100ms);
+
+                    THEN("the memory of the released snapshot is reused") {
+                        CHECK(app.GetStateSnapshot()->FindSession(player1.token) == old_session);
+                    }
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("State changes history") {
+    using namespace model;
+
+    GIVEN("an application with the changes history of 5 ticks") {
+        Game game;
+        Map map(Map::Id{"map1"}, "Map 1");
+        map.AddRoad(Road(Road::HORIZONTAL, {0, 0}, 100));
+        game.AddMap(map);
+
+        app::Application app{game, 0, false};
+        app.SetStateHistory(5);
+        const app::JoinInfo player1 = app.JoinGame("dog1"s, Map::Id{"map1"});
+        const app::JoinInfo player2 = app.JoinGame("dog2"s, Map::Id{"map1"});
+        GameSession& session = *app.FindPlayerByToken(player1.token)->GetSession();
+        session.AddLoot(Loot{Loot::Id{0}, 0, {50.0, 0.0}});
+        app.Tick(100ms);
+        REQUIRE(app.GetTicksCount() == 1);
+
+        StateDelta delta;
+        const ChangesHistory& history = session.GetChangesHistory();
+
+        THEN("the first tick contains everything added to the session") {
+            REQUIRE(CollectDelta(history, 0, 1, delta));
+            REQUIRE(delta.dogs.size() == 2);
+            CHECK(delta.dogs[0]->GetId() == Dog::Id{0});
+            CHECK(delta.dogs[1]->GetId() == Dog::Id{1});
+            REQUIRE(delta.loots.size() == 1);
+            CHECK(delta.loots[0]->id == Loot::Id{0});
+            CHECK(delta.removed_dogs.empty());
+        }
+
+        WHEN("one dog moves and the loot disappears") {
+            app.SetDogAction(*app.FindPlayerByToken(player1.token), "R"sv);
+            app.Tick(100ms);
+            session.TakeLoot(Loot::Id{0});
+            app.Tick(100ms);
+
+            THEN("only the changed entities are collected") {
+                REQUIRE(CollectDelta(history, 1, 3, delta));
+                REQUIRE(delta.dogs.size() == 1);
+                CHECK(delta.dogs[0]->GetId() == Dog::Id{0});
+                CHECK(delta.dogs[0]->GetPosition().x == session.GetDog(Dog::Id{0})->GetPosition().x);
+                CHECK(delta.loots.empty());
+                CHECK(delta.removed_loots == std::vector<Loot::Id>{Loot::Id{0}});
+            }
+
+            THEN("the loot added and removed after since is only reported as removed") {
+                REQUIRE(CollectDelta(history, 0, 3, delta));
+                CHECK(delta.loots.empty());
+                CHECK(delta.removed_loots == std::vector<Loot::Id>{Loot::Id{0}});
+            }
+
+            THEN("nothing changed after the last tick") {
+                REQUIRE(CollectDelta(history, 3, 3, delta));
+                CHECK(delta.dogs.empty());
+                CHECK(delta.removed_loots.empty());
+            }
+
+            AND_WHEN("the requested tick is older than the history") {
+                for (int i = 0; i < 5; ++i) {
+                    app.Tick(100ms);
+                }
+
+                THEN("the full state is needed") {
+                    CHECK_FALSE(CollectDelta(history, 1, app.GetTicksCount(), delta));
+                    CHECK(CollectDelta(history, app.GetTicksCount() - 5, app.GetTicksCount(), delta));
+                }
+            }
+        }
+
+        WHEN("every tick changes the session for much longer than the history") {
+            for (uint32_t i = 1; i <= 50; ++i) {
+                session.AddLoot(Loot{Loot::Id{i}, 0, {1.0 * i, 0.0}});
+                app.Tick(100ms);
+            }
+
+            THEN("outdated entries are dropped from the list") {
+                size_t nodes = 0;
+                for (const ChangesNode* node = history.newest.get(); node; node = node->older.get()) {
+                    ++nodes;
+                }
+                CHECK(nodes <= 2 * 5);
+
+                REQUIRE(CollectDelta(history, app.GetTicksCount() - 5, app.GetTicksCount(), delta));
+                std::vector<Loot::Id> added;
+                for (const Loot* loot : delta.loots) {
+                    added.push_back(loot->id);
+                }
+                std::sort(added.begin(), added.end());
+                CHECK(added == std::vector<Loot::Id>{Loot::Id{46}, Loot::Id{47}, Loot::Id{48}, Loot::Id{49}, Loot::Id{50}});
+            }
+        }
+
+        WHEN("snapshots are enabled") {
+            app.EnableStateSnapshots();
+            app.Tick(100ms);
+            const app::StateSnapshotPtr snapshot = app.GetStateSnapshot();
+
+            THEN("the snapshot shares the history of the session") {
+                const app::SessionSnapshot* session_snapshot = snapshot->FindSession(player2.token);
+                REQUIRE(session_snapshot);
+                CHECK(session_snapshot->changes_history.start == history.start);
+                CHECK(session_snapshot->changes_history.newest == history.newest); // список не копируется
+                CHECK(CollectDelta(session_snapshot->changes_history, 0, snapshot->tick, delta));
+            }
+        }
+    }
+}
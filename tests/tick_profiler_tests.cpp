@@ -0,0 +1,166 @@
+#include <catch2/catch_test_macros.hpp>
+#include <memory>
+
+#include "../src/model.h"
+#include "../src/tick_profiler.h"
+
+using namespace std::literals;
+using tick_profiler::microseconds;
+
+SCENARIO("Rolling histogram") {
+    using tick_profiler::RollingHistogram;
+
+    GIVEN("a histogram with window of 4 values") {
+        RollingHistogram histogram{4};
+
+        THEN("it is empty") {
+            CHECK(histogram.GetCount() == 0);
+            CHECK(histogram.GetMean() == 0us);
+            CHECK(histogram.GetMax() == 0us);
+            CHECK(histogram.GetPercentile(50.0) == 0us);
+        }
+
+        WHEN("values fit into the window") {
+            histogram.Add(10us);
+            histogram.Add(20us);
+            histogram.Add(30us);
+
+            THEN("statistics are calculated over all values") {
+                CHECK(histogram.GetCount() == 3);
+                CHECK(histogram.GetMean() == 20us);
+                CHECK(histogram.GetMax() == 30us);
+                CHECK(histogram.GetPercentile(50.0) == 20us);
+                CHECK(histogram.GetPercentile(99.0) == 30us);
+            }
+        }
+
+        WHEN("more values than window are added") {
+            for (int value : {1000, 1, 2, 3, 4}) {
+                histogram.Add(microseconds{value});
+            }
+
+            THEN("the oldest value is evicted") {
+                CHECK(histogram.GetCount() == 4);
+                CHECK(histogram.GetMax() == 4us);
+                CHECK(histogram.GetMean() == 2us); // (1 + 2 + 3 + 4) / 4
+
+                uint64_t total = 0;
+                for (uint64_t count : histogram.GetBuckets()) {
+                    total += count;
+                }
+                CHECK(total == 4);
+                CHECK(histogram.GetBuckets()[1] == 1); // [1, 2)
+                CHECK(histogram.GetBuckets()[2] == 2); // [2, 4)
+                CHECK(histogram.GetBuckets()[3] == 1); // [4, 8)
+            }
+        }
+    }
+}
+
+SCENARIO("Tick profiler") {
+    using namespace tick_profiler;
+
+    GIVEN("a profiler and two sessions") {
+        model::Map map1(model::Map::Id{"map1"}, "Map 1");
+        model::Map map2(model::Map::Id{"map2"}, "Map 2");
+        model::GameSessionPtrs sessions{
+            std::make_shared<model::GameSession>(&map1, 5.0, 0.5),
+            std::make_shared<model::GameSession>(&map2, 5.0, 0.5)
+        };
+        TickProfiler profiler{10};
+
+        WHEN("a tick is profiled") {
+            profiler.BeginTick(sessions, {0, 1});
+            profiler.AddSessionTime(0, Phase::MOVE_DOGS, 5us);
+            profiler.AddSessionTime(0, Phase::MOVE_DOGS, 7us); // время фазы за шаг суммируется
+            profiler.AddSessionTime(1, Phase::HANDLE_COLLISIONS, 9us);
+            profiler.EndTick(3us, 40us);
+
+            THEN("times are recorded per session and phase") {
+                REQUIRE(profiler.GetSessions().size() == 2);
+                CHECK(profiler.GetTicksCount() == 1);
+
+                const auto& session1 = profiler.GetSessions()[0];
+                CHECK(*session1.map_id == "map1");
+                CHECK(session1.phases[static_cast<size_t>(Phase::MOVE_DOGS)].GetMax() == 12us);
+                CHECK(session1.phases[static_cast<size_t>(Phase::HANDLE_COLLISIONS)].GetMax() == 0us);
+
+                const auto& session2 = profiler.GetSessions()[1];
+                CHECK(*session2.map_id == "map2");
+                CHECK(session2.phases[static_cast<size_t>(Phase::HANDLE_COLLISIONS)].GetMax() == 9us);
+
+                CHECK(profiler.GetTickSignal().GetMax() == 3us);
+                CHECK(profiler.GetTick().GetMax() == 40us);
+            }
+
+            AND_WHEN("the next tick is profiled") {
+                profiler.BeginTick(sessions, {0, 1});
+                profiler.AddSessionTime(0, Phase::MOVE_DOGS, 2us);
+                profiler.EndTick(1us, 10us);
+
+                THEN("phase time of the previous tick is not carried over") {
+                    const auto& move_dogs = profiler.GetSessions()[0].phases[static_cast<size_t>(Phase::MOVE_DOGS)];
+                    CHECK(move_dogs.GetCount() == 2);
+                    CHECK(move_dogs.GetPercentile(0.0) == 2us);
+                    CHECK(move_dogs.GetMax() == 12us);
+                }
+            }
+
+            AND_WHEN("the first session is hibernating in the next tick") {
+                profiler.BeginTick(sessions, {1});
+                profiler.AddSessionTime(1, Phase::MOVE_DOGS, 2us);
+                profiler.EndTick(1us, 10us);
+
+                THEN("only the active session gets a value") {
+                    CHECK(profiler.GetSessions()[0].phases[static_cast<size_t>(Phase::MOVE_DOGS)].GetCount() == 1);
+                    CHECK(profiler.GetSessions()[1].phases[static_cast<size_t>(Phase::MOVE_DOGS)].GetCount() == 2);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Tick profiler follows removed and added sessions") {
+    using namespace tick_profiler;
+
+    GIVEN("a profiler and three sessions of one map") {
+        model::Map map(model::Map::Id{"map1"}, "Map 1");
+        model::GameSessionPtrs sessions;
+        for (uint64_t serial = 0; serial < 3; ++serial) {
+            sessions.push_back(std::make_shared<model::GameSession>(&map, 5.0, 0.5));
+            sessions.back()->SetSerial(serial);
+        }
+        TickProfiler profiler{10};
+        profiler.BeginTick(sessions, {0, 1, 2});
+
+        WHEN("a session is removed in the middle of a tick") {
+            profiler.AddSessionTime(2, Phase::MOVE_DOGS, 5us);
+            sessions.erase(sessions.begin() + 1);
+            profiler.SyncSessions(sessions);
+            profiler.AddSessionTime(1, Phase::COMMIT_CHANGES, 4us); // новый индекс сессии с номером 2
+            profiler.EndTick(1us, 10us);
+
+            THEN("time before and after the removal goes to the same profile") {
+                REQUIRE(profiler.GetSessions().size() == 2);
+                const SessionProfile& profile = profiler.GetSessions()[1];
+                CHECK(profile.session_serial == 2);
+                CHECK(profile.phases[static_cast<size_t>(Phase::MOVE_DOGS)].GetMax() == 5us);
+                CHECK(profile.phases[static_cast<size_t>(Phase::COMMIT_CHANGES)].GetMax() == 4us);
+            }
+
+            AND_WHEN("the last session is replaced by a new one at the same index") {
+                sessions.back() = std::make_shared<model::GameSession>(&map, 5.0, 0.5);
+                sessions.back()->SetSerial(3);
+                profiler.BeginTick(sessions, {0, 1});
+
+                THEN("the new session starts with an empty profile") {
+                    REQUIRE(profiler.GetSessions().size() == 2);
+                    CHECK(profiler.GetSessions()[0].session_serial == 0);
+                    CHECK(profiler.GetSessions()[0].phases[0].GetCount() == 1);
+                    CHECK(profiler.GetSessions()[1].session_serial == 3);
+                    CHECK(profiler.GetSessions()[1].phases[0].GetCount() == 0);
+                }
+            }
+        }
+    }
+}
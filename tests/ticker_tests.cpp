@@ -0,0 +1,166 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include "../src/ticker.h"
+
+using namespace std::literals;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using milliseconds = std::chrono::milliseconds;
+
+constexpr milliseconds PERIOD = 10ms;
+
+struct TickerRun {
+    Clock::time_point start;
+    std::vector<milliseconds> deltas; // аргумент каждого вызова обработчика
+    std::vector<Clock::time_point> calls; // момент каждого вызова обработчика
+    std::vector<uint64_t> call_ticks; // номер срабатывания, к которому относится вызов
+    ticker::TickerStats stats;
+};
+
+// Запускает Ticker с периодом PERIOD, пока обработчик не будет вызван calls_count раз (догоняющие шаги
+// последнего срабатывания выполняются до конца). sleep_for(i) - время работы i-го вызова обработчика
+TickerRun RunTicker(ticker::TickerOptions options, size_t calls_count, const std::function<milliseconds(size_t)>& sleep_for) {
+    namespace net = boost::asio;
+
+    net::io_context ioc;
+    TickerRun run;
+    std::shared_ptr<ticker::Ticker> ticker;
+    ticker = std::make_shared<ticker::Ticker>(net::make_strand(ioc), PERIOD,
+        [&](milliseconds delta) {
+            run.calls.push_back(Clock::now());
+            run.deltas.push_back(delta);
+            run.call_ticks.push_back(ticker->GetStats().ticks); // статистика срабатывания обновляется после всех его шагов
+            std::this_thread::sleep_for(sleep_for(run.deltas.size() - 1));
+            if (run.deltas.size() == calls_count) {
+                ioc.stop();
+            }
+        }, options);
+
+    run.start = Clock::now();
+    ticker->Start();
+    ioc.run();
+    run.stats = ticker->GetStats();
+    return run;
+}
+
+// наибольшее число вызовов обработчика за одно срабатывание
+size_t GetMaxStepsPerTick(const TickerRun& run) {
+    size_t max_steps = 0;
+    for (auto it = run.call_ticks.begin(); it != run.call_ticks.end();) {
+        const auto next = std::find_if(it, run.call_ticks.end(), [tick = *it](uint64_t t) {
+            return t != tick;
+        });
+        max_steps = std::max<size_t>(max_steps, next - it);
+        it = next;
+    }
+    return max_steps;
+}
+
+uint64_t GetHistogramTotal(const ticker::TickerStats& stats) {
+    return std::accumulate(stats.lateness_histogram.begin(), stats.lateness_histogram.end(), uint64_t{0});
+}
+
+} // namespace
+
+SCENARIO("Ticker schedules steps by absolute deadlines") {
+    using namespace ticker;
+
+    GIVEN("a handler that takes 4 ms of each 10 ms period") {
+        constexpr size_t CALLS = 20;
+        const auto sleep_for = [](size_t) {
+            return 4ms;
+        };
+
+        WHEN("the ticker runs in the fixed step mode") {
+            const TickerRun run = RunTicker({.mode = TickMode::FIXED_STEP}, CALLS, sleep_for);
+
+            THEN("handler time does not accumulate as drift") {
+                REQUIRE(run.calls.size() >= CALLS);
+                const auto elapsed = run.calls[CALLS - 1] - run.start;
+                CHECK(elapsed >= PERIOD * CALLS); // не раньше запланированного момента
+                CHECK(elapsed < PERIOD * CALLS + 50ms); // без дрейфа было бы не меньше 20 * 14 мс
+                CHECK(std::all_of(run.deltas.begin(), run.deltas.end(), [](milliseconds delta) {
+                    return delta == PERIOD;
+                }));
+                CHECK(run.stats.steps == run.deltas.size());
+                CHECK(run.stats.max_handler_time >= 4ms);
+                CHECK(GetHistogramTotal(run.stats) == run.stats.ticks);
+            }
+        }
+
+        WHEN("the ticker runs in the relative mode") {
+            const TickerRun run = RunTicker({.mode = TickMode::RELATIVE}, CALLS, sleep_for);
+
+            THEN("each step starts a period after the previous handler ends") {
+                REQUIRE(run.calls.size() >= CALLS);
+                CHECK(run.calls[CALLS - 1] - run.start >= PERIOD * CALLS + 4ms * (CALLS - 1));
+            }
+        }
+    }
+}
+
+SCENARIO("Ticker catches up after a slow step") {
+    using namespace ticker;
+
+    GIVEN("a handler whose first call takes more than six periods") {
+        const auto sleep_for = [](size_t call) {
+            return call == 0 ? 65ms : 0ms;
+        };
+
+        WHEN("missed periods are caught up by at most 3 substeps") {
+            const TickerRun run = RunTicker({.mode = TickMode::FIXED_STEP, .catch_up = CatchUpPolicy::SUBSTEPS, .max_substeps = 3},
+                                            6, sleep_for);
+
+            THEN("the substeps are capped and the rest are dropped") {
+                CHECK(GetMaxStepsPerTick(run) == 3);
+                CHECK(run.call_ticks[1] == run.call_ticks[3]); // шаги 1-3 - одно догоняющее срабатывание
+                CHECK(std::all_of(run.deltas.begin(), run.deltas.end(), [](milliseconds delta) {
+                    return delta == PERIOD;
+                }));
+                CHECK(run.stats.steps == run.deltas.size());
+                CHECK(run.stats.dropped_steps >= 3); // опоздание не меньше 55 мс - должно быть 6 шагов, выполнено 3
+            }
+
+            THEN("the late tick is counted as an overrun with its lateness and jitter") {
+                CHECK(run.stats.overruns >= 1);
+                CHECK(run.stats.overruns < run.stats.ticks);
+                CHECK(run.stats.max_lateness >= 55ms);
+                CHECK(run.stats.max_jitter >= 55ms);
+                CHECK(run.stats.max_handler_time >= 65ms);
+                CHECK(GetHistogramTotal(run.stats) == run.stats.ticks);
+                CHECK(run.stats.lateness_histogram[6] + run.stats.lateness_histogram[7] >= 1); // корзины (50, 100] и больше
+            }
+
+            THEN("the next step waits for its moment on the grid after the dropped ones") {
+                REQUIRE(run.calls.size() >= 5);
+                // шаг 0 и догоняющие шаги закрывают моменты 1-4, отброшенные - ещё не меньше трёх
+                CHECK(run.calls[4] - run.start >= PERIOD * 8);
+            }
+        }
+
+        WHEN("missed periods are coalesced") {
+            const TickerRun run = RunTicker({.mode = TickMode::FIXED_STEP, .catch_up = CatchUpPolicy::COALESCE}, 3, sleep_for);
+
+            THEN("one step covers all the missed time") {
+                REQUIRE(run.deltas.size() == 3);
+                CHECK(run.deltas[0] == PERIOD);
+                CHECK(run.deltas[1] >= PERIOD * 6);
+                CHECK(run.deltas[1] % PERIOD == 0ms);
+                CHECK(GetMaxStepsPerTick(run) == 1);
+                CHECK(run.stats.steps == run.stats.ticks);
+                CHECK(run.stats.dropped_steps == 0);
+                CHECK(run.stats.overruns >= 1);
+            }
+        }
+    }
+}
@@ -0,0 +1,167 @@
+#include <catch2/catch_test_macros.hpp>
+#include <algorithm>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "../src/model.h"
+#include "../src/timing_wheel.h"
+
+using namespace std::literals;
+
+SCENARIO("Timing wheel") {
+    using Wheel = timing_wheel::TimingWheel<int>;
+
+    GIVEN("an empty wheel") {
+        Wheel wheel;
+        std::vector<int> expired;
+
+        WHEN("timers are scheduled at different levels") {
+            wheel.Schedule(1, 5);
+            wheel.Schedule(2, 64);
+            wheel.Schedule(3, 5000);
+            wheel.Schedule(4, 1'000'000);
+
+            THEN("they expire exactly when time reaches their deadlines") {
+                wheel.Advance(4, expired);
+                CHECK(expired.empty());
+                wheel.Advance(64, expired);
+                CHECK(expired == std::vector<int>{1, 2});
+                expired.clear();
+                wheel.Advance(4999, expired);
+                CHECK(expired.empty());
+                wheel.Advance(5000, expired);
+                CHECK(expired == std::vector<int>{3});
+                expired.clear();
+                wheel.Advance(2'000'000, expired);
+                CHECK(expired == std::vector<int>{4});
+                CHECK(wheel.GetSize() == 0);
+            }
+        }
+
+        WHEN("a timer is extended, brought forward and removed") {
+            wheel.Schedule(1, 100);
+            wheel.Schedule(1, 300); // продление
+            wheel.Schedule(2, 500);
+            wheel.Schedule(2, 200); // перенос на более ранний срок
+            wheel.Schedule(3, 150);
+            wheel.Remove(3);
+
+            THEN("only the actual deadlines are taken into account") {
+                wheel.Advance(199, expired);
+                CHECK(expired.empty());
+                wheel.Advance(200, expired);
+                CHECK(expired == std::vector<int>{2});
+                wheel.Advance(1000, expired);
+                CHECK(expired == std::vector<int>{2, 1});
+            }
+        }
+
+        WHEN("a timer is scheduled in the past") {
+            wheel.Advance(100, expired);
+            wheel.Schedule(1, 50);
+
+            THEN("it expires on the next advance") {
+                wheel.Advance(100, expired);
+                CHECK(expired == std::vector<int>{1});
+            }
+        }
+    }
+
+    GIVEN("random schedules") {
+        std::mt19937 random(42);
+        std::uniform_int_distribution<int> key_dist(0, 199);
+        std::uniform_int_distribution<int> delay_dist(0, 20000);
+        std::uniform_int_distribution<int> step_dist(1, 300);
+
+        Wheel wheel;
+        std::map<int, int64_t> deadlines; // эталон
+
+        THEN("the wheel expires the same timers as the brute force check") {
+            int64_t now = 0;
+            for (int step = 0; step < 2000; ++step) {
+                for (int i = 0; i < 5; ++i) {
+                    const int key = key_dist(random);
+                    const int64_t deadline = now + delay_dist(random);
+                    wheel.Schedule(key, deadline);
+                    deadlines[key] = deadline;
+                }
+
+                now += step_dist(random);
+                std::vector<int> expired;
+                wheel.Advance(now, expired);
+
+                std::vector<int> expected;
+                for (auto it = deadlines.begin(); it != deadlines.end();) {
+                    if (it->second <= now) {
+                        expected.push_back(it->first);
+                        it = deadlines.erase(it);
+                    } else {
+                        ++it;
+                    }
+                }
+
+                std::sort(expired.begin(), expired.end());
+                REQUIRE(expired == expected);
+                REQUIRE(wheel.GetSize() == deadlines.size());
+            }
+        }
+    }
+}
+
+SCENARIO("Dogs retirement by inactivity") {
+    using namespace model;
+
+    GIVEN("a game session with retirement time 100 ms and two dogs") {
+        Map map(Map::Id{"id_1"}, "Map_1");
+        GameSession session(&map, 5.0, 0.5);
+        session.SetRetirementTime(100);
+        session.AddDog(Dog(Dog::Id{0}, "Icy", {0.0, 0.0}, 1.0, 3));
+        session.AddDog(Dog(Dog::Id{1}, "Wolfy", {0.0, 0.0}, 1.0, 3));
+
+        std::vector<Dog::Id> retired;
+
+        WHEN("one dog moves and the other does not") {
+            session.AdvanceTime(40, retired);
+            session.SetDogAction(Dog::Id{0}, "R"sv);
+            session.AdvanceTime(40, retired);
+
+            THEN("play and inactivity times are counted for the moving dog only") {
+                CHECK(retired.empty());
+                CHECK(session.GetDog(Dog::Id{0})->GetPlayTime() == 40);
+                CHECK(session.GetInactivityTime(*session.GetDog(Dog::Id{0})) == 0);
+                CHECK(session.GetInactivityTime(*session.GetDog(Dog::Id{1})) == 80);
+            }
+
+            AND_WHEN("the retirement time passes") {
+                session.AdvanceTime(20, retired);
+
+                THEN("the inactive dog retires") {
+                    CHECK(retired == std::vector<Dog::Id>{Dog::Id{1}});
+                }
+
+                AND_WHEN("the moving dog stays inactive") {
+                    retired.clear();
+                    session.AdvanceTime(79, retired);
+                    CHECK(retired.empty());
+                    session.AdvanceTime(1, retired);
+
+                    THEN("it retires 100 ms after its last move") {
+                        CHECK(retired == std::vector<Dog::Id>{Dog::Id{0}});
+                    }
+                }
+            }
+        }
+
+        WHEN("a dog is stopped in the same tick it started moving") {
+            session.SetDogAction(Dog::Id{0}, "R"sv);
+            session.SetDogAction(Dog::Id{0}, ""sv);
+            session.AdvanceTime(100, retired);
+
+            THEN("the tick does not count as activity") {
+                CHECK(retired.size() == 2);
+                CHECK(session.GetDog(Dog::Id{0})->GetPlayTime() == 0);
+            }
+        }
+    }
+}